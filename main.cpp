@@ -22,6 +22,7 @@
 #endif
 
 #include <cstdint>
+#include <cstring>
 #include <fstream>
 #include <getopt.h>
 #include <vector>
@@ -62,6 +63,12 @@
 #include "pv/util.hpp"
 #include "pv/data/segment.hpp"
 
+#ifdef ENABLE_DECODE
+#include "pv/data/decode/decoderindex.hpp"
+#include "pv/data/decode/decodeworker.hpp"
+#include "pv/data/decode/remoteprotocol.hpp"
+#endif
+
 #ifdef ANDROID
 #include <libsigrokandroidutils/libsigrokandroidutils.h>
 #include "android/assetreader.hpp"
@@ -178,6 +185,13 @@ int main(int argc, char *argv[])
 	bool do_scan = true;
 	bool show_version = false;
 
+#ifdef ENABLE_DECODE
+	// When started as a decode worker by a decode signal, there's no UI
+	// and nothing but libsigrokdecode must be initialized
+	if ((argc == 3) && (strcmp(argv[1], DECODE_WORKER_OPTION) == 0))
+		return pv::data::decode::run_decode_worker(argv[2]);
+#endif
+
 #ifdef ENABLE_FLOW
 	// Initialise gstreamermm. Must be called before any other GLib stuff.
 	Gst::init();
@@ -321,8 +335,8 @@ int main(int argc, char *argv[])
 			break;
 		}
 
-		// Load the protocol decoders
-		srd_decoder_load_all();
+		// Index the protocol decoders, they're loaded when first used
+		pv::data::decode::DecoderIndex::load();
 #endif
 
 #ifndef ENABLE_STACKTRACE
@@ -34,6 +34,7 @@
 
 #ifdef ENABLE_DECODE
 #include <libsigrokdecode/libsigrokdecode.h>
+#include <pv/data/decode/decoderindex.hpp>
 #endif
 
 #include <pv/exprtk.hpp>
@@ -47,17 +48,6 @@ using std::endl;
 using std::exception;
 using std::shared_ptr;
 
-#ifdef ENABLE_DECODE
-static gint sort_pds(gconstpointer a, gconstpointer b)
-{
-	const struct srd_decoder *sda, *sdb;
-
-	sda = (const struct srd_decoder *)a;
-	sdb = (const struct srd_decoder *)b;
-	return strcmp(sda->id, sdb->id);
-}
-#endif
-
 Application::Application(int &argc, char* argv[]) :
 	QApplication(argc, argv)
 {
@@ -181,8 +171,6 @@ void Application::collect_version_info(pv::DeviceManager &device_manager)
 	g_free(scpi_backends);
 
 #ifdef ENABLE_DECODE
-	struct srd_decoder *dec;
-
 	version_info_.emplace_back("libsigrokdecode", QString("%1/%2 (rt: %3/%4)")
 		.arg(SRD_PACKAGE_VERSION_STRING, SRD_LIB_VERSION_STRING,
 		srd_package_version_string_get(), srd_lib_version_string_get()));
@@ -234,14 +222,8 @@ void Application::collect_version_info(pv::DeviceManager &device_manager)
 
 	// Protocol decoders
 #ifdef ENABLE_DECODE
-	GSList *sl = g_slist_copy((GSList *)srd_decoder_list());
-	sl = g_slist_sort(sl, sort_pds);
-	for (const GSList *l = sl; l; l = l->next) {
-		dec = (struct srd_decoder *)l->data;
-		pd_list_.emplace_back(QString::fromUtf8(dec->id),
-			QString::fromUtf8(dec->longname));
-	}
-	g_slist_free(sl);
+	for (const pv::data::decode::DecoderInfo& info : pv::data::decode::DecoderIndex::decoders())
+		pd_list_.emplace_back(info.id, info.longname);
 #endif
 }
 
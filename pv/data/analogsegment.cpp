@@ -157,6 +157,45 @@ void AnalogSegment::get_envelope_section(EnvelopeSection &s,
 		s.length * sizeof(EnvelopeSample));
 }
 
+bool AnalogSegment::get_envelope_min_max(EnvelopeSample &result,
+	uint64_t start, uint64_t end) const
+{
+	if ((start >= end) || (start % EnvelopeScaleFactor) ||
+		(end % EnvelopeScaleFactor))
+		return false;
+
+	lock_guard<recursive_mutex> lock(mutex_);
+
+	if ((end / EnvelopeScaleFactor) > envelope_levels_[0].length)
+		return false;
+
+	result = envelope_levels_[0].samples[start / EnvelopeScaleFactor];
+
+	uint64_t index = start;
+	while (index < end) {
+		// Use the coarsest level that has an entry starting at index
+		// and not exceeding the requested range
+		unsigned int level = 0;
+		while (level + 1 < ScaleStepCount) {
+			const uint64_t block_size =
+				UINT64_C(1) << ((level + 2) * EnvelopeScalePower);
+			if ((index % block_size) || (index + block_size > end) ||
+				((index + block_size) / block_size > envelope_levels_[level + 1].length))
+				break;
+			level++;
+		}
+
+		const unsigned int scale_power = (level + 1) * EnvelopeScalePower;
+		const EnvelopeSample &s = envelope_levels_[level].samples[index >> scale_power];
+		result.min = min(result.min, s.min);
+		result.max = max(result.max, s.max);
+
+		index += UINT64_C(1) << scale_power;
+	}
+
+	return true;
+}
+
 void AnalogSegment::reallocate_envelope(Envelope &e)
 {
 	const uint64_t new_data_length = ((e.length + EnvelopeDataUnit - 1) /
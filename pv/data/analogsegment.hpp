@@ -91,6 +91,21 @@ public:
 	void get_envelope_section(EnvelopeSection &s,
 		uint64_t start, uint64_t end, float min_length) const;
 
+	/**
+	 * Determines the minimum and maximum value of the samples in the range
+	 * [start, end) by using the envelope only, i.e. without touching the
+	 * sample data.
+	 * @param[out] result The min/max values of the range.
+	 * @param[in] start The start sample index, must be a multiple of the
+	 * envelope block size.
+	 * @param[in] end The end sample index, must be a multiple of the
+	 * envelope block size.
+	 *
+	 * @return true if the envelope covers the range, false otherwise.
+	 */
+	bool get_envelope_min_max(EnvelopeSample &result,
+		uint64_t start, uint64_t end) const;
+
 private:
 	void reallocate_envelope(Envelope &e);
 
@@ -38,16 +38,25 @@ namespace decode {
 
 class RowData;
 
+/**
+ * A lightweight handle to an annotation stored in a RowData. The annotation
+ * itself lives in the columnar storage of the RowData, the handle only
+ * consists of the RowData and the index of the annotation therein.
+ * Handles are cheap to copy and remain valid for as long as the RowData
+ * exists since annotations are never moved once they're stored. They may
+ * be used while the decoder adds further annotations to the RowData.
+ */
 class Annotation
 {
 public:
-	Annotation(uint64_t start_sample, uint64_t end_sample,
-		const vector<QString>* texts, uint32_t ann_class_id, const RowData *data);
-	Annotation(Annotation&& a);
-	Annotation& operator=(Annotation&& a);
+	Annotation();
+	Annotation(const RowData *data, uint32_t index);
+
+	bool is_valid() const;
 
 	const RowData* row_data() const;
 	const Row* row() const;
+	uint32_t index() const;
 
 	uint64_t start_sample() const;
 	uint64_t end_sample() const;
@@ -67,13 +76,12 @@ public:
 	const QColor dark_color() const;
 
 	bool operator<(const Annotation &other) const;
+	bool operator==(const Annotation &other) const;
+	bool operator!=(const Annotation &other) const;
 
 private:
-	uint64_t start_sample_;
-	uint64_t end_sample_;
-	const vector<QString>* texts_;
-	uint32_t ann_class_id_;
 	const RowData* data_;
+	uint32_t index_;
 };
 
 } // namespace decode
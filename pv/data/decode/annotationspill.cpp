@@ -0,0 +1,155 @@
+/*
+ * This file is part of the PulseView project.
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QDebug>
+#include <QDir>
+
+#include "annotationspill.hpp"
+
+using std::lock_guard;
+
+namespace pv {
+namespace data {
+namespace decode {
+
+const uint64_t AnnotationSpill::ExtentSize = 16 * 1024 * 1024;
+
+AnnotationSpill::AnnotationSpill() :
+	file_(QDir::tempPath() + "/pulseview-annotations-XXXXXX"),
+	extent_used_(0),
+	size_(0),
+	failed_(false),
+	reader_count_(0),
+	have_retired_(false)
+{
+}
+
+AnnotationSpill::Reader::Reader(AnnotationSpill* spill) :
+	spill_(spill)
+{
+	if (spill_)
+		spill_->reader_count_++;
+}
+
+AnnotationSpill::Reader::~Reader()
+{
+	if (spill_ && (--spill_->reader_count_ == 0) && spill_->have_retired_)
+		spill_->release_retired();
+}
+
+const void* AnnotationSpill::store(const void* data, size_t size)
+{
+	lock_guard<mutex> lock(mutex_);
+
+	if (failed_ || (size > ExtentSize))
+		return nullptr;
+
+	if (extents_.empty() || (extent_used_ + size > ExtentSize))
+		if (!add_extent())
+			return nullptr;
+
+	// Writing through the file rather than the mapping makes running out
+	// of disk space an error instead of a crash
+	const uint64_t offset = (extents_.size() - 1) * ExtentSize + extent_used_;
+
+	if (!file_.seek(offset) || (file_.write((const char*)data, size) != (qint64)size) ||
+		!file_.flush()) {
+		qWarning() << "Failed to write annotations to" << file_.fileName() <<
+			"-" << file_.errorString();
+		failed_ = true;
+		return nullptr;
+	}
+
+	uchar* const copy = extents_.back() + extent_used_;
+
+	// Keep the data aligned to 8 bytes
+	extent_used_ += (size + 7) & ~(uint64_t)7;
+	size_ += size;
+
+	return copy;
+}
+
+void AnnotationSpill::retire(shared_ptr<const void> buffer)
+{
+	{
+		lock_guard<mutex> lock(mutex_);
+		retired_.push_back(buffer);
+		have_retired_ = true;
+	}
+
+	release_retired();
+}
+
+void AnnotationSpill::release_retired()
+{
+	lock_guard<mutex> lock(mutex_);
+
+	// Every reader that may have loaded a retired buffer did so before it
+	// was retired. If there's no reader now, all of them are done
+	if (reader_count_ == 0) {
+		retired_.clear();
+		have_retired_ = false;
+	}
+}
+
+size_t AnnotationSpill::retired_count() const
+{
+	lock_guard<mutex> lock(mutex_);
+
+	return retired_.size();
+}
+
+uint64_t AnnotationSpill::size() const
+{
+	lock_guard<mutex> lock(mutex_);
+
+	return size_;
+}
+
+bool AnnotationSpill::add_extent()
+{
+	if (!file_.isOpen() && !file_.open()) {
+		qWarning() << "Failed to create annotation spill file -" << file_.errorString();
+		failed_ = true;
+		return false;
+	}
+
+	const uint64_t offset = extents_.size() * ExtentSize;
+
+	// The file is extended first so that the whole extent can be mapped
+	uchar* extent = nullptr;
+	if (file_.resize(offset + ExtentSize))
+		extent = file_.map(offset, ExtentSize);
+
+	if (!extent) {
+		qWarning() << "Failed to map annotation spill file" << file_.fileName() <<
+			"-" << file_.errorString();
+		failed_ = true;
+		return false;
+	}
+
+	extents_.push_back(extent);
+	extent_used_ = 0;
+
+	return true;
+}
+
+} // namespace decode
+} // namespace data
+} // namespace pv
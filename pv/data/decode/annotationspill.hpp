@@ -0,0 +1,129 @@
+/*
+ * This file is part of the PulseView project.
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PULSEVIEW_PV_DATA_DECODE_ANNOTATIONSPILL_HPP
+#define PULSEVIEW_PV_DATA_DECODE_ANNOTATIONSPILL_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <QTemporaryFile>
+
+using std::atomic;
+using std::mutex;
+using std::shared_ptr;
+using std::vector;
+
+namespace pv {
+namespace data {
+namespace decode {
+
+/**
+ * A temporary file that the annotation blocks of a decode segment are moved
+ * to once they won't change anymore, so that very long decodes don't have to
+ * keep all of their annotations in memory.
+ *
+ * The file grows in extents of ExtentSize bytes that are memory-mapped as a
+ * whole, so the stored data can be accessed in place. Its pages are only read
+ * in when the annotations are accessed and may be dropped again by the
+ * system whenever memory gets scarce.
+ *
+ * Readers may still be looking at the in-memory copy of data that was just
+ * stored. Such copies are retired and freed as soon as no Reader exists,
+ * either when they're retired or when the last reader is done. A reader that
+ * started after a buffer was replaced can't see it anymore, so no reader
+ * existing at some point after the retirement is sufficient.
+ */
+class AnnotationSpill
+{
+public:
+	static const uint64_t ExtentSize;
+
+	/**
+	 * Keeps the retired buffers alive while it exists. Must be held while
+	 * a pointer to data that may get spilled is loaded and used.
+	 */
+	class Reader
+	{
+	public:
+		Reader(AnnotationSpill* spill);
+		~Reader();
+
+	private:
+		AnnotationSpill* const spill_;
+	};
+
+public:
+	AnnotationSpill();
+
+	/**
+	 * Copies @c size bytes to the file. The copy remains accessible through
+	 * the returned pointer for as long as this object exists.
+	 * @return The copy or nullptr if the data couldn't be stored, in which
+	 *         case it must be kept in memory.
+	 */
+	const void* store(const void* data, size_t size);
+
+	/**
+	 * Keeps @c buffer alive until no Reader uses it anymore. It must not
+	 * be reachable for new readers when this is called.
+	 */
+	void retire(shared_ptr<const void> buffer);
+
+	/**
+	 * Frees the retired buffers unless a Reader exists.
+	 */
+	void release_retired();
+
+	/**
+	 * Returns the number of retired buffers that weren't freed yet.
+	 */
+	size_t retired_count() const;
+
+	/**
+	 * Returns the number of bytes that were stored.
+	 */
+	uint64_t size() const;
+
+private:
+	bool add_extent();
+
+private:
+	mutable mutex mutex_;
+
+	QTemporaryFile file_;
+	vector<uchar*> extents_;
+	uint64_t extent_used_;   ///< Bytes used in the last extent
+	uint64_t size_;
+	bool failed_;            ///< Set once the file couldn't be written to
+
+	vector< shared_ptr<const void> > retired_;
+	atomic<unsigned int> reader_count_;
+	atomic<bool> have_retired_;  ///< Lets readers skip the mutex
+};
+
+} // namespace decode
+} // namespace data
+} // namespace pv
+
+#endif // PULSEVIEW_PV_DATA_DECODE_ANNOTATIONSPILL_HPP
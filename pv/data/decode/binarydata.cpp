@@ -0,0 +1,179 @@
+/*
+ * This file is part of the PulseView project.
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#include "binarydata.hpp"
+
+using std::lower_bound;
+using std::min;
+using std::upper_bound;
+
+namespace pv {
+namespace data {
+namespace decode {
+
+const uint64_t BinaryData::BlockSize = 256 * 1024;
+
+BinaryData::BinaryData() :
+	size_(0),
+	samples_in_order_(true)
+{
+}
+
+void BinaryData::append(uint64_t sample, const uint8_t* data, uint64_t size)
+{
+	if (!chunk_samples_.empty() && (sample < chunk_samples_.back()))
+		samples_in_order_ = false;
+
+	chunk_offsets_.push_back(size_);
+	chunk_samples_.push_back(sample);
+
+	// Blocks are only reserved, so memory that isn't used yet stays
+	// untouched. Chunks that don't fit are continued in the next block
+	while (size > 0) {
+		if (size_ == blocks_.size() * BlockSize) {
+			blocks_.emplace_back();
+			blocks_.back().reserve(BlockSize);
+		}
+
+		vector<uint8_t>& block = blocks_.back();
+		const uint64_t count = min(size, BlockSize - block.size());
+
+		block.insert(block.end(), data, data + count);
+		size_ += count;
+		data += count;
+		size -= count;
+	}
+}
+
+void BinaryData::clear()
+{
+	blocks_.clear();
+	size_ = 0;
+	chunk_offsets_.clear();
+	chunk_samples_.clear();
+	samples_in_order_ = true;
+}
+
+uint64_t BinaryData::chunk_count() const
+{
+	return chunk_offsets_.size();
+}
+
+uint64_t BinaryData::size() const
+{
+	return size_;
+}
+
+uint64_t BinaryData::chunk_offset(uint64_t chunk_id) const
+{
+	return (chunk_id < chunk_offsets_.size()) ? chunk_offsets_[chunk_id] : size_;
+}
+
+uint64_t BinaryData::chunk_size(uint64_t chunk_id) const
+{
+	if (chunk_id >= chunk_offsets_.size())
+		return 0;
+
+	return chunk_offset(chunk_id + 1) - chunk_offsets_[chunk_id];
+}
+
+uint64_t BinaryData::chunk_sample(uint64_t chunk_id) const
+{
+	return chunk_samples_.at(chunk_id);
+}
+
+uint64_t BinaryData::chunk_at_offset(uint64_t offset) const
+{
+	if (offset >= size_)
+		return chunk_offsets_.size();
+
+	// Empty chunks share their offset with the next one, so the last
+	// chunk starting at or before the offset is the one holding the byte
+	return (upper_bound(chunk_offsets_.begin(), chunk_offsets_.end(), offset) -
+		chunk_offsets_.begin()) - 1;
+}
+
+uint8_t BinaryData::byte_at(uint64_t offset) const
+{
+	return blocks_[offset / BlockSize][offset % BlockSize];
+}
+
+void BinaryData::get_data_by_offset(uint64_t start, uint64_t end,
+	vector<uint8_t>* dest) const
+{
+	end = min(end, size_);
+
+	if (start >= end) {
+		dest->clear();
+		return;
+	}
+
+	dest->resize(end - start);
+	copy(start, end - start, dest->data());
+}
+
+void BinaryData::get_data_by_sample(uint64_t start_sample, uint64_t end_sample,
+	vector<uint8_t>* dest) const
+{
+	if (samples_in_order_) {
+		// The chunks of the sample range are adjacent in the stream
+		const uint64_t first = lower_bound(chunk_samples_.begin(),
+			chunk_samples_.end(), start_sample) - chunk_samples_.begin();
+		const uint64_t last = lower_bound(chunk_samples_.begin() + first,
+			chunk_samples_.end(), end_sample) - chunk_samples_.begin();
+
+		get_data_by_offset(chunk_offset(first), chunk_offset(last), dest);
+		return;
+	}
+
+	// Determine overall size before copying to resize dest vector only once
+	uint64_t size = 0;
+	for (uint64_t i = 0; i < chunk_samples_.size(); i++)
+		if ((chunk_samples_[i] >= start_sample) && (chunk_samples_[i] < end_sample))
+			size += chunk_size(i);
+
+	dest->resize(size);
+
+	uint64_t dest_offset = 0;
+	for (uint64_t i = 0; i < chunk_samples_.size(); i++)
+		if ((chunk_samples_[i] >= start_sample) && (chunk_samples_[i] < end_sample)) {
+			copy(chunk_offsets_[i], chunk_size(i), dest->data() + dest_offset);
+			dest_offset += chunk_size(i);
+		}
+}
+
+void BinaryData::copy(uint64_t offset, uint64_t size, uint8_t* dest) const
+{
+	while (size > 0) {
+		const uint64_t pos = offset % BlockSize;
+		const uint64_t count = min(size, BlockSize - pos);
+
+		memcpy(dest, blocks_[offset / BlockSize].data() + pos, count);
+		offset += count;
+		dest += count;
+		size -= count;
+	}
+}
+
+} // namespace decode
+} // namespace data
+} // namespace pv
@@ -0,0 +1,109 @@
+/*
+ * This file is part of the PulseView project.
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PULSEVIEW_PV_DATA_DECODE_BINARYDATA_HPP
+#define PULSEVIEW_PV_DATA_DECODE_BINARYDATA_HPP
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+using std::deque;
+using std::vector;
+
+namespace pv {
+namespace data {
+namespace decode {
+
+/**
+ * Stores the binary output of one binary class of a decoder.
+ *
+ * The data chunks the decoder emits are appended to a single stream of bytes
+ * that is kept in large blocks, so they don't need an allocation each. For
+ * every chunk, its offset within the stream and the sample it was emitted at
+ * are stored, so that both the chunk holding a given byte and the chunks
+ * emitted within a sample range are found by binary search.
+ *
+ * Data is only ever appended, so offsets and chunk IDs remain valid until
+ * the data is cleared.
+ */
+class BinaryData
+{
+public:
+	static const uint64_t BlockSize;
+
+public:
+	BinaryData();
+
+	void append(uint64_t sample, const uint8_t* data, uint64_t size);
+	void clear();
+
+	uint64_t chunk_count() const;
+
+	/**
+	 * Returns the number of bytes of all chunks.
+	 */
+	uint64_t size() const;
+
+	uint64_t chunk_offset(uint64_t chunk_id) const;
+	uint64_t chunk_size(uint64_t chunk_id) const;
+	uint64_t chunk_sample(uint64_t chunk_id) const;
+
+	/**
+	 * Returns the ID of the chunk that holds the byte at the given offset
+	 * or chunk_count() if the offset lies beyond the data.
+	 */
+	uint64_t chunk_at_offset(uint64_t offset) const;
+
+	uint8_t byte_at(uint64_t offset) const;
+
+	/**
+	 * Copies the bytes from @c start up to but not including @c end to
+	 * @c dest, which is resized accordingly.
+	 */
+	void get_data_by_offset(uint64_t start, uint64_t end, vector<uint8_t>* dest) const;
+
+	/**
+	 * Copies the chunks that were emitted at samples from @c start_sample up
+	 * to but not including @c end_sample to @c dest, which is resized
+	 * accordingly.
+	 */
+	void get_data_by_sample(uint64_t start_sample, uint64_t end_sample,
+		vector<uint8_t>* dest) const;
+
+private:
+	void copy(uint64_t offset, uint64_t size, uint8_t* dest) const;
+
+private:
+	deque< vector<uint8_t> > blocks_;  ///< All of them BlockSize bytes large
+	uint64_t size_;
+
+	deque<uint64_t> chunk_offsets_;
+	deque<uint64_t> chunk_samples_;
+
+	/// Set while the chunks were appended in the order of their samples,
+	/// otherwise the chunks of a sample range are searched for linearly
+	bool samples_in_order_;
+};
+
+} // namespace decode
+} // namespace data
+} // namespace pv
+
+#endif // PULSEVIEW_PV_DATA_DECODE_BINARYDATA_HPP
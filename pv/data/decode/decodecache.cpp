@@ -0,0 +1,365 @@
+/*
+ * This file is part of the PulseView project.
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cassert>
+#include <cstring>
+
+#include <QDir>
+#include <QFileInfo>
+#include <QStandardPaths>
+
+#include "decodecache.hpp"
+
+namespace pv {
+namespace data {
+namespace decode {
+
+namespace decodecache {
+
+static const char Magic[4] = {'P', 'V', 'D', 'C'};
+static const uint32_t Version = 1;
+static const uint32_t ByteOrderMark = 0x01020304;
+
+struct FileHeader
+{
+	char magic[4];
+	uint32_t version;
+	uint32_t byte_order;        ///< ByteOrderMark as written by the host
+	uint32_t text_count;
+	uint64_t annotation_count;
+	uint64_t binary_data_count;
+	uint64_t binary_data_offset;
+	uint64_t text_table_offset;
+};
+
+struct TextTableEntry
+{
+	uint64_t offset;  ///< Position of the first text in the file
+	uint32_t length;  ///< Length of all texts incl. their terminating NULs
+	uint32_t reserved;
+};
+
+static inline uint64_t padding(uint64_t size)
+{
+	return (8 - (size % 8)) % 8;
+}
+
+QString cache_dir()
+{
+	return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) +
+		"/decode";
+}
+
+QString file_path(const QByteArray& key)
+{
+	return cache_dir() + "/" + QString::fromLatin1(key.toHex()) + ".pvdc";
+}
+
+void prune(uint64_t max_size)
+{
+	const QFileInfoList files = QDir(cache_dir()).entryInfoList(
+		QStringList("*.pvdc"), QDir::Files, QDir::Time);
+
+	// The files are sorted newest first
+	uint64_t total_size = 0;
+	for (const QFileInfo& info : files) {
+		total_size += info.size();
+		if (total_size > max_size)
+			QFile::remove(info.filePath());
+	}
+}
+
+} // namespace decodecache
+
+using decodecache::AnnotationRecord;
+using decodecache::BinaryDataRecord;
+using decodecache::FileHeader;
+using decodecache::TextTableEntry;
+using decodecache::padding;
+
+DecodeCacheWriter::DecodeCacheWriter(const QString& file_path) :
+	file_path_(file_path),
+	file_(file_path + QString(".%1.tmp").arg((quintptr)this, 0, 16)),
+	ok_(false),
+	annotation_count_(0),
+	binary_data_count_(0),
+	binary_data_offset_(0)
+{
+}
+
+DecodeCacheWriter::~DecodeCacheWriter()
+{
+	// Remove what's left of an unfinished file
+	if (file_.isOpen()) {
+		file_.close();
+		file_.remove();
+	}
+}
+
+bool DecodeCacheWriter::open()
+{
+	QDir().mkpath(QFileInfo(file_path_).path());
+
+	ok_ = file_.open(QIODevice::WriteOnly | QIODevice::Truncate);
+	if (!ok_)
+		return false;
+
+	// The header is written once the contents are known
+	const FileHeader header = {};
+	write(&header, sizeof(header));
+
+	return ok_;
+}
+
+uint32_t DecodeCacheWriter::add_texts(const QByteArray& texts)
+{
+	texts_.push_back(texts);
+
+	return texts_.size() - 1;
+}
+
+void DecodeCacheWriter::add_annotation(uint16_t decoder, uint32_t ann_class,
+	uint64_t start_sample, uint64_t end_sample, uint32_t text_id)
+{
+	assert(binary_data_count_ == 0);
+	assert(text_id < texts_.size());
+
+	AnnotationRecord record = {};
+	record.start_sample = start_sample;
+	record.end_sample = end_sample;
+	record.text_id = text_id;
+	record.ann_class = ann_class;
+	record.decoder = decoder;
+
+	write(&record, sizeof(record));
+	annotation_count_++;
+}
+
+void DecodeCacheWriter::add_binary_data(uint16_t decoder, uint32_t bin_class,
+	uint64_t sample, const uint8_t* data, uint64_t size)
+{
+	if (binary_data_count_ == 0)
+		binary_data_offset_ = file_.pos();
+
+	BinaryDataRecord record = {};
+	record.sample = sample;
+	record.size = size;
+	record.bin_class = bin_class;
+	record.decoder = decoder;
+
+	write(&record, sizeof(record));
+	write(data, size);
+	write_padding();
+	binary_data_count_++;
+}
+
+bool DecodeCacheWriter::finish()
+{
+	if (!ok_)
+		return false;
+
+	const uint64_t text_table_offset = file_.pos();
+
+	if (binary_data_count_ == 0)
+		binary_data_offset_ = text_table_offset;
+
+	// The texts follow the text table
+	uint64_t text_offset = text_table_offset + texts_.size() * sizeof(TextTableEntry);
+
+	for (const QByteArray& texts : texts_) {
+		TextTableEntry entry = {};
+		entry.offset = text_offset;
+		entry.length = texts.size();
+		write(&entry, sizeof(entry));
+
+		text_offset += texts.size();
+	}
+
+	for (const QByteArray& texts : texts_)
+		write(texts.constData(), texts.size());
+
+	FileHeader header = {};
+	memcpy(header.magic, decodecache::Magic, sizeof(header.magic));
+	header.version = decodecache::Version;
+	header.byte_order = decodecache::ByteOrderMark;
+	header.text_count = texts_.size();
+	header.annotation_count = annotation_count_;
+	header.binary_data_count = binary_data_count_;
+	header.binary_data_offset = binary_data_offset_;
+	header.text_table_offset = text_table_offset;
+
+	ok_ = ok_ && file_.seek(0);
+	write(&header, sizeof(header));
+
+	file_.close();
+
+	if (ok_) {
+		QFile::remove(file_path_);
+		ok_ = file_.rename(file_path_);
+	}
+
+	if (!ok_)
+		file_.remove();
+
+	return ok_;
+}
+
+void DecodeCacheWriter::write(const void* data, uint64_t size)
+{
+	if (ok_ && (size > 0))
+		ok_ = (file_.write((const char*)data, size) == (qint64)size);
+}
+
+void DecodeCacheWriter::write_padding()
+{
+	const char zeros[8] = {};
+	write(zeros, padding(file_.pos()));
+}
+
+DecodeCacheReader::DecodeCacheReader(const QString& file_path) :
+	file_(file_path),
+	data_(nullptr),
+	size_(0),
+	annotation_count_(0),
+	annotations_(nullptr)
+{
+}
+
+DecodeCacheReader::~DecodeCacheReader()
+{
+	if (data_)
+		file_.unmap((uchar*)data_);
+}
+
+bool DecodeCacheReader::open()
+{
+	if (!file_.open(QIODevice::ReadOnly))
+		return false;
+
+	size_ = file_.size();
+	if (size_ < sizeof(FileHeader))
+		return false;
+
+	data_ = file_.map(0, size_);
+	if (!data_)
+		return false;
+
+	const FileHeader* header = (const FileHeader*)data_;
+
+	if ((memcmp(header->magic, decodecache::Magic, sizeof(header->magic)) != 0) ||
+		(header->version != decodecache::Version) ||
+		(header->byte_order != decodecache::ByteOrderMark))
+		return false;
+
+	// Check that the sections are where they're supposed to be and
+	// don't overlap, so that a truncated or broken file can't be used
+	if ((header->annotation_count > (size_ - sizeof(FileHeader)) / sizeof(AnnotationRecord)) ||
+		(header->binary_data_offset < sizeof(FileHeader) +
+			header->annotation_count * sizeof(AnnotationRecord)) ||
+		(header->text_table_offset < header->binary_data_offset) ||
+		(header->text_table_offset > size_) ||
+		(header->text_count > (size_ - header->text_table_offset) / sizeof(TextTableEntry)))
+		return false;
+
+	annotation_count_ = header->annotation_count;
+	annotations_ = (const AnnotationRecord*)(data_ + sizeof(FileHeader));
+
+	uint64_t offset = header->binary_data_offset;
+	binary_data_.reserve(header->binary_data_count);
+
+	for (uint64_t i = 0; i < header->binary_data_count; i++) {
+		if (header->text_table_offset - offset < sizeof(BinaryDataRecord))
+			return false;
+
+		const BinaryDataRecord* record = (const BinaryDataRecord*)(data_ + offset);
+		offset += sizeof(BinaryDataRecord);
+
+		const uint64_t remaining = header->text_table_offset - offset;
+		if ((record->size > remaining) || (padding(record->size) > remaining - record->size))
+			return false;
+
+		binary_data_.push_back(record);
+		offset += record->size + padding(record->size);
+	}
+
+	const TextTableEntry* table = (const TextTableEntry*)(data_ + header->text_table_offset);
+	texts_.resize(header->text_count);
+
+	for (uint32_t i = 0; i < header->text_count; i++) {
+		const TextTableEntry& entry = table[i];
+
+		if ((entry.offset > size_) || (entry.length > size_ - entry.offset) ||
+			((entry.length > 0) && (data_[entry.offset + entry.length - 1] != 0)))
+			return false;
+
+		const char* c = (const char*)data_ + entry.offset;
+		const char* const end = c + entry.length;
+
+		while (c < end) {
+			texts_[i].push_back(c);
+			c += strlen(c) + 1;
+		}
+		texts_[i].push_back(nullptr);
+	}
+
+	for (uint64_t i = 0; i < annotation_count_; i++)
+		if (annotations_[i].text_id >= header->text_count)
+			return false;
+
+	return true;
+}
+
+uint64_t DecodeCacheReader::annotation_count() const
+{
+	return annotation_count_;
+}
+
+const AnnotationRecord* DecodeCacheReader::annotations() const
+{
+	return annotations_;
+}
+
+uint64_t DecodeCacheReader::binary_data_count() const
+{
+	return binary_data_.size();
+}
+
+const BinaryDataRecord* DecodeCacheReader::binary_data(uint64_t index) const
+{
+	return binary_data_.at(index);
+}
+
+const uint8_t* DecodeCacheReader::binary_data_bytes(uint64_t index) const
+{
+	return (const uint8_t*)(binary_data_.at(index) + 1);
+}
+
+uint32_t DecodeCacheReader::text_count() const
+{
+	return texts_.size();
+}
+
+const char* const* DecodeCacheReader::texts(uint32_t text_id) const
+{
+	return texts_.at(text_id).data();
+}
+
+} // namespace decode
+} // namespace data
+} // namespace pv
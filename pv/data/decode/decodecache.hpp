@@ -0,0 +1,171 @@
+/*
+ * This file is part of the PulseView project.
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PULSEVIEW_PV_DATA_DECODE_DECODECACHE_HPP
+#define PULSEVIEW_PV_DATA_DECODE_DECODECACHE_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+
+using std::vector;
+
+namespace pv {
+namespace data {
+namespace decode {
+
+/**
+ * Files holding the annotations and binary output of one decoded segment,
+ * named after a key that identifies the input data and the decoder setup.
+ *
+ * The file starts with a header, followed by the annotation records, the
+ * binary data records (each followed by its data), the text table and the
+ * texts. All numbers are stored in host byte order and all records are
+ * aligned to 8 bytes, so the file can be used as-is once it's mapped.
+ */
+namespace decodecache {
+
+struct AnnotationRecord
+{
+	uint64_t start_sample;
+	uint64_t end_sample;
+	uint32_t text_id;
+	uint32_t ann_class;
+	uint16_t decoder;   ///< Index of the decoder in the stack
+	uint16_t reserved1;
+	uint32_t reserved2;
+};
+
+struct BinaryDataRecord
+{
+	uint64_t sample;
+	uint64_t size;       ///< Number of data bytes following this record
+	uint32_t bin_class;
+	uint16_t decoder;   ///< Index of the decoder in the stack
+	uint16_t reserved;
+};
+
+/**
+ * Returns the directory that holds the cache files.
+ */
+QString cache_dir();
+
+/**
+ * Returns the path of the cache file for the given key.
+ */
+QString file_path(const QByteArray& key);
+
+/**
+ * Removes the oldest cache files until the remaining ones take no
+ * more than @c max_size bytes.
+ */
+void prune(uint64_t max_size);
+
+} // namespace decodecache
+
+/**
+ * Writes a cache file. All annotations must be added before any binary
+ * data. The file only appears under its final name once finish() succeeds.
+ */
+class DecodeCacheWriter
+{
+public:
+	DecodeCacheWriter(const QString& file_path);
+	~DecodeCacheWriter();
+
+	bool open();
+
+	/**
+	 * Adds a set of texts, given as consecutive NUL-terminated UTF-8 strings.
+	 * Returns the ID to refer to them by.
+	 */
+	uint32_t add_texts(const QByteArray& texts);
+
+	void add_annotation(uint16_t decoder, uint32_t ann_class,
+		uint64_t start_sample, uint64_t end_sample, uint32_t text_id);
+
+	void add_binary_data(uint16_t decoder, uint32_t bin_class,
+		uint64_t sample, const uint8_t* data, uint64_t size);
+
+	bool finish();
+
+private:
+	void write(const void* data, uint64_t size);
+	void write_padding();
+
+private:
+	const QString file_path_;
+	QFile file_;
+	bool ok_;
+
+	uint64_t annotation_count_, binary_data_count_;
+	uint64_t binary_data_offset_;
+
+	vector<QByteArray> texts_;
+};
+
+/**
+ * Reads a cache file by mapping it into memory.
+ */
+class DecodeCacheReader
+{
+public:
+	DecodeCacheReader(const QString& file_path);
+	~DecodeCacheReader();
+
+	/**
+	 * Maps the file and checks its structure. Returns false if the file
+	 * doesn't exist or can't be used.
+	 */
+	bool open();
+
+	uint64_t annotation_count() const;
+	const decodecache::AnnotationRecord* annotations() const;
+
+	uint64_t binary_data_count() const;
+	const decodecache::BinaryDataRecord* binary_data(uint64_t index) const;
+	const uint8_t* binary_data_bytes(uint64_t index) const;
+
+	uint32_t text_count() const;
+
+	/**
+	 * Returns the texts with the given ID as a NULL-terminated list of
+	 * UTF-8 strings, as libsigrokdecode provides them.
+	 */
+	const char* const* texts(uint32_t text_id) const;
+
+private:
+	QFile file_;
+	const uint8_t* data_;
+	uint64_t size_;
+
+	uint64_t annotation_count_;
+	const decodecache::AnnotationRecord* annotations_;
+	vector<const decodecache::BinaryDataRecord*> binary_data_;
+	vector< vector<const char*> > texts_;
+};
+
+} // namespace decode
+} // namespace data
+} // namespace pv
+
+#endif // PULSEVIEW_PV_DATA_DECODE_DECODECACHE_HPP
@@ -199,6 +199,16 @@ bool Decoder::have_required_channels() const
 }
 
 srd_decoder_inst* Decoder::create_decoder_inst(srd_session *session)
+{
+	if (decoder_inst_)
+		qDebug() << "WARNING: previous decoder instance" << decoder_inst_ << "exists";
+
+	decoder_inst_ = create_additional_decoder_inst(session);
+
+	return decoder_inst_;
+}
+
+srd_decoder_inst* Decoder::create_additional_decoder_inst(srd_session *session) const
 {
 	GHashTable *const opt_hash = g_hash_table_new_full(g_str_hash,
 		g_str_equal, g_free, (GDestroyNotify)g_variant_unref);
@@ -210,13 +220,10 @@ srd_decoder_inst* Decoder::create_decoder_inst(srd_session *session)
 			option.first.c_str()), value);
 	}
 
-	if (decoder_inst_)
-		qDebug() << "WARNING: previous decoder instance" << decoder_inst_ << "exists";
-
-	decoder_inst_ = srd_inst_new(session, srd_decoder_->id, opt_hash);
+	srd_decoder_inst *const decoder_inst = srd_inst_new(session, srd_decoder_->id, opt_hash);
 	g_hash_table_destroy(opt_hash);
 
-	if (!decoder_inst_)
+	if (!decoder_inst)
 		return nullptr;
 
 	// Setup the channels
@@ -240,12 +247,12 @@ srd_decoder_inst* Decoder::create_decoder_inst(srd_session *session)
 		g_hash_table_insert(channels, ch->pdch_->id, gvar);
 	}
 
-	srd_inst_channel_set_all(decoder_inst_, channels);
+	srd_inst_channel_set_all(decoder_inst, channels);
 
-	srd_inst_initial_pins_set_all(decoder_inst_, init_pin_states);
+	srd_inst_initial_pins_set_all(decoder_inst, init_pin_states);
 	g_array_free(init_pin_states, true);
 
-	return decoder_inst_;
+	return decoder_inst;
 }
 
 void Decoder::invalidate_decoder_inst()
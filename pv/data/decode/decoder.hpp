@@ -132,6 +132,13 @@ public:
 	bool have_required_channels() const;
 
 	srd_decoder_inst* create_decoder_inst(srd_session *session);
+
+	/**
+	 * Creates another instance of the decoder, e.g. to decode data in
+	 * parallel to the instance made by create_decoder_inst(). Unlike that
+	 * one, this instance isn't updated when options change.
+	 */
+	srd_decoder_inst* create_additional_decoder_inst(srd_session *session) const;
 	void invalidate_decoder_inst();
 
 	vector<Row*> get_rows();
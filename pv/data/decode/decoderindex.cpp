@@ -0,0 +1,343 @@
+/*
+ * This file is part of the PulseView project.
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+
+#include <libsigrokdecode/libsigrokdecode.h>
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStandardPaths>
+
+#include "decoderindex.hpp"
+
+#define DECODERS_HAVE_TAGS \
+	((SRD_PACKAGE_VERSION_MAJOR > 0) || \
+	 (SRD_PACKAGE_VERSION_MAJOR == 0) && (SRD_PACKAGE_VERSION_MINOR > 5))
+
+using std::lower_bound;
+using std::sort;
+
+namespace pv {
+namespace data {
+namespace decode {
+
+const int DecoderIndex::FormatVersion = 1;
+
+vector<DecoderInfo> DecoderIndex::decoders_;
+QStringList DecoderIndex::stamp_;
+
+static bool id_less(const DecoderInfo& a, const DecoderInfo& b)
+{
+	return a.id < b.id;
+}
+
+static QStringList string_list(const GSList* list)
+{
+	QStringList result;
+
+	for (const GSList* l = list; l; l = l->next)
+		result << QString::fromUtf8((const char*)l->data);
+
+	return result;
+}
+
+static QStringList channel_ids(const GSList* list)
+{
+	QStringList result;
+
+	for (const GSList* l = list; l; l = l->next)
+		result << QString::fromUtf8(((const srd_channel*)l->data)->id);
+
+	return result;
+}
+
+static QJsonArray to_json(const QStringList& list)
+{
+	QJsonArray result;
+
+	for (const QString& s : list)
+		result.append(s);
+
+	return result;
+}
+
+static QStringList from_json(const QJsonValue& value)
+{
+	QStringList result;
+
+	for (const QJsonValue& v : value.toArray())
+		result << v.toString();
+
+	return result;
+}
+
+void DecoderIndex::load()
+{
+	QStringList search_paths;
+	GSList* const paths = srd_searchpaths_get();
+	for (GSList* l = paths; l; l = l->next)
+		search_paths << QString::fromUtf8((const char*)l->data);
+	g_slist_free_full(paths, g_free);
+
+	stamp_ = directory_stamp(search_paths);
+	stamp_ << QString("libsigrokdecode %1").arg(srd_lib_version_string_get());
+
+	const QString path = file_path();
+
+	decoders_.clear();
+	if (read(path, stamp_, decoders_))
+		return;
+
+	qDebug() << "Protocol decoder index is out of date, loading all decoders";
+
+	decoders_.clear();
+	srd_decoder_load_all();
+	collect_loaded_decoders(decoders_);
+
+	if (!write(path, stamp_, decoders_))
+		qWarning() << "Failed to write protocol decoder index" << path;
+}
+
+const vector<DecoderInfo>& DecoderIndex::decoders()
+{
+	return decoders_;
+}
+
+const DecoderInfo* DecoderIndex::find(const QString& id)
+{
+	DecoderInfo key;
+	key.id = id;
+
+	const auto it = lower_bound(decoders_.begin(), decoders_.end(), key, id_less);
+
+	return ((it != decoders_.end()) && (it->id == id)) ? &(*it) : nullptr;
+}
+
+vector<const DecoderInfo*> DecoderIndex::decoders_providing(const QString& output)
+{
+	vector<const DecoderInfo*> result;
+
+	// TODO For now we ignore that the outputs are actually a list
+	for (const DecoderInfo& info : decoders_)
+		if (!info.outputs.isEmpty() && (info.outputs.front() == output))
+			result.push_back(&info);
+
+	return result;
+}
+
+srd_decoder* DecoderIndex::get_decoder(const QString& id)
+{
+	const QByteArray id_utf8 = id.toUtf8();
+
+	srd_decoder* dec = srd_decoder_get_by_id(id_utf8.constData());
+	if (dec)
+		return dec;
+
+	if (srd_decoder_load(id_utf8.constData()) != SRD_OK) {
+		qWarning() << "Failed to load protocol decoder" << id;
+		return nullptr;
+	}
+
+	return srd_decoder_get_by_id(id_utf8.constData());
+}
+
+QString DecoderIndex::file_path()
+{
+	return QStandardPaths::writableLocation(QStandardPaths::ConfigLocation) +
+		"/" + QCoreApplication::organizationName() + "/" +
+		QCoreApplication::applicationName() + "-decoders.json";
+}
+
+const QStringList& DecoderIndex::stamp()
+{
+	return stamp_;
+}
+
+QStringList DecoderIndex::directory_stamp(const QStringList& search_paths)
+{
+	QStringList stamp;
+
+	for (const QString& path : search_paths) {
+		const QFileInfo dir_info(path);
+		if (!dir_info.isDir())
+			continue;
+
+		stamp << QString("%1 %2").arg(dir_info.absoluteFilePath())
+			.arg(dir_info.lastModified().toMSecsSinceEpoch());
+
+		// Every decoder has a directory of its own
+		const QFileInfoList entries = QDir(path).entryInfoList(
+			QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name);
+
+		for (const QFileInfo& entry : entries)
+			stamp << QString("%1 %2").arg(entry.absoluteFilePath())
+				.arg(entry.lastModified().toMSecsSinceEpoch());
+	}
+
+	return stamp;
+}
+
+bool DecoderIndex::read(const QString& path, const QStringList& stamp,
+	vector<DecoderInfo>& decoders)
+{
+	QFile file(path);
+	if (!file.open(QIODevice::ReadOnly))
+		return false;
+
+	const QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+
+	if ((root.value("version").toInt() != FormatVersion) ||
+		(from_json(root.value("stamp")) != stamp))
+		return false;
+
+	const QJsonArray entries = root.value("decoders").toArray();
+	if (entries.isEmpty())
+		return false;
+
+	decoders.clear();
+	decoders.reserve(entries.size());
+
+	for (const QJsonValue& entry : entries) {
+		const QJsonObject obj = entry.toObject();
+
+		DecoderInfo info;
+		info.id = obj.value("id").toString();
+		info.name = obj.value("name").toString();
+		info.longname = obj.value("longname").toString();
+		info.desc = obj.value("desc").toString();
+		info.doc = obj.value("doc").toString();
+		info.tags = from_json(obj.value("tags"));
+		info.inputs = from_json(obj.value("inputs"));
+		info.outputs = from_json(obj.value("outputs"));
+		info.channels = from_json(obj.value("channels"));
+		info.opt_channels = from_json(obj.value("opt_channels"));
+		info.options = from_json(obj.value("options"));
+		info.classes = from_json(obj.value("classes"));
+
+		decoders.push_back(info);
+	}
+
+	sort(decoders.begin(), decoders.end(), id_less);
+
+	return true;
+}
+
+bool DecoderIndex::write(const QString& path, const QStringList& stamp,
+	const vector<DecoderInfo>& decoders)
+{
+	QJsonArray entries;
+
+	for (const DecoderInfo& info : decoders) {
+		QJsonObject obj;
+		obj.insert("id", info.id);
+		obj.insert("name", info.name);
+		obj.insert("longname", info.longname);
+		obj.insert("desc", info.desc);
+		obj.insert("doc", info.doc);
+		obj.insert("tags", to_json(info.tags));
+		obj.insert("inputs", to_json(info.inputs));
+		obj.insert("outputs", to_json(info.outputs));
+		obj.insert("channels", to_json(info.channels));
+		obj.insert("opt_channels", to_json(info.opt_channels));
+		obj.insert("options", to_json(info.options));
+		obj.insert("classes", to_json(info.classes));
+
+		entries.append(obj);
+	}
+
+	QJsonObject root;
+	root.insert("version", FormatVersion);
+	root.insert("stamp", to_json(stamp));
+	root.insert("decoders", entries);
+
+	QDir().mkpath(QFileInfo(path).path());
+
+	// Write to a temporary file first so that concurrently starting
+	// instances never see a partially written index
+	const QString temp_path = path + QString(".%1.tmp")
+		.arg(QCoreApplication::applicationPid());
+
+	QFile file(temp_path);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+		return false;
+
+	const QByteArray data = QJsonDocument(root).toJson(QJsonDocument::Compact);
+	const bool ok = (file.write(data) == data.size());
+	file.close();
+
+	if (!ok) {
+		QFile::remove(temp_path);
+		return false;
+	}
+
+	QFile::remove(path);
+	if (!QFile::rename(temp_path, path)) {
+		QFile::remove(temp_path);
+		return false;
+	}
+
+	return true;
+}
+
+void DecoderIndex::collect_loaded_decoders(vector<DecoderInfo>& decoders)
+{
+	for (const GSList* l = srd_decoder_list(); l; l = l->next) {
+		const srd_decoder* const d = (const srd_decoder*)l->data;
+
+		DecoderInfo info;
+		info.id = QString::fromUtf8(d->id);
+		info.name = QString::fromUtf8(d->name);
+		info.longname = QString::fromUtf8(d->longname);
+		info.desc = QString::fromUtf8(d->desc);
+
+		char* const doc = srd_decoder_doc_get(d);
+		info.doc = QString::fromUtf8(doc).trimmed();
+		g_free(doc);
+
+#if DECODERS_HAVE_TAGS
+		info.tags = string_list(d->tags);
+#endif
+		info.inputs = string_list(d->inputs);
+		info.outputs = string_list(d->outputs);
+		info.channels = channel_ids(d->channels);
+		info.opt_channels = channel_ids(d->opt_channels);
+
+		for (const GSList* o = d->options; o; o = o->next)
+			info.options << QString::fromUtf8(((const srd_decoder_option*)o->data)->id);
+
+		for (const GSList* a = d->annotations; a; a = a->next)
+			info.classes << QString::fromUtf8(((char**)a->data)[0]);
+
+		decoders.push_back(info);
+	}
+
+	sort(decoders.begin(), decoders.end(), id_less);
+}
+
+} // namespace decode
+} // namespace data
+} // namespace pv
@@ -0,0 +1,144 @@
+/*
+ * This file is part of the PulseView project.
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PULSEVIEW_PV_DATA_DECODE_DECODERINDEX_HPP
+#define PULSEVIEW_PV_DATA_DECODE_DECODERINDEX_HPP
+
+#include <vector>
+
+#include <QString>
+#include <QStringList>
+
+using std::vector;
+
+struct srd_decoder;
+
+namespace pv {
+namespace data {
+namespace decode {
+
+/**
+ * The metadata of a protocol decoder that is needed to offer it to the user
+ * without loading its Python module.
+ */
+struct DecoderInfo
+{
+	QString id;
+	QString name;
+	QString longname;
+	QString desc;
+	QString doc;
+	QStringList tags;
+	QStringList inputs;
+	QStringList outputs;
+	QStringList channels;       ///< IDs of the required channels
+	QStringList opt_channels;   ///< IDs of the optional channels
+	QStringList options;        ///< IDs of the options
+	QStringList classes;        ///< IDs of the annotation classes
+};
+
+/**
+ * Index of all protocol decoders found in the libsigrokdecode search paths.
+ *
+ * Importing every decoder module takes a long time, so the index is kept
+ * in a file in the config directory. The file is valid for as long as the
+ * modification times of the search paths and the decoder directories in
+ * them don't change. Only when it isn't, all decoders are loaded to build
+ * a new index. Otherwise a decoder's module is loaded when the decoder is
+ * first requested by get_decoder().
+ */
+class DecoderIndex
+{
+public:
+	static const int FormatVersion;
+
+public:
+	/**
+	 * Reads the index file or, if it's missing or out of date, loads all
+	 * decoders and writes a new one. Must be called after srd_init().
+	 */
+	static void load();
+
+	/**
+	 * Returns the known decoders, sorted by their IDs.
+	 */
+	static const vector<DecoderInfo>& decoders();
+
+	/**
+	 * Returns the decoder with the given ID or nullptr if there is none.
+	 */
+	static const DecoderInfo* find(const QString& id);
+
+	/**
+	 * Returns the decoders whose first output is @c output.
+	 */
+	static vector<const DecoderInfo*> decoders_providing(const QString& output);
+
+	/**
+	 * Returns the libsigrokdecode decoder with the given ID, loading its
+	 * module first if necessary. Returns nullptr if it can't be loaded.
+	 */
+	static srd_decoder* get_decoder(const QString& id);
+
+	/**
+	 * Returns the path of the index file.
+	 */
+	static QString file_path();
+
+	/**
+	 * Returns a list of strings that changes whenever a directory in
+	 * @c search_paths or one of their subdirectories is modified.
+	 */
+	static QStringList directory_stamp(const QStringList& search_paths);
+
+	/**
+	 * Returns the stamp of the decoder directories and the libsigrokdecode
+	 * version as determined by load(). It changes whenever a decoder may
+	 * have been updated.
+	 */
+	static const QStringList& stamp();
+
+	/**
+	 * Reads the index file at @c path into @c decoders if it was written
+	 * with the same @c stamp.
+	 * @return true if the file was read, false if it is missing, unreadable
+	 *         or out of date.
+	 */
+	static bool read(const QString& path, const QStringList& stamp,
+		vector<DecoderInfo>& decoders);
+
+	/**
+	 * Writes @c decoders to the index file at @c path, along with @c stamp.
+	 */
+	static bool write(const QString& path, const QStringList& stamp,
+		const vector<DecoderInfo>& decoders);
+
+private:
+	static void collect_loaded_decoders(vector<DecoderInfo>& decoders);
+
+private:
+	static vector<DecoderInfo> decoders_;
+	static QStringList stamp_;
+};
+
+} // namespace decode
+} // namespace data
+} // namespace pv
+
+#endif // PULSEVIEW_PV_DATA_DECODE_DECODERINDEX_HPP
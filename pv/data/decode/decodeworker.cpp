@@ -0,0 +1,479 @@
+/*
+ * This file is part of the PulseView project.
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <libsigrokdecode/libsigrokdecode.h> /* First, so we avoid a _POSIX_C_SOURCE warning. */
+
+#include "config.h"
+
+#include <cassert>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#include <QByteArray>
+#include <QDataStream>
+#include <QSharedMemory>
+
+#include "decodeworker.hpp"
+#include "remoteprotocol.hpp"
+
+using std::lock_guard;
+using std::map;
+using std::mutex;
+using std::pair;
+using std::vector;
+
+namespace pv {
+namespace data {
+namespace decode {
+
+namespace {
+
+struct DecoderConfig
+{
+	QByteArray id;
+	vector< pair<QByteArray, QByteArray> > options;  ///< Key and GVariant text
+	vector< pair<QByteArray, qint32> > channels;     ///< Channel ID and bit index
+	QByteArray initial_pins;
+};
+
+class DecodeWorker
+{
+public:
+	DecodeWorker(const char* shm_key);
+
+	int run();
+
+private:
+	bool read_message(QByteArray& message);
+	void write_message(const QByteArray& message);
+	void send_error(const QByteArray& text);
+
+	bool setup(const QByteArray& message);
+
+	bool create_session(uint64_t samplerate);
+	void reset_session(uint64_t samplerate);
+	void destroy_session();
+
+	GHashTable* create_option_hash(const DecoderConfig& config) const;
+
+	void handle_data(QDataStream& stream);
+
+	static void annotation_callback(srd_proto_data *pdata, void *worker);
+	static void binary_callback(srd_proto_data *pdata, void *worker);
+
+private:
+	const char* const shm_key_;
+	QSharedMemory shm_;
+	uint32_t slot_size_;
+
+	FILE* input_;
+	FILE* output_;
+	mutex output_mutex_;
+
+	vector<DecoderConfig> decoders_;
+
+	srd_session* session_;
+	vector<srd_decoder_inst*> instances_;
+	map<const srd_decoder_inst*, quint32> instance_indices_;
+};
+
+DecodeWorker::DecodeWorker(const char* shm_key) :
+	shm_key_(shm_key),
+	slot_size_(0),
+	input_(stdin),
+	output_(nullptr),
+	session_(nullptr)
+{
+}
+
+int DecodeWorker::run()
+{
+	// Anything the decoders print would corrupt the messages, so the
+	// messages get a file descriptor of their own and stdout is pointed
+	// to stderr instead
+#ifdef _WIN32
+	_setmode(_fileno(stdin), _O_BINARY);
+	const int output_fd = _dup(_fileno(stdout));
+	_dup2(_fileno(stderr), _fileno(stdout));
+	output_ = _fdopen(output_fd, "wb");
+#else
+	const int output_fd = dup(fileno(stdout));
+	dup2(fileno(stderr), fileno(stdout));
+	output_ = fdopen(output_fd, "wb");
+#endif
+
+	if (!output_)
+		return 1;
+
+	QByteArray message;
+	if (!read_message(message) || !setup(message)) {
+		fclose(output_);
+		return 1;
+	}
+
+	while (read_message(message)) {
+		QDataStream stream(message);
+		quint8 type;
+		stream >> type;
+
+		switch (type) {
+		case RemoteData:
+			handle_data(stream);
+			break;
+		case RemoteEndOfSegment:
+		{
+#if defined HAVE_SRD_SESSION_SEND_EOF && HAVE_SRD_SESSION_SEND_EOF
+			(void)srd_session_send_eof(session_);
+#endif
+			QByteArray reply;
+			QDataStream reply_stream(&reply, QIODevice::WriteOnly);
+			reply_stream << (quint8)RemoteEndOfSegmentDone;
+			write_message(reply);
+			break;
+		}
+		case RemoteReset:
+		{
+			quint64 samplerate;
+			stream >> samplerate;
+			reset_session(samplerate);
+			break;
+		}
+		default:
+			send_error("Unknown message received");
+		}
+	}
+
+	// The RemoteDecoder closed the connection, so we're done
+	destroy_session();
+	srd_exit();
+	shm_.detach();
+	fclose(output_);
+
+	return 0;
+}
+
+bool DecodeWorker::read_message(QByteArray& message)
+{
+	uint8_t header[4];
+	if (fread(header, 1, sizeof(header), input_) != sizeof(header))
+		return false;
+
+	const uint32_t length = ((uint32_t)header[0] << 24) | ((uint32_t)header[1] << 16) |
+		((uint32_t)header[2] << 8) | header[3];
+
+	message.resize(length);
+	return (fread(message.data(), 1, length, input_) == length);
+}
+
+void DecodeWorker::write_message(const QByteArray& message)
+{
+	const uint32_t length = message.size();
+	const uint8_t header[4] = {(uint8_t)(length >> 24), (uint8_t)(length >> 16),
+		(uint8_t)(length >> 8), (uint8_t)length};
+
+	// The decoders may emit output from threads of their own
+	lock_guard<mutex> lock(output_mutex_);
+
+	fwrite(header, 1, sizeof(header), output_);
+	fwrite(message.constData(), 1, length, output_);
+	fflush(output_);
+}
+
+void DecodeWorker::send_error(const QByteArray& text)
+{
+	QByteArray message;
+	QDataStream stream(&message, QIODevice::WriteOnly);
+	stream << (quint8)RemoteError << text;
+	write_message(message);
+}
+
+bool DecodeWorker::setup(const QByteArray& message)
+{
+	QDataStream stream(message);
+
+	quint8 type;
+	quint64 samplerate;
+	quint32 slot_size, decoder_count;
+
+	stream >> type;
+	if (type != RemoteSetup) {
+		send_error("Decoder process wasn't set up");
+		return false;
+	}
+
+	stream >> samplerate >> slot_size >> decoder_count;
+	slot_size_ = slot_size;
+
+	for (quint32 i = 0; i < decoder_count; i++) {
+		DecoderConfig config;
+		quint32 count;
+
+		stream >> config.id;
+
+		stream >> count;
+		for (quint32 j = 0; j < count; j++) {
+			QByteArray key, value;
+			stream >> key >> value;
+			config.options.emplace_back(key, value);
+		}
+
+		stream >> count;
+		for (quint32 j = 0; j < count; j++) {
+			QByteArray channel_id;
+			qint32 bit_id;
+			stream >> channel_id >> bit_id;
+			config.channels.emplace_back(channel_id, bit_id);
+		}
+
+		stream >> config.initial_pins;
+
+		decoders_.push_back(config);
+	}
+
+	if (stream.status() != QDataStream::Ok) {
+		send_error("Malformed setup message");
+		return false;
+	}
+
+	shm_.setKey(shm_key_);
+	if (!shm_.attach(QSharedMemory::ReadOnly)) {
+		send_error(shm_.errorString().toUtf8());
+		return false;
+	}
+
+	if (srd_init(nullptr) != SRD_OK) {
+		send_error("Failed to initialize libsigrokdecode");
+		return false;
+	}
+
+	for (const DecoderConfig& config : decoders_)
+		if (srd_decoder_load(config.id.constData()) != SRD_OK) {
+			send_error("Failed to load decoder " + config.id);
+			return false;
+		}
+
+	if (!create_session(samplerate)) {
+		send_error("Failed to create decoder instance");
+		return false;
+	}
+
+	return true;
+}
+
+bool DecodeWorker::create_session(uint64_t samplerate)
+{
+	srd_session_new(&session_);
+	assert(session_);
+
+	srd_decoder_inst *prev_di = nullptr;
+	for (size_t i = 0; i < decoders_.size(); i++) {
+		const DecoderConfig& config = decoders_[i];
+
+		GHashTable *const opt_hash = create_option_hash(config);
+		srd_decoder_inst *const di = srd_inst_new(session_, config.id.constData(), opt_hash);
+		g_hash_table_destroy(opt_hash);
+
+		if (!di)
+			return false;
+
+		GHashTable *const channels = g_hash_table_new_full(g_str_hash,
+			g_str_equal, g_free, (GDestroyNotify)g_variant_unref);
+
+		for (const pair<QByteArray, qint32>& channel : config.channels)
+			g_hash_table_insert(channels, g_strdup(channel.first.constData()),
+				g_variant_ref_sink(g_variant_new_int32(channel.second)));
+
+		srd_inst_channel_set_all(di, channels);
+		g_hash_table_destroy(channels);
+
+		GArray *const init_pin_states = g_array_sized_new(false, true,
+			sizeof(uint8_t), config.initial_pins.size());
+		g_array_append_vals(init_pin_states, config.initial_pins.constData(),
+			config.initial_pins.size());
+
+		srd_inst_initial_pins_set_all(di, init_pin_states);
+		g_array_free(init_pin_states, true);
+
+		if (prev_di)
+			srd_inst_stack(session_, prev_di, di);
+
+		instances_.push_back(di);
+		instance_indices_[di] = i;
+		prev_di = di;
+	}
+
+	if (samplerate)
+		srd_session_metadata_set(session_, SRD_CONF_SAMPLERATE,
+			g_variant_new_uint64(samplerate));
+
+	srd_pd_output_callback_add(session_, SRD_OUTPUT_ANN,
+		DecodeWorker::annotation_callback, this);
+
+	srd_pd_output_callback_add(session_, SRD_OUTPUT_BINARY,
+		DecodeWorker::binary_callback, this);
+
+	srd_session_start(session_);
+
+	return true;
+}
+
+void DecodeWorker::reset_session(uint64_t samplerate)
+{
+	// Same as DecodeSignal::terminate_srd_session(), the decoder stack
+	// is kept and only its state is reset
+#if defined HAVE_SRD_SESSION_SEND_EOF && HAVE_SRD_SESSION_SEND_EOF
+	(void)srd_session_send_eof(session_);
+#endif
+	srd_session_terminate_reset(session_);
+
+	// Metadata and options are cleared also, so re-set them
+	if (samplerate)
+		srd_session_metadata_set(session_, SRD_CONF_SAMPLERATE,
+			g_variant_new_uint64(samplerate));
+
+	for (size_t i = 0; i < instances_.size(); i++) {
+		GHashTable *const opt_hash = create_option_hash(decoders_[i]);
+		srd_inst_option_set(instances_[i], opt_hash);
+		g_hash_table_destroy(opt_hash);
+	}
+
+	srd_session_start(session_);
+}
+
+void DecodeWorker::destroy_session()
+{
+	if (session_)
+		srd_session_destroy(session_);
+
+	session_ = nullptr;
+	instances_.clear();
+	instance_indices_.clear();
+}
+
+GHashTable* DecodeWorker::create_option_hash(const DecoderConfig& config) const
+{
+	GHashTable *const opt_hash = g_hash_table_new_full(g_str_hash,
+		g_str_equal, g_free, (GDestroyNotify)g_variant_unref);
+
+	for (const pair<QByteArray, QByteArray>& option : config.options) {
+		GVariant *const value = g_variant_parse(nullptr,
+			option.second.constData(), nullptr, nullptr, nullptr);
+
+		if (value)
+			g_hash_table_replace(opt_hash, (void*)g_strdup(
+				option.first.constData()), value);
+	}
+
+	return opt_hash;
+}
+
+void DecodeWorker::handle_data(QDataStream& stream)
+{
+	quint32 slot, unit_size;
+	qint64 start_sample, end_sample;
+	stream >> slot >> start_sample >> end_sample >> unit_size;
+
+	const uint64_t size = (end_sample - start_sample) * unit_size;
+
+	if ((stream.status() != QDataStream::Ok) || (size > slot_size_) ||
+		((slot + 1) * (uint64_t)slot_size_ > (uint64_t)shm_.size())) {
+		send_error("Malformed data message");
+		return;
+	}
+
+	const uint8_t* data = (const uint8_t*)shm_.constData() + slot * slot_size_;
+
+	if (srd_session_send(session_, start_sample, end_sample, data, size,
+			unit_size) != SRD_OK)
+		send_error("Decoder reported an error");
+
+	// The slot may be re-used now
+	QByteArray reply;
+	QDataStream reply_stream(&reply, QIODevice::WriteOnly);
+	reply_stream << (quint8)RemoteConsumed << slot << end_sample;
+	write_message(reply);
+}
+
+void DecodeWorker::annotation_callback(srd_proto_data *pdata, void *worker)
+{
+	assert(pdata);
+	assert(worker);
+
+	DecodeWorker *const w = (DecodeWorker*)worker;
+
+	const srd_proto_data_annotation *const pda = (const srd_proto_data_annotation*)pdata->data;
+	assert(pda);
+
+	quint32 text_count = 0;
+	while (pda->ann_text[text_count])
+		text_count++;
+
+	QByteArray message;
+	QDataStream stream(&message, QIODevice::WriteOnly);
+	stream << (quint8)RemoteAnnotation << w->instance_indices_.at(pdata->pdo->di) <<
+		(quint64)pdata->start_sample << (quint64)pdata->end_sample <<
+		(qint32)pda->ann_class << text_count;
+
+	for (quint32 i = 0; i < text_count; i++)
+		stream << QByteArray(pda->ann_text[i]);
+
+	w->write_message(message);
+}
+
+void DecodeWorker::binary_callback(srd_proto_data *pdata, void *worker)
+{
+	assert(pdata);
+	assert(worker);
+
+	DecodeWorker *const w = (DecodeWorker*)worker;
+
+	const srd_proto_data_binary *const pdb = (const srd_proto_data_binary*)pdata->data;
+	assert(pdb);
+
+	QByteArray message;
+	QDataStream stream(&message, QIODevice::WriteOnly);
+	stream << (quint8)RemoteBinary << w->instance_indices_.at(pdata->pdo->di) <<
+		(quint64)pdata->start_sample << (quint64)pdata->end_sample <<
+		(qint32)pdb->bin_class <<
+		QByteArray((const char*)pdb->data, pdb->size);
+
+	w->write_message(message);
+}
+
+} // namespace
+
+int run_decode_worker(const char* shm_key)
+{
+	DecodeWorker worker(shm_key);
+	return worker.run();
+}
+
+} // namespace decode
+} // namespace data
+} // namespace pv
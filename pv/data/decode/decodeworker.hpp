@@ -0,0 +1,43 @@
+/*
+ * This file is part of the PulseView project.
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PULSEVIEW_PV_DATA_DECODE_DECODEWORKER_HPP
+#define PULSEVIEW_PV_DATA_DECODE_DECODEWORKER_HPP
+
+namespace pv {
+namespace data {
+namespace decode {
+
+/**
+ * Runs a decoder stack on behalf of a RemoteDecoder in another process.
+ *
+ * The stack is set up as described by the first message read from stdin.
+ * After that, sample data is taken from the shared memory segment named
+ * @c shm_key and the output of the decoders is written to stdout until
+ * stdin is closed.
+ *
+ * @return The exit code of the process.
+ */
+int run_decode_worker(const char* shm_key);
+
+} // namespace decode
+} // namespace data
+} // namespace pv
+
+#endif // PULSEVIEW_PV_DATA_DECODE_DECODEWORKER_HPP
@@ -0,0 +1,152 @@
+/*
+ * This file is part of the PulseView project.
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#include "logicmux.hpp"
+
+using std::min;
+using std::pair;
+
+namespace pv {
+namespace data {
+namespace decode {
+
+/**
+ * Transposes the 8x8 bit matrix whose rows are the bytes of @c x, i.e.
+ * bit j of byte i becomes bit i of byte j.
+ * See Hacker's Delight, 2nd edition, section 7-3.
+ */
+static inline uint64_t transpose_8x8(uint64_t x)
+{
+	uint64_t t;
+
+	t = (x ^ (x >> 7)) & 0x00AA00AA00AA00AAULL;
+	x = x ^ t ^ (t << 7);
+	t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCCULL;
+	x = x ^ t ^ (t << 14);
+	t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0ULL;
+	x = x ^ t ^ (t << 28);
+
+	return x;
+}
+
+/**
+ * Loads up to 8 bytes that are @c stride bytes apart into a word,
+ * the first one becoming the least significant byte.
+ */
+static inline uint64_t gather_bytes(const uint8_t* src, uint64_t stride,
+	unsigned int count)
+{
+	uint64_t x = 0;
+
+	for (unsigned int i = 0; i < count; i++)
+		x |= (uint64_t)src[i * stride] << (8 * i);
+
+	return x;
+}
+
+void mux_logic_channels(const vector<MuxChannel>& channels, uint64_t sample_count,
+	uint8_t* output, unsigned int out_unit_size)
+{
+	const uint64_t group_count = (sample_count + 7) / 8;
+	const size_t channel_count = channels.size();
+
+	// Bit planes, one byte per group of 8 samples and channel.
+	// Bit k of planes[ch * group_count + g] is channel ch of sample 8g+k
+	vector<uint8_t> planes((channel_count + 7) / 8 * 8 * group_count, 0);
+
+	// Split the input samples into bit planes. All channels found in the
+	// same byte of the same input are taken care of by one transposition
+	vector<bool> done(channel_count, false);
+
+	for (size_t i = 0; i < channel_count; i++) {
+		if (done[i])
+			continue;
+
+		const MuxChannel& source = channels[i];
+		const unsigned int byte_index = source.bit_index / 8;
+
+		vector< pair<size_t, unsigned int> > targets;
+		for (size_t j = i; j < channel_count; j++)
+			if ((channels[j].data == source.data) &&
+				(channels[j].unit_size == source.unit_size) &&
+				(channels[j].bit_index / 8 == byte_index)) {
+				targets.emplace_back(j, channels[j].bit_index % 8);
+				done[j] = true;
+			}
+
+		const uint8_t* src = source.data + byte_index;
+		const unsigned int stride = source.unit_size;
+
+		for (uint64_t g = 0; g < group_count; g++) {
+			const unsigned int count = min(sample_count - g * 8, (uint64_t)8);
+			const uint64_t x =
+				transpose_8x8(gather_bytes(src + g * 8 * stride, stride, count));
+
+			for (const pair<size_t, unsigned int>& target : targets)
+				planes[target.first * group_count + g] = x >> (8 * target.second);
+		}
+	}
+
+	// Assemble the output samples from the bit planes, 8 channels at a time
+	for (unsigned int out_byte = 0; out_byte < out_unit_size; out_byte++) {
+		const size_t first_channel = out_byte * 8;
+
+		if (first_channel >= channel_count) {
+			for (uint64_t s = 0; s < sample_count; s++)
+				output[s * out_unit_size + out_byte] = 0;
+			continue;
+		}
+
+		const uint8_t* plane = planes.data() + first_channel * group_count;
+		uint8_t* dest = output + out_byte;
+
+		for (uint64_t g = 0; g < group_count; g++) {
+			const unsigned int count = min(sample_count - g * 8, (uint64_t)8);
+			const uint64_t x = transpose_8x8(gather_bytes(plane + g, group_count, 8));
+
+			for (unsigned int k = 0; k < count; k++)
+				dest[(g * 8 + k) * out_unit_size] = x >> (8 * k);
+		}
+	}
+}
+
+void mux_logic_channels_bitwise(const vector<MuxChannel>& channels,
+	uint64_t sample_count, uint8_t* output, unsigned int out_unit_size)
+{
+	memset(output, 0, sample_count * out_unit_size);
+
+	for (uint64_t s = 0; s < sample_count; s++) {
+		uint8_t* const out_sample = output + s * out_unit_size;
+
+		for (size_t i = 0; i < channels.size(); i++) {
+			const MuxChannel& ch = channels[i];
+			const uint8_t in_sample = 1 &
+				(ch.data[s * ch.unit_size + ch.bit_index / 8] >> (ch.bit_index % 8));
+
+			out_sample[i / 8] |= in_sample << (i % 8);
+		}
+	}
+}
+
+} // namespace decode
+} // namespace data
+} // namespace pv
@@ -0,0 +1,66 @@
+/*
+ * This file is part of the PulseView project.
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PULSEVIEW_PV_DATA_DECODE_LOGICMUX_HPP
+#define PULSEVIEW_PV_DATA_DECODE_LOGICMUX_HPP
+
+#include <cstdint>
+#include <vector>
+
+using std::vector;
+
+namespace pv {
+namespace data {
+namespace decode {
+
+/**
+ * Describes where the samples of a channel that is to be muxed are found.
+ */
+struct MuxChannel
+{
+	const uint8_t* data;     ///< The samples of the signal the channel belongs to
+	unsigned int unit_size;  ///< Size of one of those samples in bytes
+	unsigned int bit_index;  ///< Position of the channel's bit within a sample
+};
+
+/**
+ * Combines the given channels into samples of @c out_unit_size bytes each,
+ * with channel n becoming bit n of the output samples. Unused output bits
+ * are set to 0.
+ *
+ * The samples are processed in groups of 8, transposing 8x8 bit matrices
+ * held in a 64-bit word: first to split the input samples into per-channel
+ * bit planes, then to assemble the output samples from those planes.
+ */
+void mux_logic_channels(const vector<MuxChannel>& channels, uint64_t sample_count,
+	uint8_t* output, unsigned int out_unit_size);
+
+/**
+ * Does the same as mux_logic_channels() one bit at a time. This is the
+ * straightforward reference implementation, kept for testing and
+ * benchmarking.
+ */
+void mux_logic_channels_bitwise(const vector<MuxChannel>& channels,
+	uint64_t sample_count, uint8_t* output, unsigned int out_unit_size);
+
+} // namespace decode
+} // namespace data
+} // namespace pv
+
+#endif // PULSEVIEW_PV_DATA_DECODE_LOGICMUX_HPP
@@ -0,0 +1,131 @@
+/*
+ * This file is part of the PulseView project.
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cassert>
+
+#include "muxcache.hpp"
+
+using std::lock_guard;
+
+namespace pv {
+namespace data {
+namespace decode {
+
+const unsigned int MuxCache::DefaultRetainedBlockCount = 16;
+
+MuxCache::MuxCache(unsigned int retained_block_count) :
+	retained_block_count_(retained_block_count)
+{
+}
+
+MuxCache::Block MuxCache::find(const vector<MuxInput>& inputs, int64_t start,
+	int64_t end)
+{
+	lock_guard<mutex> lock(mutex_);
+
+	const auto it = entries_.find(make_key(inputs, start, end));
+	if ((it == entries_.end()) || !is_valid(it->second))
+		return nullptr;
+
+	return it->second.block.lock();
+}
+
+void MuxCache::insert(const vector<MuxInput>& inputs, int64_t start, int64_t end,
+	Block block)
+{
+	assert(block);
+
+	lock_guard<mutex> lock(mutex_);
+
+	Entry& entry = entries_[make_key(inputs, start, end)];
+	entry.segments.clear();
+	for (const MuxInput& input : inputs)
+		entry.segments.emplace_back(input.segment);
+	entry.block = block;
+
+	retained_blocks_.push_back(block);
+	if (retained_blocks_.size() > retained_block_count_)
+		retained_blocks_.pop_front();
+
+	// Every decode signal holds a few blocks at most, so the entries only
+	// need to be checked now and then
+	if (entries_.size() > 2 * retained_block_count_ + 64)
+		purge();
+}
+
+void MuxCache::clear()
+{
+	lock_guard<mutex> lock(mutex_);
+
+	entries_.clear();
+	retained_blocks_.clear();
+}
+
+size_t MuxCache::size()
+{
+	lock_guard<mutex> lock(mutex_);
+
+	purge();
+
+	return entries_.size();
+}
+
+MuxCache::Key MuxCache::make_key(const vector<MuxInput>& inputs, int64_t start,
+	int64_t end)
+{
+	Key key;
+	key.reserve(2 * inputs.size() + 2);
+
+	// A segment can only be at this address as long as it exists, which
+	// is made sure of by the weak pointers in the entry
+	for (const MuxInput& input : inputs) {
+		key.push_back((uintptr_t)input.segment.get());
+		key.push_back(input.bit_index);
+	}
+
+	key.push_back(start);
+	key.push_back(end);
+
+	return key;
+}
+
+bool MuxCache::is_valid(const Entry& entry)
+{
+	if (entry.block.expired())
+		return false;
+
+	for (const weak_ptr<const void>& segment : entry.segments)
+		if (segment.expired())
+			return false;
+
+	return true;
+}
+
+void MuxCache::purge()
+{
+	for (auto it = entries_.begin(); it != entries_.end();)
+		if (is_valid(it->second))
+			++it;
+		else
+			it = entries_.erase(it);
+}
+
+} // namespace decode
+} // namespace data
+} // namespace pv
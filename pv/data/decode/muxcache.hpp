@@ -0,0 +1,116 @@
+/*
+ * This file is part of the PulseView project.
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PULSEVIEW_PV_DATA_DECODE_MUXCACHE_HPP
+#define PULSEVIEW_PV_DATA_DECODE_MUXCACHE_HPP
+
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+using std::deque;
+using std::map;
+using std::mutex;
+using std::shared_ptr;
+using std::vector;
+using std::weak_ptr;
+
+namespace pv {
+namespace data {
+namespace decode {
+
+/**
+ * One of the channels that are muxed, in the order of the decoder channels.
+ */
+struct MuxInput
+{
+	shared_ptr<const void> segment;  ///< The logic segment providing the channel
+	unsigned int bit_index;          ///< The channel's bit within its samples
+};
+
+/**
+ * Lets decode signals with identical inputs share their muxed samples.
+ *
+ * Blocks of muxed samples are found by the ordered list of inputs and the
+ * sample range they cover. A block lives for as long as any decode signal
+ * uses it; the most recently added blocks are kept a little longer so that
+ * decode signals that don't progress in lockstep can still pick them up.
+ * Blocks are never handed out once one of their input segments is gone.
+ */
+class MuxCache
+{
+public:
+	typedef shared_ptr<const vector<uint8_t> > Block;
+
+	static const unsigned int DefaultRetainedBlockCount;
+
+public:
+	MuxCache(unsigned int retained_block_count = DefaultRetainedBlockCount);
+
+	/**
+	 * Returns the block holding the muxed samples [start, end) of the given
+	 * inputs or nullptr if there is none.
+	 */
+	Block find(const vector<MuxInput>& inputs, int64_t start, int64_t end);
+
+	/**
+	 * Makes a block of muxed samples [start, end) available to others.
+	 */
+	void insert(const vector<MuxInput>& inputs, int64_t start, int64_t end,
+		Block block);
+
+	void clear();
+
+	/**
+	 * Returns the number of blocks that can currently be found.
+	 */
+	size_t size();
+
+private:
+	struct Entry
+	{
+		vector< weak_ptr<const void> > segments;
+		weak_ptr<const vector<uint8_t> > block;
+	};
+
+	typedef vector<uintptr_t> Key;
+
+	static Key make_key(const vector<MuxInput>& inputs, int64_t start, int64_t end);
+	static bool is_valid(const Entry& entry);
+
+	/// Drops the entries whose block or input segments are gone
+	void purge();
+
+private:
+	const unsigned int retained_block_count_;
+
+	map<Key, Entry> entries_;
+	deque<Block> retained_blocks_;
+
+	mutex mutex_;
+};
+
+} // namespace decode
+} // namespace data
+} // namespace pv
+
+#endif // PULSEVIEW_PV_DATA_DECODE_MUXCACHE_HPP
@@ -0,0 +1,128 @@
+/*
+ * This file is part of the PulseView project.
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cassert>
+
+#include "muxqueue.hpp"
+
+using std::lock_guard;
+using std::unique_lock;
+
+namespace pv {
+namespace data {
+namespace decode {
+
+MuxQueue::MuxQueue(unsigned int chunk_count) :
+	chunks_(chunk_count),
+	interrupted_(false)
+{
+	assert(chunk_count > 0);
+
+	for (MuxChunk& chunk : chunks_)
+		free_chunks_.push_back(&chunk);
+}
+
+MuxChunk* MuxQueue::get_free_chunk()
+{
+	unique_lock<mutex> lock(mutex_);
+
+	while (!interrupted_ && free_chunks_.empty())
+		free_cond_.wait(lock);
+
+	if (interrupted_)
+		return nullptr;
+
+	MuxChunk* chunk = free_chunks_.front();
+	free_chunks_.pop_front();
+
+	return chunk;
+}
+
+void MuxQueue::push(MuxChunk* chunk)
+{
+	{
+		lock_guard<mutex> lock(mutex_);
+		filled_chunks_.push_back(chunk);
+	}
+
+	filled_cond_.notify_one();
+}
+
+MuxChunk* MuxQueue::pop()
+{
+	unique_lock<mutex> lock(mutex_);
+
+	while (!interrupted_ && filled_chunks_.empty())
+		filled_cond_.wait(lock);
+
+	if (interrupted_)
+		return nullptr;
+
+	MuxChunk* chunk = filled_chunks_.front();
+	filled_chunks_.pop_front();
+
+	return chunk;
+}
+
+void MuxQueue::release(MuxChunk* chunk)
+{
+	{
+		lock_guard<mutex> lock(mutex_);
+		free_chunks_.push_back(chunk);
+	}
+
+	free_cond_.notify_one();
+}
+
+unsigned int MuxQueue::filled_count()
+{
+	lock_guard<mutex> lock(mutex_);
+
+	return filled_chunks_.size();
+}
+
+void MuxQueue::interrupt()
+{
+	{
+		lock_guard<mutex> lock(mutex_);
+		interrupted_ = true;
+	}
+
+	free_cond_.notify_all();
+	filled_cond_.notify_all();
+}
+
+void MuxQueue::reset()
+{
+	lock_guard<mutex> lock(mutex_);
+
+	// Chunks may still have been held by the producer or consumer when they
+	// were interrupted, so collect all of them
+	free_chunks_.clear();
+	filled_chunks_.clear();
+
+	for (MuxChunk& chunk : chunks_)
+		free_chunks_.push_back(&chunk);
+
+	interrupted_ = false;
+}
+
+} // namespace decode
+} // namespace data
+} // namespace pv
@@ -0,0 +1,125 @@
+/*
+ * This file is part of the PulseView project.
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PULSEVIEW_PV_DATA_DECODE_MUXQUEUE_HPP
+#define PULSEVIEW_PV_DATA_DECODE_MUXQUEUE_HPP
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+using std::condition_variable;
+using std::deque;
+using std::mutex;
+using std::shared_ptr;
+using std::vector;
+
+namespace pv {
+namespace data {
+namespace decode {
+
+/**
+ * A block of muxed samples on its way from the logic muxer to the decoders.
+ */
+struct MuxChunk
+{
+	uint32_t segment_id;
+	int64_t start_sample, end_sample;  ///< Sample range within the segment
+	unsigned int unit_size;
+	bool segment_complete;  ///< No more samples follow for this segment
+	vector<uint8_t> data;   ///< Keeps its capacity when the chunk is re-used
+
+	/// Muxed samples shared with other decode signals, used instead of data if set
+	shared_ptr<const vector<uint8_t> > shared_data;
+
+	const vector<uint8_t>& samples() const
+	{
+		return shared_data ? *shared_data : data;
+	}
+};
+
+/**
+ * A bounded FIFO of reusable chunks connecting one producer and one consumer.
+ *
+ * The producer takes a free chunk, fills it and pushes it. The consumer pops
+ * it and releases it when done, which makes it available to the producer
+ * again. Since the number of chunks is fixed, the producer can never get
+ * further ahead of the consumer than that.
+ */
+class MuxQueue
+{
+public:
+	MuxQueue(unsigned int chunk_count);
+
+	/**
+	 * Returns a chunk that may be filled, waiting until one becomes
+	 * available. Returns nullptr if the queue was interrupted.
+	 */
+	MuxChunk* get_free_chunk();
+
+	/**
+	 * Hands a chunk obtained by get_free_chunk() over to the consumer.
+	 */
+	void push(MuxChunk* chunk);
+
+	/**
+	 * Returns the oldest pushed chunk, waiting until there is one.
+	 * Returns nullptr if the queue was interrupted.
+	 */
+	MuxChunk* pop();
+
+	/**
+	 * Returns a chunk obtained by pop() so that it can be filled again.
+	 */
+	void release(MuxChunk* chunk);
+
+	/**
+	 * Returns the number of chunks that were pushed but not popped yet.
+	 */
+	unsigned int filled_count();
+
+	/**
+	 * Wakes up all waiting threads. Until reset() is called, get_free_chunk()
+	 * and pop() return nullptr.
+	 */
+	void interrupt();
+
+	/**
+	 * Discards all queued chunks and clears an interruption. Must only be
+	 * called when neither the producer nor the consumer are using the queue.
+	 */
+	void reset();
+
+private:
+	deque<MuxChunk> chunks_;
+	deque<MuxChunk*> free_chunks_, filled_chunks_;
+	bool interrupted_;
+
+	mutex mutex_;
+	condition_variable free_cond_, filled_cond_;
+};
+
+} // namespace decode
+} // namespace data
+} // namespace pv
+
+#endif // PULSEVIEW_PV_DATA_DECODE_MUXQUEUE_HPP
@@ -0,0 +1,208 @@
+/*
+ * This file is part of the PulseView project.
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <ctime>
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include "profiler.hpp"
+
+using std::max;
+using std::chrono::duration_cast;
+using std::chrono::nanoseconds;
+using std::chrono::steady_clock;
+
+namespace pv {
+namespace data {
+namespace decode {
+
+double Profiler::Snapshot::samples_per_second() const
+{
+	return (elapsed_time > 0) ? (sample_count / elapsed_time) : 0;
+}
+
+double Profiler::Snapshot::annotations_per_second() const
+{
+	return (elapsed_time > 0) ? (annotation_count / elapsed_time) : 0;
+}
+
+Profiler::StageTimer::StageTimer(Profiler& profiler, Stage stage) :
+	profiler_(profiler),
+	stage_(stage),
+	wall_start_(steady_clock::now()),
+	cpu_start_(thread_cpu_time())
+{
+}
+
+Profiler::StageTimer::~StageTimer()
+{
+	profiler_.add_stage_time(stage_, wall_start_, cpu_start_);
+}
+
+Profiler::Profiler()
+{
+	reset();
+}
+
+void Profiler::reset()
+{
+	start_ns_ = to_ns(steady_clock::now());
+
+	for (int i = 0; i < StageCount; i++) {
+		calls_[i] = 0;
+		wall_ns_[i] = 0;
+		cpu_ns_[i] = 0;
+	}
+
+	last_activity_ns_ = 0;
+	sample_count_ = 0;
+	annotation_count_ = 0;
+	queue_depth_count_ = 0;
+	queue_depth_sum_ = 0;
+	max_queue_depth_ = 0;
+}
+
+void Profiler::add_samples(uint64_t count)
+{
+	sample_count_ += count;
+	touch(steady_clock::now());
+}
+
+void Profiler::add_annotation()
+{
+	annotation_count_++;
+}
+
+void Profiler::add_queue_depth(unsigned int depth)
+{
+	queue_depth_count_++;
+	queue_depth_sum_ += depth;
+
+	unsigned int prev_max = max_queue_depth_;
+	while ((depth > prev_max) && !max_queue_depth_.compare_exchange_weak(prev_max, depth)) {}
+}
+
+Profiler::Snapshot Profiler::snapshot() const
+{
+	Snapshot s;
+
+	for (int i = 0; i < StageCount; i++) {
+		s.stages[i].calls = calls_[i];
+		s.stages[i].wall_time = wall_ns_[i] * 1e-9;
+		s.stages[i].cpu_time = cpu_ns_[i] * 1e-9;
+	}
+
+	s.elapsed_time = last_activity_ns_ * 1e-9;
+	s.sample_count = sample_count_;
+	s.annotation_count = annotation_count_;
+	s.max_queue_depth = max_queue_depth_;
+
+	const uint64_t depth_count = queue_depth_count_;
+	s.mean_queue_depth = (depth_count > 0) ? ((double)queue_depth_sum_ / depth_count) : 0;
+
+	return s;
+}
+
+const char* Profiler::stage_id(Stage stage)
+{
+	switch (stage) {
+	case CopyStage:       return "copy";
+	case MuxStage:        return "mux";
+	case DecodeStage:     return "decode";
+	case AnnotationStage: return "annotations";
+	default:              return "";
+	}
+}
+
+string Profiler::to_json(const Snapshot& snapshot, const vector<string>& decoder_ids)
+{
+	QJsonArray decoders;
+	for (const string& id : decoder_ids)
+		decoders.append(QString::fromStdString(id));
+
+	QJsonObject stages;
+	for (int i = 0; i < StageCount; i++) {
+		const StageTotals& stage = snapshot.stages[i];
+
+		QJsonObject totals;
+		totals.insert("calls", (qint64)stage.calls);
+		totals.insert("wall_s", stage.wall_time);
+		totals.insert("cpu_s", stage.cpu_time);
+		stages.insert(stage_id((Stage)i), totals);
+	}
+
+	QJsonObject queue;
+	queue.insert("max_depth", (int)snapshot.max_queue_depth);
+	queue.insert("mean_depth", snapshot.mean_queue_depth);
+
+	QJsonObject root;
+	root.insert("decoders", decoders);
+	root.insert("stages", stages);
+	root.insert("elapsed_s", snapshot.elapsed_time);
+	root.insert("samples", (qint64)snapshot.sample_count);
+	root.insert("samples_per_s", snapshot.samples_per_second());
+	root.insert("annotations", (qint64)snapshot.annotation_count);
+	root.insert("annotations_per_s", snapshot.annotations_per_second());
+	root.insert("queue", queue);
+
+	return QJsonDocument(root).toJson().toStdString();
+}
+
+void Profiler::add_stage_time(Stage stage, steady_clock::time_point wall_start,
+	uint64_t cpu_start)
+{
+	const steady_clock::time_point now = steady_clock::now();
+
+	calls_[stage]++;
+	wall_ns_[stage] += duration_cast<nanoseconds>(now - wall_start).count();
+	cpu_ns_[stage] += thread_cpu_time() - cpu_start;
+
+	touch(now);
+}
+
+void Profiler::touch(steady_clock::time_point now)
+{
+	const uint64_t ns = max<int64_t>(to_ns(now) - start_ns_, 0);
+
+	uint64_t prev = last_activity_ns_;
+	while ((ns > prev) && !last_activity_ns_.compare_exchange_weak(prev, ns)) {}
+}
+
+int64_t Profiler::to_ns(steady_clock::time_point t)
+{
+	return duration_cast<nanoseconds>(t.time_since_epoch()).count();
+}
+
+uint64_t Profiler::thread_cpu_time()
+{
+#ifdef CLOCK_THREAD_CPUTIME_ID
+	timespec ts;
+	if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0)
+		return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+#endif
+
+	return 0;
+}
+
+} // namespace decode
+} // namespace data
+} // namespace pv
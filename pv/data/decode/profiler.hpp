@@ -0,0 +1,145 @@
+/*
+ * This file is part of the PulseView project.
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PULSEVIEW_PV_DATA_DECODE_PROFILER_HPP
+#define PULSEVIEW_PV_DATA_DECODE_PROFILER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using std::atomic;
+using std::string;
+using std::vector;
+
+namespace pv {
+namespace data {
+namespace decode {
+
+/**
+ * Collects where the time of a decode run goes. The stages are timed by
+ * the threads executing them, so the totals are summed over all threads.
+ * Recording is lock-free and cheap enough to be always enabled.
+ */
+class Profiler
+{
+public:
+	enum Stage {
+		CopyStage,        ///< Reading the input samples from the logic segments
+		MuxStage,         ///< Muxing the input channels
+		DecodeStage,      ///< Running the protocol decoders
+		AnnotationStage,  ///< Storing the annotations the decoders output
+		StageCount
+	};
+
+	struct StageTotals
+	{
+		uint64_t calls;
+		double wall_time;  ///< In seconds
+		double cpu_time;   ///< In seconds, 0 if thread CPU time isn't available
+	};
+
+	struct Snapshot
+	{
+		/// The annotations are collected while the decoders run and stored
+		/// in one batch per chunk, which is what the annotation stage times
+		StageTotals stages[StageCount];
+
+		double elapsed_time;  ///< From the start until the last recorded activity
+		uint64_t sample_count;
+		uint64_t annotation_count;
+		unsigned int max_queue_depth;
+		double mean_queue_depth;
+
+		double samples_per_second() const;
+		double annotations_per_second() const;
+	};
+
+	/**
+	 * Adds the time from its construction to its destruction to the stage.
+	 */
+	class StageTimer
+	{
+	public:
+		StageTimer(Profiler& profiler, Stage stage);
+		~StageTimer();
+
+	private:
+		Profiler& profiler_;
+		const Stage stage_;
+		const std::chrono::steady_clock::time_point wall_start_;
+		const uint64_t cpu_start_;
+	};
+
+public:
+	Profiler();
+
+	/**
+	 * Clears all totals and restarts the elapsed time. Must not be called
+	 * while stages are being timed.
+	 */
+	void reset();
+
+	void add_samples(uint64_t count);
+	void add_annotation();
+
+	/**
+	 * Records the number of chunks waiting for the decoder.
+	 */
+	void add_queue_depth(unsigned int depth);
+
+	Snapshot snapshot() const;
+
+	static const char* stage_id(Stage stage);
+
+	/**
+	 * Formats the snapshot as a JSON object, along with the IDs of the
+	 * decoders in the stack that was profiled.
+	 */
+	static string to_json(const Snapshot& snapshot, const vector<string>& decoder_ids);
+
+private:
+	void add_stage_time(Stage stage, std::chrono::steady_clock::time_point wall_start,
+		uint64_t cpu_start);
+	void touch(std::chrono::steady_clock::time_point now);
+	static int64_t to_ns(std::chrono::steady_clock::time_point t);
+
+	/// CPU time of the calling thread in nanoseconds
+	static uint64_t thread_cpu_time();
+
+private:
+	atomic<int64_t> start_ns_;
+
+	atomic<uint64_t> calls_[StageCount];
+	atomic<uint64_t> wall_ns_[StageCount];
+	atomic<uint64_t> cpu_ns_[StageCount];
+
+	atomic<uint64_t> last_activity_ns_;  ///< Relative to start_ns_
+	atomic<uint64_t> sample_count_, annotation_count_;
+	atomic<uint64_t> queue_depth_count_, queue_depth_sum_;
+	atomic<unsigned int> max_queue_depth_;
+};
+
+} // namespace decode
+} // namespace data
+} // namespace pv
+
+#endif // PULSEVIEW_PV_DATA_DECODE_PROFILER_HPP
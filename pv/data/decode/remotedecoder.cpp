@@ -0,0 +1,419 @@
+/*
+ * This file is part of the PulseView project.
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QStringList>
+
+#include "decoder.hpp"
+#include "muxqueue.hpp"
+#include "remotedecoder.hpp"
+#include "remoteprotocol.hpp"
+
+using std::min;
+
+namespace pv {
+namespace data {
+namespace decode {
+
+const unsigned int RemoteDecoder::SlotCount = 4;
+
+/// Time in milliseconds to wait for the worker before checking for interruption
+static const int WorkerPollInterval = 100;
+
+RemoteDecoder::RemoteDecoder(const vector< shared_ptr<Decoder> >& stack,
+	const atomic<bool>& interrupt) :
+	stack_(stack),
+	interrupt_(interrupt),
+	slot_size_(0),
+	message_length_(0),
+	consumed_end_sample_(0),
+	instances_(stack.size()),
+	outputs_(stack.size()),
+	annotation_cb_(nullptr),
+	binary_cb_(nullptr),
+	cb_data_(nullptr)
+{
+	for (size_t i = 0; i < stack_.size(); i++) {
+		memset(&instances_[i], 0, sizeof(srd_decoder_inst));
+		instances_[i].decoder = const_cast<srd_decoder*>(stack_[i]->get_srd_decoder());
+
+		memset(&outputs_[i], 0, sizeof(srd_pd_output));
+		outputs_[i].di = &instances_[i];
+	}
+}
+
+RemoteDecoder::~RemoteDecoder()
+{
+	if (process_.state() != QProcess::NotRunning) {
+		// Closing its input makes the worker quit
+		process_.closeWriteChannel();
+
+		if (!process_.waitForFinished(1000)) {
+			process_.kill();
+			process_.waitForFinished(1000);
+		}
+	}
+}
+
+void RemoteDecoder::set_callbacks(srd_pd_output_callback annotation_cb,
+	srd_pd_output_callback binary_cb, void* cb_data)
+{
+	annotation_cb_ = annotation_cb;
+	binary_cb_ = binary_cb;
+	cb_data_ = cb_data;
+}
+
+bool RemoteDecoder::start(uint64_t samplerate, uint32_t slot_size)
+{
+	slot_size_ = slot_size;
+
+	// The key must be unique among all decoders of all PulseView instances
+	static atomic<unsigned int> instance_counter(0);
+	const QString key = QString("pulseview-decode-%1-%2").arg(
+		QCoreApplication::applicationPid()).arg(instance_counter++);
+
+	shm_.setKey(key);
+	if (!shm_.create(SlotCount * slot_size_)) {
+		error_ = shm_.errorString();
+		return false;
+	}
+
+	for (unsigned int i = 0; i < SlotCount; i++)
+		free_slots_.push_back(i);
+
+	// What the worker writes to stderr is what the decoders print
+	process_.setProcessChannelMode(QProcess::ForwardedErrorChannel);
+	process_.start(QCoreApplication::applicationFilePath(),
+		QStringList() << DECODE_WORKER_OPTION << key);
+
+	if (!process_.waitForStarted()) {
+		error_ = process_.errorString();
+		return false;
+	}
+
+	// Describe the decoder stack the same way Decoder::create_decoder_inst()
+	// sets up the decoder instances
+	QByteArray message;
+	QDataStream stream(&message, QIODevice::WriteOnly);
+	stream << (quint8)RemoteSetup << (quint64)samplerate << (quint32)slot_size_ <<
+		(quint32)stack_.size();
+
+	for (const shared_ptr<Decoder>& dec : stack_) {
+		stream << QByteArray(dec->get_srd_decoder()->id);
+
+		stream << (quint32)dec->options().size();
+		for (const auto& option : dec->options()) {
+			// Type annotations are included so that the value can be parsed back
+			gchar *const text = g_variant_print(option.second, TRUE);
+			stream << QByteArray(option.first.c_str()) << QByteArray(text);
+			g_free(text);
+		}
+
+		vector<const DecodeChannel*> channels;
+		for (const DecodeChannel* ch : dec->channels())
+			if (ch->assigned_signal)
+				channels.push_back(ch);
+
+		QByteArray initial_pins(dec->channels().size(), 0);
+
+		stream << (quint32)channels.size();
+		for (const DecodeChannel* ch : channels) {
+			stream << QByteArray(ch->pdch_->id) << (qint32)ch->bit_id;
+			if (ch->id < initial_pins.size())
+				initial_pins[ch->id] = ch->initial_pin_state;
+		}
+
+		stream << initial_pins;
+	}
+
+	return write_message(message);
+}
+
+bool RemoteDecoder::send(const MuxChunk* chunk)
+{
+	assert(chunk);
+
+	const int64_t slot_sample_count = slot_size_ / chunk->unit_size;
+	if (slot_sample_count == 0) {
+		error_ = "Samples don't fit into a shared memory slot";
+		return false;
+	}
+
+	uint8_t type;
+
+	for (int64_t start = chunk->start_sample; start < chunk->end_sample;
+		start += slot_sample_count) {
+		const int64_t end = min(start + slot_sample_count, chunk->end_sample);
+
+		while (free_slots_.empty())
+			if (!handle_next_message(type))
+				return false;
+
+		const uint32_t slot = free_slots_.front();
+		free_slots_.pop_front();
+
+		memcpy((uint8_t*)shm_.data() + slot * slot_size_,
+			chunk->samples().data() + (start - chunk->start_sample) * chunk->unit_size,
+			(end - start) * chunk->unit_size);
+
+		QByteArray message;
+		QDataStream stream(&message, QIODevice::WriteOnly);
+		stream << (quint8)RemoteData << slot << (qint64)start << (qint64)end <<
+			(quint32)chunk->unit_size;
+
+		if (!write_message(message))
+			return false;
+	}
+
+	// Handle the output that's already there so that annotations show up
+	// while the decoders are still busy
+	process_.waitForReadyRead(0);
+	while (message_available())
+		if (!handle_next_message(type))
+			return false;
+
+	return true;
+}
+
+bool RemoteDecoder::end_segment()
+{
+	QByteArray message;
+	QDataStream stream(&message, QIODevice::WriteOnly);
+	stream << (quint8)RemoteEndOfSegment;
+
+	if (!write_message(message))
+		return false;
+
+	// The worker handles the messages in order, so all samples that were
+	// sent have been consumed when it replies
+	uint8_t type;
+	do {
+		if (!handle_next_message(type))
+			return false;
+	} while (type != RemoteEndOfSegmentDone);
+
+	return true;
+}
+
+bool RemoteDecoder::reset(uint64_t samplerate)
+{
+	QByteArray message;
+	QDataStream stream(&message, QIODevice::WriteOnly);
+	stream << (quint8)RemoteReset << (quint64)samplerate;
+
+	consumed_end_sample_ = 0;
+
+	return write_message(message);
+}
+
+int64_t RemoteDecoder::consumed_end_sample() const
+{
+	return consumed_end_sample_;
+}
+
+const QString& RemoteDecoder::error() const
+{
+	return error_;
+}
+
+bool RemoteDecoder::write_message(const QByteArray& message)
+{
+	QByteArray frame;
+	QDataStream stream(&frame, QIODevice::WriteOnly);
+	stream << (quint32)message.size();
+	frame.append(message);
+
+	if (process_.write(frame) != frame.size()) {
+		error_ = process_.errorString();
+		return false;
+	}
+
+	// There's no event loop in the decode threads, so the data must be
+	// pushed out explicitly. While waiting, QProcess keeps reading the
+	// output of the worker, so it can't get stuck writing
+	while (process_.bytesToWrite() > 0) {
+		if (!check_worker())
+			return false;
+		process_.waitForBytesWritten(WorkerPollInterval);
+	}
+
+	return true;
+}
+
+bool RemoteDecoder::read_message(QByteArray& message)
+{
+	while (!message_available()) {
+		if (!check_worker())
+			return false;
+		process_.waitForReadyRead(WorkerPollInterval);
+	}
+
+	process_.read(4);
+	message = process_.read(message_length_);
+
+	return true;
+}
+
+bool RemoteDecoder::message_available()
+{
+	if (process_.bytesAvailable() < 4)
+		return false;
+
+	const QByteArray header = process_.peek(4);
+	message_length_ = ((uint32_t)(uint8_t)header[0] << 24) |
+		((uint32_t)(uint8_t)header[1] << 16) |
+		((uint32_t)(uint8_t)header[2] << 8) | (uint8_t)header[3];
+
+	return (process_.bytesAvailable() >= 4 + (qint64)message_length_);
+}
+
+bool RemoteDecoder::check_worker()
+{
+	if (interrupt_) {
+		error_.clear();
+		return false;
+	}
+
+	if (process_.state() != QProcess::Running) {
+		error_ = "Decoder process terminated unexpectedly";
+		return false;
+	}
+
+	return true;
+}
+
+bool RemoteDecoder::handle_next_message(uint8_t& type)
+{
+	QByteArray message;
+	if (!read_message(message))
+		return false;
+
+	QDataStream stream(message);
+	quint8 message_type;
+	stream >> message_type;
+	type = message_type;
+
+	switch (type) {
+	case RemoteConsumed:
+	{
+		quint32 slot;
+		qint64 end_sample;
+		stream >> slot >> end_sample;
+
+		free_slots_.push_back(slot);
+		consumed_end_sample_ = end_sample;
+		break;
+	}
+	case RemoteEndOfSegmentDone:
+		break;
+	case RemoteAnnotation:
+		handle_annotation(stream);
+		break;
+	case RemoteBinary:
+		handle_binary(stream);
+		break;
+	case RemoteError:
+	{
+		QByteArray text;
+		stream >> text;
+		error_ = QString::fromUtf8(text);
+		return false;
+	}
+	default:
+		error_ = "Unknown message received from decoder process";
+		return false;
+	}
+
+	return true;
+}
+
+void RemoteDecoder::handle_annotation(QDataStream& stream)
+{
+	quint32 index, text_count;
+	quint64 start_sample, end_sample;
+	qint32 ann_class;
+	stream >> index >> start_sample >> end_sample >> ann_class >> text_count;
+
+	vector<QByteArray> texts;
+	for (quint32 i = 0; (i < text_count) && (stream.status() == QDataStream::Ok); i++) {
+		texts.emplace_back();
+		stream >> texts.back();
+	}
+
+	if ((stream.status() != QDataStream::Ok) || (index >= outputs_.size()) ||
+		!annotation_cb_)
+		return;
+
+	// The texts must be a null-terminated array like the one of libsigrokdecode
+	vector<char*> text_ptrs;
+	for (QByteArray& text : texts)
+		text_ptrs.push_back(text.data());
+	text_ptrs.push_back(nullptr);
+
+	srd_proto_data_annotation pda;
+	memset(&pda, 0, sizeof(pda));
+	pda.ann_class = ann_class;
+	pda.ann_text = (decltype(pda.ann_text))text_ptrs.data();
+
+	srd_proto_data pdata;
+	memset(&pdata, 0, sizeof(pdata));
+	pdata.start_sample = start_sample;
+	pdata.end_sample = end_sample;
+	pdata.pdo = &outputs_[index];
+	pdata.data = &pda;
+
+	annotation_cb_(&pdata, cb_data_);
+}
+
+void RemoteDecoder::handle_binary(QDataStream& stream)
+{
+	quint32 index;
+	quint64 start_sample, end_sample;
+	qint32 bin_class;
+	QByteArray data;
+	stream >> index >> start_sample >> end_sample >> bin_class >> data;
+
+	if ((stream.status() != QDataStream::Ok) || (index >= outputs_.size()) ||
+		!binary_cb_)
+		return;
+
+	srd_proto_data_binary pdb;
+	memset(&pdb, 0, sizeof(pdb));
+	pdb.bin_class = bin_class;
+	pdb.size = data.size();
+	pdb.data = (decltype(pdb.data))data.constData();
+
+	srd_proto_data pdata;
+	memset(&pdata, 0, sizeof(pdata));
+	pdata.start_sample = start_sample;
+	pdata.end_sample = end_sample;
+	pdata.pdo = &outputs_[index];
+	pdata.data = &pdb;
+
+	binary_cb_(&pdata, cb_data_);
+}
+
+} // namespace decode
+} // namespace data
+} // namespace pv
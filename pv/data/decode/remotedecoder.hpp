@@ -0,0 +1,171 @@
+/*
+ * This file is part of the PulseView project.
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PULSEVIEW_PV_DATA_DECODE_REMOTEDECODER_HPP
+#define PULSEVIEW_PV_DATA_DECODE_REMOTEDECODER_HPP
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include <QByteArray>
+#include <QDataStream>
+#include <QProcess>
+#include <QSharedMemory>
+#include <QString>
+
+#include <libsigrokdecode/libsigrokdecode.h>
+
+using std::atomic;
+using std::deque;
+using std::shared_ptr;
+using std::vector;
+
+namespace pv {
+namespace data {
+namespace decode {
+
+class Decoder;
+struct MuxChunk;
+
+/**
+ * Runs a decoder stack in a worker process instead of the libsigrokdecode
+ * session of this process, so that decoders don't compete for the Python
+ * interpreter lock and a crashing decoder can't take PulseView down.
+ *
+ * The worker is PulseView itself, started with DECODE_WORKER_OPTION. The
+ * sample data is passed through a shared memory segment which is split
+ * into slots while everything else is exchanged through the standard
+ * input and output of the worker, see remoteprotocol.hpp.
+ *
+ * The output of the decoders is passed to the callbacks in the same form
+ * libsigrokdecode uses, so they can handle both kinds of decoding alike.
+ * The callbacks are called from the thread that uses the RemoteDecoder.
+ *
+ * A RemoteDecoder must only be used by the thread that created it.
+ */
+class RemoteDecoder
+{
+public:
+	static const unsigned int SlotCount;
+
+public:
+	/**
+	 * @param stack The decoder stack to run. Its configuration is copied
+	 *        when the worker is started.
+	 * @param interrupt Flag that makes all waiting functions return false
+	 *        when set.
+	 */
+	RemoteDecoder(const vector< shared_ptr<Decoder> >& stack,
+		const atomic<bool>& interrupt);
+	~RemoteDecoder();
+
+	void set_callbacks(srd_pd_output_callback annotation_cb,
+		srd_pd_output_callback binary_cb, void* cb_data);
+
+	/**
+	 * Launches the worker process and sets up the decoder stack in it.
+	 *
+	 * @param slot_size The size of one shared memory slot in bytes. Larger
+	 *        chunks of samples are split up by send().
+	 */
+	bool start(uint64_t samplerate, uint32_t slot_size);
+
+	/**
+	 * Passes the samples of the chunk on to the worker. Blocks until a
+	 * shared memory slot is free, handling the output of the worker while
+	 * waiting.
+	 */
+	bool send(const MuxChunk* chunk);
+
+	/**
+	 * Tells the decoders about the end of the input data and waits until
+	 * they've processed all samples that were sent.
+	 */
+	bool end_segment();
+
+	/**
+	 * Resets the state of the decoders for the next segment.
+	 */
+	bool reset(uint64_t samplerate);
+
+	/**
+	 * Returns the end sample of the last chunk the decoders have processed.
+	 */
+	int64_t consumed_end_sample() const;
+
+	/**
+	 * Returns the reason why the last call failed or an empty string if it
+	 * was interrupted.
+	 */
+	const QString& error() const;
+
+private:
+	bool write_message(const QByteArray& message);
+	bool read_message(QByteArray& message);
+
+	/**
+	 * Tells whether a complete message from the worker has been received.
+	 */
+	bool message_available();
+
+	/**
+	 * Returns false if waiting for the worker should be given up.
+	 */
+	bool check_worker();
+
+	/**
+	 * Reads and handles the next message from the worker.
+	 *
+	 * @param type Receives the type of the message.
+	 */
+	bool handle_next_message(uint8_t& type);
+
+	void handle_annotation(QDataStream& stream);
+	void handle_binary(QDataStream& stream);
+
+private:
+	const vector< shared_ptr<Decoder> > stack_;
+	const atomic<bool>& interrupt_;
+
+	QProcess process_;
+	QSharedMemory shm_;
+	uint32_t slot_size_;
+	deque<uint32_t> free_slots_;
+	uint32_t message_length_;  ///< Length of the message found by message_available()
+
+	int64_t consumed_end_sample_;
+
+	/// Stand-ins for the instances in the worker, so that the callbacks can
+	/// tell which decoder the output belongs to
+	vector<srd_decoder_inst> instances_;
+	vector<srd_pd_output> outputs_;
+
+	srd_pd_output_callback annotation_cb_, binary_cb_;
+	void* cb_data_;
+
+	QString error_;
+};
+
+} // namespace decode
+} // namespace data
+} // namespace pv
+
+#endif // PULSEVIEW_PV_DATA_DECODE_REMOTEDECODER_HPP
@@ -0,0 +1,75 @@
+/*
+ * This file is part of the PulseView project.
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PULSEVIEW_PV_DATA_DECODE_REMOTEPROTOCOL_HPP
+#define PULSEVIEW_PV_DATA_DECODE_REMOTEPROTOCOL_HPP
+
+#include <cstdint>
+
+namespace pv {
+namespace data {
+namespace decode {
+
+/**
+ * Messages exchanged between RemoteDecoder and the decode worker process.
+ *
+ * Every message is a QDataStream-encoded byte array preceded by its length
+ * as a 32-bit big-endian number. The first byte of the array tells the
+ * message type. The sample data itself isn't part of the messages, it's
+ * passed through a shared memory segment that is split into slots.
+ */
+enum RemoteMessage : uint8_t {
+	// RemoteDecoder to worker
+
+	/// quint64 samplerate, quint32 slot size, quint32 decoder count, then per
+	/// decoder: QByteArray id, quint32 option count, per option QByteArray key
+	/// and QByteArray GVariant text, quint32 channel count, per channel
+	/// QByteArray channel id and qint32 bit index, QByteArray initial pins
+	RemoteSetup = 1,
+	/// quint32 slot, qint64 start sample, qint64 end sample, quint32 unit size
+	RemoteData,
+	/// No payload
+	RemoteEndOfSegment,
+	/// quint64 samplerate of the next segment
+	RemoteReset,
+
+	// Worker to RemoteDecoder
+
+	/// quint32 slot, qint64 end sample
+	RemoteConsumed = 64,
+	/// No payload
+	RemoteEndOfSegmentDone,
+	/// quint32 decoder index, quint64 start sample, quint64 end sample,
+	/// qint32 annotation class, quint32 text count, QByteArray per text
+	RemoteAnnotation,
+	/// quint32 decoder index, quint64 start sample, quint64 end sample,
+	/// qint32 binary class, QByteArray data
+	RemoteBinary,
+	/// QByteArray UTF-8 message
+	RemoteError
+};
+
+/// Command line option that makes PulseView act as a decode worker
+#define DECODE_WORKER_OPTION "--decode-worker"
+
+} // namespace decode
+} // namespace data
+} // namespace pv
+
+#endif // PULSEVIEW_PV_DATA_DECODE_REMOTEPROTOCOL_HPP
@@ -17,23 +17,55 @@
  * along with this program; if not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <cassert>
 
+#include <pv/data/decode/annotationspill.hpp>
 #include <pv/data/decode/decoder.hpp>
 #include <pv/data/decode/row.hpp>
 #include <pv/data/decode/rowdata.hpp>
+#include <pv/data/decode/textpool.hpp>
 
+using std::inplace_merge;
+using std::max;
+using std::min;
+using std::move;
+using std::shared_ptr;
+using std::stable_sort;
+using std::upper_bound;
 using std::vector;
 
 namespace pv {
 namespace data {
 namespace decode {
 
-RowData::RowData(Row* row) :
+const uint32_t RowData::BlockSize;
+const uint32_t RowData::IndexFanOut;
+const unsigned int RowData::IndexFanOutBits;
+const uint32_t RowData::ResidentBlockCount;
+const uint32_t RowData::InitialDirectorySize;
+
+RowData::Block::Block() :
+	data(nullptr),
+	start_sample(0)
+{
+}
+
+RowData::RowData(Row* row, TextPool* text_pool, AnnotationSpill* spill) :
+	directory_(nullptr),
+	directory_size_(0),
+	annotation_count_(0),
+	max_sample_(0),
 	row_(row),
-	prev_ann_start_sample_(0)
+	text_pool_(text_pool),
+	spill_(spill),
+	spilled_block_count_(0),
+	prev_ann_start_sample_(0),
+	in_order_(true),
+	indexed_count_(0)
 {
 	assert(row);
+	assert(text_pool);
 }
 
 const Row* RowData::row() const
@@ -43,18 +75,16 @@ const Row* RowData::row() const
 
 uint64_t RowData::get_max_sample() const
 {
-	if (annotations_.empty())
-		return 0;
-	return annotations_.back().end_sample();
+	return max_sample_;
 }
 
 uint64_t RowData::get_annotation_count() const
 {
-	return annotations_.size();
+	return annotation_count_;
 }
 
 void RowData::get_annotation_subset(
-	deque<const pv::data::decode::Annotation*> &dest,
+	deque<pv::data::decode::Annotation> &dest,
 	uint64_t start_sample, uint64_t end_sample) const
 {
 	// Determine whether we must apply per-class filtering or not
@@ -71,87 +101,320 @@ void RowData::get_annotation_subset(
 			max_ann_class_id = c->id;
 	}
 
-	if (all_ann_classes_enabled) {
-		// No filtering, send everyting out as-is
-		for (const auto& annotation : annotations_)
-			if ((annotation.end_sample() > start_sample) &&
-				(annotation.start_sample() <= end_sample))
-				dest.push_back(&annotation);
-	} else {
-		if (!all_ann_classes_disabled) {
-			// Filter out invisible annotation classes
-			vector<size_t> class_visible;
-			class_visible.resize(max_ann_class_id + 1, 0);
-			for (AnnotationClass* c : row_->ann_classes())
-				if (c->visible())
-					class_visible[c->id] = 1;
-
-			for (const auto& annotation : annotations_)
-				if ((class_visible[annotation.ann_class_id()]) &&
-					(annotation.end_sample() > start_sample) &&
-					(annotation.start_sample() <= end_sample))
-					dest.push_back(&annotation);
+	if (!all_ann_classes_enabled && all_ann_classes_disabled)
+		return;
+
+	if (annotation_count_ == 0)
+		return;
+
+	update_index();
+
+	// Filter out invisible annotation classes if needed
+	vector<size_t> class_visible;
+	if (!all_ann_classes_enabled) {
+		class_visible.resize(max_ann_class_id + 1, 0);
+		for (AnnotationClass* c : row_->ann_classes())
+			if (c->visible())
+				class_visible[c->id] = 1;
+	}
+
+	// Annotations are sorted by start sample, so only the ones before the
+	// first annotation starting after the range can overlap it
+	uint32_t lower = 0, upper = annotation_count_;
+
+	if (in_order_) {
+		// The block summaries tell which block that annotation is in, so
+		// only that block needs to be looked at
+		size_t first = 0, last = blocks_.size();
+		while (first < last) {
+			const size_t middle = first + (last - first) / 2;
+			if (blocks_[middle]->start_sample <= end_sample)
+				first = middle + 1;
+			else
+				last = middle;
 		}
+
+		if (first == 0)
+			return;
+
+		lower = (first - 1) * BlockSize;
+		upper = min((uint32_t)(first * BlockSize), annotation_count_);
 	}
+
+	while (lower < upper) {
+		const uint32_t middle = lower + (upper - lower) / 2;
+		if (annotation_start_sample(sorted_index(middle)) <= end_sample)
+			lower = middle + 1;
+		else
+			upper = middle;
+	}
+
+	const size_t top_level = index_levels_.size() - 1;
+	for (uint32_t node = 0; node < index_levels_[top_level].size(); node++)
+		if (index_levels_[top_level][node] > start_sample)
+			collect_annotations(dest, top_level, node, lower, start_sample,
+				class_visible);
 }
 
-const deque<Annotation>& RowData::annotations() const
+Annotation RowData::emplace_annotation(srd_proto_data *pdata)
 {
-	return annotations_;
+	const srd_proto_data_annotation *const pda = (const srd_proto_data_annotation*)pdata->data;
+
+	const uint32_t index = annotation_count_;
+	const uint32_t offset = index % BlockSize;
+
+	if (offset == 0) {
+		spill_block();
+		add_block(pdata->start_sample);
+	}
+
+	Block& block = *blocks_.back();
+	AnnotationBlock& data = *block.buffer;
+	data.start_samples[offset] = pdata->start_sample;
+	data.end_samples[offset] = pdata->end_sample;
+	data.class_ids[offset] = pda->ann_class;
+	data.text_ids[offset] = text_pool_->intern((char**)pda->ann_text);
+
+	block.start_sample = min(block.start_sample, (uint64_t)pdata->start_sample);
+	if (pda->ann_class >= (int)block.class_counts.size())
+		block.class_counts.resize(pda->ann_class + 1, 0);
+	block.class_counts[pda->ann_class]++;
+
+	// Annotations are always appended. If one arrives out of order, the
+	// sorted order is kept separately from now on
+	if (pdata->start_sample < prev_ann_start_sample_) {
+		if (in_order_) {
+			sort_order_.resize(index);
+			for (uint32_t i = 0; i < index; i++)
+				sort_order_[i] = i;
+			in_order_ = false;
+		}
+	} else
+		prev_ann_start_sample_ = pdata->start_sample;
+
+	max_sample_ = max(max_sample_, (uint64_t)pdata->end_sample);
+	annotation_count_++;
+
+	return Annotation(this, index);
 }
 
-const Annotation* RowData::emplace_annotation(srd_proto_data *pdata)
+uint64_t RowData::annotation_start_sample(uint32_t index) const
 {
-	const srd_proto_data_annotation *const pda = (const srd_proto_data_annotation*)pdata->data;
+	AnnotationSpill::Reader reader(spill_);
+	return block(index)->start_samples[index % BlockSize];
+}
+
+uint64_t RowData::annotation_end_sample(uint32_t index) const
+{
+	AnnotationSpill::Reader reader(spill_);
+	return block(index)->end_samples[index % BlockSize];
+}
+
+uint32_t RowData::annotation_class_id(uint32_t index) const
+{
+	AnnotationSpill::Reader reader(spill_);
+	return block(index)->class_ids[index % BlockSize];
+}
+
+uint32_t RowData::annotation_text_id(uint32_t index) const
+{
+	AnnotationSpill::Reader reader(spill_);
+	return block(index)->text_ids[index % BlockSize];
+}
+
+const vector<QString>* RowData::annotation_texts(uint32_t index) const
+{
+	return text_pool_->texts(annotation_text_id(index));
+}
+
+const RowData::AnnotationBlock* RowData::block(uint32_t index) const
+{
+	return directory_.load()[index / BlockSize]->data;
+}
+
+void RowData::add_block(uint64_t start_sample)
+{
+	blocks_.emplace_back(new Block);
+	Block* const block = blocks_.back().get();
+	block->buffer.reset(new AnnotationBlock);
+	block->data = block->buffer.get();
+	block->start_sample = start_sample;
+
+	if (blocks_.size() > directory_size_) {
+		const uint32_t size = max(2 * directory_size_, InitialDirectorySize);
+		Block** const directory = new Block*[size];
+
+		for (size_t i = 0; i < blocks_.size() - 1; i++)
+			directory[i] = blocks_[i].get();
 
-	uint32_t ann_class_id = pda->ann_class;
+		directories_.emplace_back(directory);
+		directory_size_ = size;
+	}
+
+	// The directory only ever gets new entries, readers never see them
+	// before the annotations in the block are handed out
+	directories_.back()[blocks_.size() - 1] = block;
+	directory_ = directories_.back().get();
+}
+
+void RowData::spill_block()
+{
+	if (!spill_ || (blocks_.size() - spilled_block_count_ <= ResidentBlockCount))
+		return;
+
+	Block& block = *blocks_[spilled_block_count_];
+
+	const void* const copy = spill_->store(block.buffer.get(), sizeof(AnnotationBlock));
+	if (!copy)
+		return;
+
+	// Readers may still be using the buffer, so the spill keeps it around
+	// until they're done with it
+	block.data = (const AnnotationBlock*)copy;
+	spill_->retire(shared_ptr<const void>(move(block.buffer)));
+
+	spilled_block_count_++;
+}
+
+void RowData::update_sort_order() const
+{
+	if (in_order_ || (sort_order_.size() == annotation_count_))
+		return;
+
+	// Sort the annotations added since the last update, then merge them
+	// into the part that is sorted already. Both steps are stable, so
+	// annotations with the same start sample keep their order of arrival
+	const size_t sorted_count = sort_order_.size();
+	for (uint32_t i = sorted_count; i < annotation_count_; i++)
+		sort_order_.push_back(i);
+
+	auto by_start_sample = [this](uint32_t a, uint32_t b) {
+		return annotation_start_sample(a) < annotation_start_sample(b); };
+
+	const auto middle = sort_order_.begin() + sorted_count;
+	stable_sort(middle, sort_order_.end(), by_start_sample);
+
+	// Everything before the place the first new annotation goes to stays
+	// where it is, so the index only needs to be updated from there on
+	const uint32_t first_moved = upper_bound(sort_order_.begin(), middle,
+		*middle, by_start_sample) - sort_order_.begin();
+	indexed_count_ = min(indexed_count_, first_moved);
+
+	inplace_merge(sort_order_.begin(), middle, sort_order_.end(), by_start_sample);
+}
+
+uint32_t RowData::sorted_index(uint32_t n) const
+{
+	return in_order_ ? n : sort_order_[n];
+}
+
+void RowData::update_index() const
+{
+	update_sort_order();
+
+	if (indexed_count_ == annotation_count_)
+		return;
+
+	// Update the nodes of the lowest level that cover the new annotations
+	if (index_levels_.empty())
+		index_levels_.emplace_back();
 
-	// Look up the longest annotation text to see if we have it in storage.
-	// This implies that if the longest text is the same, the shorter texts
-	// are expected to be the same, too. PDs that violate this assumption
-	// should be considered broken.
-	const char* const* ann_texts = (char**)pda->ann_text;
-	const QString ann0 = QString::fromUtf8(ann_texts[0]);
-	vector<QString>* storage_entry = &(ann_texts_[ann0]);
+	uint32_t first_node = indexed_count_ / IndexFanOut;
 
-	if (storage_entry->empty()) {
-		while (*ann_texts) {
-			storage_entry->emplace_back(QString::fromUtf8(*ann_texts));
-			ann_texts++;
+	vector<uint64_t>& level0 = index_levels_[0];
+	level0.resize((annotation_count_ + IndexFanOut - 1) / IndexFanOut);
+
+	for (uint32_t node = first_node; node < level0.size(); node++) {
+		const uint32_t end_pos = min((node + 1) * IndexFanOut, annotation_count_);
+
+		uint64_t max_end_sample = 0;
+		for (uint32_t n = node * IndexFanOut; n < end_pos; n++)
+			max_end_sample = max(max_end_sample, annotation_end_sample(sorted_index(n)));
+
+		level0[node] = max_end_sample;
+	}
+
+	// Then propagate the changes upwards until a level has only one node
+	size_t level = 1;
+	for (; index_levels_[level - 1].size() > 1; level++) {
+		if (index_levels_.size() == level)
+			index_levels_.emplace_back();
+
+		const vector<uint64_t>& below = index_levels_[level - 1];
+		vector<uint64_t>& current = index_levels_[level];
+		current.resize((below.size() + IndexFanOut - 1) / IndexFanOut);
+
+		first_node /= IndexFanOut;
+		for (uint32_t node = first_node; node < current.size(); node++) {
+			const size_t end_child = min((size_t)(node + 1) * IndexFanOut, below.size());
+
+			uint64_t max_end_sample = 0;
+			for (size_t child = node * IndexFanOut; child < end_child; child++)
+				max_end_sample = max(max_end_sample, below[child]);
+
+			current[node] = max_end_sample;
 		}
-		storage_entry->shrink_to_fit();
 	}
+	index_levels_.resize(level);
 
+	indexed_count_ = annotation_count_;
+}
 
-	const Annotation* result = nullptr;
+void RowData::collect_annotations(deque<pv::data::decode::Annotation> &dest,
+	size_t level, uint32_t node, uint32_t end_pos, uint64_t start_sample,
+	const vector<size_t>& class_visible) const
+{
+	const uint64_t first_child = (uint64_t)node * IndexFanOut;
 
-	// We insert the annotation in a way so that the annotation list
-	// is sorted by start sample. Otherwise, we'd have to sort when
-	// painting, which is expensive
+	if (level == 0) {
+		// Skip blocks without visible annotations using the class counts.
+		// A node lies within a single block as BlockSize is a multiple of
+		// IndexFanOut
+		if (in_order_ && !class_visible.empty()) {
+			const vector<uint32_t>& class_counts =
+				blocks_[first_child / BlockSize]->class_counts;
 
-	if (pdata->start_sample < prev_ann_start_sample_) {
-		// Find location to insert the annotation at
-
-		auto it = annotations_.end();
-		do {
-			it--;
-		} while ((it->start_sample() > pdata->start_sample) && (it != annotations_.begin()));
-
-		// Allow inserting at the front
-		if (it != annotations_.begin())
-			it++;
-
-		it = annotations_.emplace(it, pdata->start_sample, pdata->end_sample,
-			storage_entry, ann_class_id, this);
-		result = &(*it);
-	} else {
-		annotations_.emplace_back(pdata->start_sample, pdata->end_sample,
-			storage_entry, ann_class_id, this);
-		result = &(annotations_.back());
-		prev_ann_start_sample_ = pdata->start_sample;
+			bool has_visible = false;
+			for (size_t id = 0; id < class_counts.size(); id++)
+				if (class_counts[id] && (id < class_visible.size()) && class_visible[id])
+					has_visible = true;
+
+			if (!has_visible)
+				return;
+		}
+
+		const uint32_t last = min(first_child + IndexFanOut, (uint64_t)end_pos);
+
+		for (uint32_t n = first_child; n < last; n++) {
+			const uint32_t index = sorted_index(n);
+
+			if (annotation_end_sample(index) <= start_sample)
+				continue;
+
+			if (!class_visible.empty()) {
+				const uint32_t class_id = annotation_class_id(index);
+				if ((class_id >= class_visible.size()) || !class_visible[class_id])
+					continue;
+			}
+
+			dest.emplace_back(this, index);
+		}
+		return;
 	}
 
-	return result;
+	// Each child covers IndexFanOut^level annotations
+	const unsigned int child_shift = IndexFanOutBits * level;
+	const vector<uint64_t>& below = index_levels_[level - 1];
+	const uint64_t last_child = min(first_child + IndexFanOut, (uint64_t)below.size());
+
+	for (uint64_t child = first_child; child < last_child; child++) {
+		if ((child << child_shift) >= end_pos)
+			break;
+
+		if (below[child] > start_sample)
+			collect_annotations(dest, level - 1, child, end_pos, start_sample,
+				class_visible);
+	}
 }
 
 }  // namespace decode
@@ -20,40 +20,87 @@
 #ifndef PULSEVIEW_PV_DATA_DECODE_ROWDATA_HPP
 #define PULSEVIEW_PV_DATA_DECODE_ROWDATA_HPP
 
-#include <unordered_map>
+#include <atomic>
+#include <deque>
+#include <memory>
 #include <vector>
 
-#include <QtGlobal>
-#include <QHash>
 #include <QString>
 
 #include <libsigrokdecode/libsigrokdecode.h>
 
 #include <pv/data/decode/annotation.hpp>
 
+using std::atomic;
 using std::deque;
-using std::unordered_map;
-
-#if QT_VERSION < QT_VERSION_CHECK(5, 14, 0)
-namespace std {
-	template<> struct hash<QString> {
-		std::size_t operator()(const QString& s) const noexcept {
-			return (size_t) qHash(s);
-		}
-	};
-}
-#endif
+using std::unique_ptr;
 
 namespace pv {
 namespace data {
 namespace decode {
 
+class AnnotationSpill;
 class Row;
+class TextPool;
 
+/**
+ * Holds the annotations a decoder emitted for one row in one segment.
+ *
+ * The annotations are stored column by column in blocks of fixed size that
+ * are only ever appended to, so an annotation is identified by its index
+ * and never moves. Annotations usually arrive ordered by start sample. For
+ * the few decoders that emit them out of order, a permutation holding the
+ * sorted order is maintained lazily whenever the annotations are queried.
+ * The texts only exist once in a TextPool shared with other rows.
+ *
+ * To find the annotations overlapping a sample range without looking at all
+ * of them, the annotations in sorted order are grouped into nodes of
+ * IndexFanOut annotations and the maximum end sample of each node is kept.
+ * These nodes are grouped the same way again, forming a pyramid that lets
+ * queries skip all groups ending before the range.
+ *
+ * The accessors for single annotations may be called while annotations are
+ * added concurrently, as long as the annotation itself was added before.
+ * This is what lets the views use Annotation handles after the decode
+ * signal released its lock: blocks are allocated once and never move, and
+ * the directory they're looked up in is only replaced by larger copies,
+ * keeping the previous ones for readers that may still use them.
+ *
+ * If an AnnotationSpill is given, all but the ResidentBlockCount most recent
+ * blocks are moved to it. For every block, the smallest start sample and the
+ * number of annotations per class are kept in memory, so that queries only
+ * touch the blocks holding annotations they return.
+ */
 class RowData
 {
 public:
-	RowData(Row* row);
+	static const uint32_t BlockSize = 1024;
+	static const uint32_t IndexFanOut = 64;
+	static const unsigned int IndexFanOutBits = 6;
+	static const uint32_t ResidentBlockCount = 16;
+	static const uint32_t InitialDirectorySize = 16;
+
+private:
+	struct AnnotationBlock
+	{
+		uint64_t start_samples[BlockSize];
+		uint64_t end_samples[BlockSize];
+		uint32_t class_ids[BlockSize];
+		uint32_t text_ids[BlockSize];
+	};
+
+	struct Block
+	{
+		Block();
+
+		atomic<const AnnotationBlock*> data;  ///< Either buffer or spilled
+		unique_ptr<AnnotationBlock> buffer;   ///< Unset once spilled
+		uint64_t start_sample;                ///< Smallest start sample
+		vector<uint32_t> class_counts;        ///< Annotations per class ID
+	};
+
+public:
+	RowData(Row* row, TextPool* text_pool, AnnotationSpill* spill = nullptr);
 
 	const Row* row() const;
 
@@ -62,22 +109,91 @@ public:
 	uint64_t get_annotation_count() const;
 
 	/**
-	 * Extracts annotations between the given sample range into a vector.
-	 * Note: The annotations are unsorted and only annotations that fully
-	 * fit into the sample range are considered.
+	 * Extracts the annotations overlapping the given sample range into a
+	 * vector, sorted by start sample.
 	 */
-	void get_annotation_subset(deque<const pv::data::decode::Annotation*> &dest,
+	void get_annotation_subset(deque<pv::data::decode::Annotation> &dest,
 		uint64_t start_sample, uint64_t end_sample) const;
 
-	const deque<Annotation>& annotations() const;
+	Annotation emplace_annotation(srd_proto_data *pdata);
+
+	uint64_t annotation_start_sample(uint32_t index) const;
+	uint64_t annotation_end_sample(uint32_t index) const;
+	uint32_t annotation_class_id(uint32_t index) const;
+	uint32_t annotation_text_id(uint32_t index) const;
+	const vector<QString>* annotation_texts(uint32_t index) const;
+
+private:
+	const AnnotationBlock* block(uint32_t index) const;
+
+	/**
+	 * Appends a new, empty block and enters it into the directory.
+	 */
+	void add_block(uint64_t start_sample);
+
+	/**
+	 * Moves the oldest block that is still held in memory to the spill
+	 * if there are more than ResidentBlockCount. All blocks must be full.
+	 */
+	void spill_block();
+
+	/**
+	 * Brings the sorted permutation up to date. Must only be called while
+	 * no annotations are added concurrently.
+	 */
+	void update_sort_order() const;
+
+	/**
+	 * Returns the index of the n-th annotation in the order of start samples.
+	 */
+	uint32_t sorted_index(uint32_t n) const;
+
+	/**
+	 * Brings the max end sample pyramid up to date, updating the sorted
+	 * permutation first if needed.
+	 */
+	void update_index() const;
 
-	const Annotation* emplace_annotation(srd_proto_data *pdata);
+	/**
+	 * Adds the annotations below the given pyramid node that end after
+	 * @c start_sample and have one of the visible classes to @c dest.
+	 * Only the first @c end_pos annotations in sorted order are considered.
+	 * @c class_visible may be empty if all classes are visible.
+	 */
+	void collect_annotations(deque<pv::data::decode::Annotation> &dest,
+		size_t level, uint32_t node, uint32_t end_pos, uint64_t start_sample,
+		const vector<size_t>& class_visible) const;
 
 private:
-	deque<Annotation> annotations_;
-	unordered_map<QString, vector<QString> > ann_texts_;  // unordered_map since pointers must not change
+	vector< unique_ptr<Block> > blocks_;
+
+	/// Pointers to the blocks for lookups without the owner's lock held.
+	/// Each directory is a larger copy of the one before and none of them
+	/// is freed before the RowData is, as readers may still be using it
+	vector< unique_ptr<Block*[]> > directories_;
+	atomic<Block* const*> directory_;
+	uint32_t directory_size_;
+	uint32_t annotation_count_;
+	uint64_t max_sample_;
+
 	Row* row_;
+	TextPool* text_pool_;
+	AnnotationSpill* spill_;
+	uint32_t spilled_block_count_;
 	uint64_t prev_ann_start_sample_;
+
+	/// True as long as all annotations were added in order of start sample
+	bool in_order_;
+
+	/// Indices of the annotations sorted by start sample, covers all
+	/// annotations once update_sort_order() ran. Unused while in_order_ holds
+	mutable vector<uint32_t> sort_order_;
+
+	/// Maximum end sample of each pyramid node, level 0 being the lowest
+	mutable vector< vector<uint64_t> > index_levels_;
+
+	/// Number of annotations in sorted order that the pyramid accounts for
+	mutable uint32_t indexed_count_;
 };
 
 }  // namespace decode
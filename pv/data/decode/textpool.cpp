@@ -0,0 +1,146 @@
+/*
+ * This file is part of the PulseView project.
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+
+#include "textpool.hpp"
+
+using std::lock_guard;
+
+namespace pv {
+namespace data {
+namespace decode {
+
+TextPool::TextPool()
+{
+}
+
+uint32_t TextPool::intern(const char* const* texts)
+{
+	// FNV-1a over all texts including their terminating NULs
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	uint32_t length = 0;
+
+	for (const char* const* text = texts; *text; text++) {
+		const char* c = *text;
+		do {
+			hash = (hash ^ (uint8_t)*c) * 0x100000001b3ULL;
+			length++;
+		} while (*c++);
+	}
+
+	lock_guard<mutex> lock(mutex_);
+
+	const auto range = ids_by_hash_.equal_range(hash);
+	for (auto it = range.first; it != range.second; it++) {
+		const Entry& entry = entries_[it->second];
+		if ((entry.length == length) && matches(entry, texts))
+			return it->second;
+	}
+
+	const uint32_t id = entries_.size();
+	entries_.push_back({arena_.size(), length});
+
+	for (const char* const* text = texts; *text; text++)
+		arena_.insert(arena_.end(), *text, *text + strlen(*text) + 1);
+
+	ids_by_hash_.emplace(hash, id);
+
+	return id;
+}
+
+const vector<QString>* TextPool::texts(uint32_t id) const
+{
+	lock_guard<mutex> lock(mutex_);
+
+	if (strings_.size() <= id)
+		strings_.resize(id + 1);
+
+	vector<QString>& strings = strings_[id];
+
+	if (strings.empty()) {
+		const Entry& entry = entries_.at(id);
+		const char* c = arena_.data() + entry.offset;
+		const char* const end = c + entry.length;
+
+		while (c < end) {
+			const size_t length = strlen(c);
+			strings.emplace_back(QString::fromUtf8(c, length));
+			c += length + 1;
+		}
+		strings.shrink_to_fit();
+	}
+
+	return &strings;
+}
+
+QByteArray TextPool::raw_texts(uint32_t id) const
+{
+	lock_guard<mutex> lock(mutex_);
+
+	const Entry& entry = entries_.at(id);
+
+	return QByteArray(arena_.data() + entry.offset, entry.length);
+}
+
+uint32_t TextPool::count() const
+{
+	lock_guard<mutex> lock(mutex_);
+
+	return entries_.size();
+}
+
+uint64_t TextPool::size() const
+{
+	lock_guard<mutex> lock(mutex_);
+
+	return arena_.size();
+}
+
+void TextPool::clear()
+{
+	lock_guard<mutex> lock(mutex_);
+
+	arena_.clear();
+	arena_.shrink_to_fit();
+	entries_.clear();
+	entries_.shrink_to_fit();
+	ids_by_hash_.clear();
+	strings_.clear();
+}
+
+bool TextPool::matches(const Entry& entry, const char* const* texts) const
+{
+	// The total lengths are the same, so the comparisons can't go past
+	// the end of the entry
+	const char* c = arena_.data() + entry.offset;
+
+	for (const char* const* text = texts; *text; text++) {
+		const size_t length = strlen(*text) + 1;
+		if (memcmp(c, *text, length) != 0)
+			return false;
+		c += length;
+	}
+
+	return true;
+}
+
+} // namespace decode
+} // namespace data
+} // namespace pv
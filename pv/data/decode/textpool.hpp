@@ -0,0 +1,108 @@
+/*
+ * This file is part of the PulseView project.
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PULSEVIEW_PV_DATA_DECODE_TEXTPOOL_HPP
+#define PULSEVIEW_PV_DATA_DECODE_TEXTPOOL_HPP
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <QByteArray>
+#include <QString>
+
+using std::deque;
+using std::mutex;
+using std::unordered_multimap;
+using std::vector;
+
+namespace pv {
+namespace data {
+namespace decode {
+
+/**
+ * Stores the texts of annotations, each distinct set of texts only once.
+ *
+ * Decoders emit the same texts over and over again, so they're kept as raw
+ * UTF-8 in an arena and looked up by a hash of their bytes. Annotations only
+ * refer to them by a compact ID. The QStrings needed for painting and export
+ * are created the first time a set of texts is asked for.
+ *
+ * All methods may be called from any thread.
+ */
+class TextPool
+{
+public:
+	TextPool();
+
+	/**
+	 * Returns the ID of the given NULL-terminated list of UTF-8 strings,
+	 * adding them to the pool if they aren't there yet.
+	 */
+	uint32_t intern(const char* const* texts);
+
+	/**
+	 * Returns the texts with the given ID. The pointer remains valid until
+	 * the pool is cleared.
+	 */
+	const vector<QString>* texts(uint32_t id) const;
+
+	/**
+	 * Returns the texts with the given ID as consecutive NUL-terminated
+	 * UTF-8 strings.
+	 */
+	QByteArray raw_texts(uint32_t id) const;
+
+	uint32_t count() const;
+
+	/**
+	 * Returns the number of bytes that the UTF-8 texts occupy.
+	 */
+	uint64_t size() const;
+
+	void clear();
+
+private:
+	struct Entry
+	{
+		uint64_t offset;  ///< Position of the first text in the arena
+		uint32_t length;  ///< Length of all texts incl. their terminating NULs
+	};
+
+	bool matches(const Entry& entry, const char* const* texts) const;
+
+private:
+	mutable mutex mutex_;
+
+	/// The texts of all entries, each text followed by a NUL
+	vector<char> arena_;
+	vector<Entry> entries_;
+	unordered_multimap<uint64_t, uint32_t> ids_by_hash_;
+
+	/// Materialized texts by ID, empty if not created yet
+	mutable deque< vector<QString> > strings_;
+};
+
+} // namespace decode
+} // namespace data
+} // namespace pv
+
+#endif // PULSEVIEW_PV_DATA_DECODE_TEXTPOOL_HPP
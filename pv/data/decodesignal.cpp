@@ -19,11 +19,17 @@
 
 #include "config.h"
 
+#include <algorithm>
 #include <cstring>
 #include <forward_list>
 #include <limits>
+#include <tuple>
+#include <unordered_map>
 
+#include <QCryptographicHash>
 #include <QDebug>
+#include <QGuiApplication>
+#include <QScreen>
 #if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
 #include <QRegularExpression>
 #endif
@@ -33,20 +39,37 @@
 #include "decodesignal.hpp"
 #include "signaldata.hpp"
 
+#include <pv/data/decode/decodecache.hpp>
 #include <pv/data/decode/decoder.hpp>
+#include <pv/data/decode/decoderindex.hpp>
+#include <pv/data/decode/logicmux.hpp>
+#include <pv/data/decode/remotedecoder.hpp>
 #include <pv/data/decode/row.hpp>
 #include <pv/globalsettings.hpp>
 #include <pv/session.hpp>
 
 using std::dynamic_pointer_cast;
+using std::find;
+using std::forward_as_tuple;
+using std::inplace_merge;
 using std::lock_guard;
+using std::make_pair;
 using std::make_shared;
+using std::max;
 using std::min;
+using std::numeric_limits;
 using std::out_of_range;
+using std::pair;
+using std::piecewise_construct;
 using std::shared_ptr;
+using std::sort;
+using std::stable_sort;
+using std::unordered_map;
 using std::unique_lock;
+using std::upper_bound;
 using pv::data::decode::AnnotationClass;
 using pv::data::decode::DecodeChannel;
+using pv::data::decode::DecoderIndex;
 
 namespace pv {
 namespace data {
@@ -54,18 +77,46 @@ namespace data {
 const double DecodeSignal::DecodeMargin = 1.0;
 const double DecodeSignal::DecodeThreshold = 0.2;
 const int64_t DecodeSignal::DecodeChunkLength = 256 * 1024;
+const unsigned int DecodeSignal::LogicMuxQueueLength = 4;
+const unsigned int DecodeSignal::MaxDecodeWorkerCount = 8;
+const unsigned int DecodeSignal::InProcessDecodeWorkerCount = 2;
+const int64_t DecodeSignal::SplitMinRangeLength = 1024 * 1024;
+const int64_t DecodeSignal::SplitScanBlockLength = 1024 * 1024;
+const int64_t DecodeSignal::SplitIdleFactor = 64;
+const uint64_t DecodeSignal::DecodeCacheMaxSize = 1024ULL * 1024 * 1024;
+const int64_t DecodeSignal::DecodeRangeMargin = 1024 * 1024;
+const int DecodeSignal::MaxNotificationRate = 60; // No more than 60 Hz
 
 
 DecodeSignal::DecodeSignal(pv::Session &session) :
 	SignalBase(nullptr, SignalBase::DecodeChannel),
 	session_(session),
 	srd_session_(nullptr),
-	logic_mux_data_invalid_(false),
+	logic_mux_bypassed_(false),
+	logic_mux_queue_(LogicMuxQueueLength),
 	stack_config_changed_(true),
-	current_segment_id_(0)
+	decode_out_of_process_(false),
+	decode_split_segments_(false),
+	decode_cache_enabled_(false),
+	decode_spill_annotations_(false),
+	decode_range_set_(false),
+	decode_ranged_(false),
+	decode_range_start_(0),
+	decode_range_end_(0),
+	current_segment_id_(0),
+	next_input_segment_(0),
+	decoded_segment_count_(0),
+	decode_thread_budget_(0),
+	notification_pending_(false)
 {
+	main_callback_context_ = {this, 0, nullptr, {}};
+
 	connect(&session_, SIGNAL(capture_state_changed(int)),
 		this, SLOT(on_capture_state_changed(int)));
+
+	connect(&notification_timer_, SIGNAL(timeout()),
+		this, SLOT(on_notification_timeout()));
+	notification_timer_.setSingleShot(true);
 }
 
 DecodeSignal::~DecodeSignal()
@@ -172,28 +223,23 @@ void DecodeSignal::reset_decode(bool shutting_down)
 	else
 		terminate_srd_session();
 
-	if (decode_thread_.joinable()) {
-		decode_interrupt_ = true;
-		decode_input_cond_.notify_one();
-		decode_thread_.join();
-	}
+	stop_decode_threads();
 
-	if (logic_mux_thread_.joinable()) {
-		logic_mux_interrupt_ = true;
-		logic_mux_cond_.notify_one();
-		logic_mux_thread_.join();
-	}
+	// Drop the muxed data that hasn't been decoded yet
+	logic_mux_queue_.reset();
 
 	current_segment_id_ = 0;
+	next_input_segment_ = 0;
+	decoded_segment_count_ = 0;
+	decode_ranged_ = false;
 	segments_.clear();
+	annotation_texts_.clear();
+	profiler_.reset();
 
 	for (const shared_ptr<decode::Decoder>& dec : stack_)
 		if (dec->has_logic_output())
 			output_logic_[dec->get_srd_decoder()]->clear();
 
-	logic_mux_data_.reset();
-	logic_mux_data_invalid_ = true;
-
 	if (!error_message_.isEmpty()) {
 		error_message_.clear();
 		// TODO Emulate noquote()
@@ -205,17 +251,7 @@ void DecodeSignal::reset_decode(bool shutting_down)
 
 void DecodeSignal::begin_decode()
 {
-	if (decode_thread_.joinable()) {
-		decode_interrupt_ = true;
-		decode_input_cond_.notify_one();
-		decode_thread_.join();
-	}
-
-	if (logic_mux_thread_.joinable()) {
-		logic_mux_interrupt_ = true;
-		logic_mux_cond_.notify_one();
-		logic_mux_thread_.join();
-	}
+	stop_decode_threads();
 
 	reset_decode();
 
@@ -246,26 +282,94 @@ void DecodeSignal::begin_decode()
 			return;
 		}
 
-	// Free the logic data and its segment(s) if it needs to be updated
-	if (logic_mux_data_invalid_)
-		logic_mux_data_.reset();
+	// Whether the muxer can be bypassed depends on the logic data the input
+	// signals currently use, so the channel bit IDs may have to be updated.
+	// The decoder instances have been set up with the old ones, so they must
+	// be re-created in that case
+	vector<uint16_t> prev_bit_ids;
+	for (const decode::DecodeChannel& ch : channels_)
+		prev_bit_ids.push_back(ch.bit_id);
 
-	if (!logic_mux_data_) {
-		const uint32_t ch_count = get_assigned_signal_count();
-		logic_mux_unit_size_ = (ch_count + 7) / 8;
-		logic_mux_data_ = make_shared<Logic>(ch_count);
-	}
+	commit_decoder_channels();
+
+	for (size_t i = 0; i < channels_.size(); i++)
+		if (channels_[i].assigned_signal && (channels_[i].bit_id != prev_bit_ids[i])) {
+			stop_srd_session();
+			break;
+		}
+
+	// If all channels are taken from the same logic data, the decoders can
+	// work on its samples as they are and there's no need to mux them.
+	// In that case, the unit size is only used to size the chunks
+	const shared_ptr<Logic> shared_input_data = get_shared_input_data();
+	logic_mux_bypassed_ = (bool)shared_input_data;
+
+	if (logic_mux_bypassed_)
+		logic_mux_unit_size_ = (shared_input_data->num_channels() + 7) / 8;
+	else
+		logic_mux_unit_size_ = (get_assigned_signal_count() + 7) / 8;
 
 	if (get_input_segment_count() == 0)
 		set_error_message(tr("No input data"));
 
-	// Make sure the logic output data is complete and up-to-date
+	bool has_logic_output = false;
+	for (const shared_ptr<Decoder>& dec : stack_)
+		if (dec->has_logic_output())
+			has_logic_output = true;
+
+	// Decoders running in worker processes don't compete with other decode
+	// signals for the Python interpreter, but can't provide logic output
+	GlobalSettings settings;
+	decode_out_of_process_ = !has_logic_output &&
+		settings.value(GlobalSettings::Key_Dec_OutOfProcess).toBool();
+
+	// The parts of a split segment are decoded out of order, so the same
+	// goes for splitting segments. They're decoded in parallel, which is
+	// pointless if the decoders take turns on the Python interpreter
+	decode_split_segments_ = decode_out_of_process_ && !has_logic_output &&
+		settings.value(GlobalSettings::Key_Dec_SplitSegments).toBool();
+
+	// Logic output isn't cached, so the decoders must always run for it
+	decode_cache_enabled_ = !has_logic_output &&
+		settings.value(GlobalSettings::Key_Dec_CacheResults).toBool();
+
+	decode_spill_annotations_ =
+		settings.value(GlobalSettings::Key_Dec_SpillAnnotations).toBool();
+
+	// The parts of a decode range are decoded out of order as well
+	decode_ranged_ = !has_logic_output && decode_range_set_;
+
+	start_decode_threads(has_logic_output);
+}
+
+void DecodeSignal::start_decode_threads(bool has_logic_output)
+{
+	// Feed the decode thread with muxed logic data
 	logic_mux_interrupt_ = false;
 	logic_mux_thread_ = std::thread(&DecodeSignal::logic_mux_proc, this);
 
 	// Decode the muxed logic data
 	decode_interrupt_ = false;
 	decode_thread_ = std::thread(&DecodeSignal::decode_proc, this);
+
+	// Segments that are complete can be decoded independently of each other,
+	// so let additional threads work on them. Logic output must be generated
+	// in order though, so this isn't possible if a decoder provides any.
+	// The workers and the parts of split segments they decode share the
+	// cores that the decode thread leaves. Decoders running in this process
+	// take turns on the Python interpreter lock though, so only a small pool
+	// of workers is started for them. It still lets one worker mux or store
+	// output while another one runs its decoders
+	if (!has_logic_output) {
+		const unsigned int worker_count = decode_out_of_process_ ?
+			min(max(std::thread::hardware_concurrency(), 2U) - 1, MaxDecodeWorkerCount) :
+			InProcessDecodeWorkerCount;
+
+		decode_thread_budget_ = worker_count;
+
+		for (unsigned int i = 0; i < worker_count; i++)
+			decode_workers_.emplace_back(&DecodeSignal::decode_worker_proc, this);
+	}
 }
 
 void DecodeSignal::pause_decode()
@@ -276,9 +380,9 @@ void DecodeSignal::pause_decode()
 void DecodeSignal::resume_decode()
 {
 	// Manual unlocking is done before notifying, to avoid waking up the
-	// waiting thread only to block again (see notify_one for details)
+	// waiting threads only to block again (see notify_all for details)
 	decode_pause_mutex_.unlock();
-	decode_pause_cond_.notify_one();
+	decode_pause_cond_.notify_all();
 	decode_paused_ = false;
 }
 
@@ -287,6 +391,50 @@ bool DecodeSignal::is_paused() const
 	return decode_paused_;
 }
 
+void DecodeSignal::set_decode_range(int64_t start_sample, int64_t end_sample)
+{
+	apply_decode_range(true, start_sample, end_sample);
+}
+
+void DecodeSignal::clear_decode_range()
+{
+	if (decode_range_set_)
+		apply_decode_range(false, 0, numeric_limits<int64_t>::max());
+}
+
+bool DecodeSignal::has_decode_range() const
+{
+	return decode_range_set_;
+}
+
+bool DecodeSignal::is_partially_decoded(uint32_t segment_id) const
+{
+	const int64_t sample_count = get_working_sample_count(segment_id);
+
+	lock_guard<mutex> lock(output_mutex_);
+
+	if (segment_id >= segments_.size())
+		return false;
+
+	const DecodeSegment& segment = segments_[segment_id];
+	if (!segment.range_limited)
+		return false;
+
+	return (segment.decoded_ranges.size() != 1) ||
+		(segment.decoded_ranges.front().first > 0) ||
+		(segment.decoded_ranges.front().second < sample_count);
+}
+
+vector< pair<int64_t, int64_t> > DecodeSignal::get_decoded_ranges(uint32_t segment_id) const
+{
+	lock_guard<mutex> lock(output_mutex_);
+
+	if (segment_id >= segments_.size())
+		return vector< pair<int64_t, int64_t> >();
+
+	return segments_[segment_id].decoded_ranges;
+}
+
 const vector<decode::DecodeChannel> DecodeSignal::get_channels() const
 {
 	return channels_;
@@ -357,7 +505,6 @@ void DecodeSignal::auto_assign_signals(const shared_ptr<Decoder> dec)
 		// Receive notifications when new sample data is available
 		connect_input_notifiers();
 
-		logic_mux_data_invalid_ = true;
 		stack_config_changed_ = true;
 		commit_decoder_channels();
 		channels_updated();
@@ -370,10 +517,8 @@ void DecodeSignal::assign_signal(const uint16_t channel_id, shared_ptr<const Sig
 	disconnect_input_notifiers();
 
 	for (decode::DecodeChannel& ch : channels_)
-		if (ch.id == channel_id) {
+		if (ch.id == channel_id)
 			ch.assigned_signal = signal;
-			logic_mux_data_invalid_ = true;
-		}
 
 	// Receive notifications when new sample data is available
 	connect_input_notifiers();
@@ -579,7 +724,7 @@ uint64_t DecodeSignal::get_annotation_count(const Row* row, uint32_t segment_id)
 	return rd->get_annotation_count();
 }
 
-void DecodeSignal::get_annotation_subset(deque<const Annotation*> &dest,
+void DecodeSignal::get_annotation_subset(deque<Annotation> &dest,
 	const Row* row, uint32_t segment_id, uint64_t start_sample,
 	uint64_t end_sample) const
 {
@@ -601,7 +746,7 @@ void DecodeSignal::get_annotation_subset(deque<const Annotation*> &dest,
 	rd->get_annotation_subset(dest, start_sample, end_sample);
 }
 
-void DecodeSignal::get_annotation_subset(deque<const Annotation*> &dest,
+void DecodeSignal::get_annotation_subset(deque<Annotation> &dest,
 	uint32_t segment_id, uint64_t start_sample, uint64_t end_sample) const
 {
 	for (const Row* row : get_rows())
@@ -618,15 +763,19 @@ uint32_t DecodeSignal::get_binary_data_chunk_count(uint32_t segment_id,
 
 	for (const DecodeBinaryClass& bc : segment->binary_classes)
 		if ((bc.decoder == dec) && (bc.info->bin_class_id == bin_class_id))
-			return bc.chunks.size();
+			return bc.data.chunk_count();
 
 	return 0;
 }
 
 void DecodeSignal::get_binary_data_chunk(uint32_t segment_id,
 	const  Decoder* dec, uint32_t bin_class_id, uint32_t chunk_id,
-	const vector<uint8_t> **dest, uint64_t *size)
+	vector<uint8_t> *dest) const
 {
+	assert(dest != nullptr);
+
+	lock_guard<mutex> lock(output_mutex_);
+
 	if (segment_id >= segments_.size())
 		return;
 
@@ -634,8 +783,8 @@ void DecodeSignal::get_binary_data_chunk(uint32_t segment_id,
 
 	for (const DecodeBinaryClass& bc : segment->binary_classes)
 		if ((bc.decoder == dec) && (bc.info->bin_class_id == bin_class_id)) {
-			if (dest) *dest = &(bc.chunks.at(chunk_id).data);
-			if (size) *size = bc.chunks.at(chunk_id).data.size();
+			const uint64_t offset = bc.data.chunk_offset(chunk_id);
+			bc.data.get_data_by_offset(offset, offset + bc.data.chunk_size(chunk_id), dest);
 			return;
 		}
 }
@@ -646,37 +795,17 @@ void DecodeSignal::get_merged_binary_data_chunks_by_sample(uint32_t segment_id,
 {
 	assert(dest != nullptr);
 
+	lock_guard<mutex> lock(output_mutex_);
+
 	if (segment_id >= segments_.size())
 		return;
 
 	const DecodeSegment *segment = &(segments_[segment_id]);
 
-	const DecodeBinaryClass* bin_class = nullptr;
 	for (const DecodeBinaryClass& bc : segment->binary_classes)
-		if ((bc.decoder == dec) && (bc.info->bin_class_id == bin_class_id))
-			bin_class = &bc;
-
-	// Determine overall size before copying to resize dest vector only once
-	uint64_t size = 0;
-	uint64_t matches = 0;
-	for (const DecodeBinaryDataChunk& chunk : bin_class->chunks)
-		if ((chunk.sample >= start_sample) && (chunk.sample < end_sample)) {
-			size += chunk.data.size();
-			matches++;
-		}
-	dest->resize(size);
-
-	uint64_t offset = 0;
-	uint64_t matches2 = 0;
-	for (const DecodeBinaryDataChunk& chunk : bin_class->chunks)
-		if ((chunk.sample >= start_sample) && (chunk.sample < end_sample)) {
-			memcpy(dest->data() + offset, chunk.data.data(), chunk.data.size());
-			offset += chunk.data.size();
-			matches2++;
-
-			// Make sure we don't overwrite memory if the array grew in the meanwhile
-			if (matches2 == matches)
-				break;
+		if ((bc.decoder == dec) && (bc.info->bin_class_id == bin_class_id)) {
+			bc.data.get_data_by_sample(start_sample, end_sample, dest);
+			return;
 		}
 }
 
@@ -686,39 +815,18 @@ void DecodeSignal::get_merged_binary_data_chunks_by_offset(uint32_t segment_id,
 {
 	assert(dest != nullptr);
 
+	lock_guard<mutex> lock(output_mutex_);
+
 	if (segment_id >= segments_.size())
 		return;
 
 	const DecodeSegment *segment = &(segments_[segment_id]);
 
-	const DecodeBinaryClass* bin_class = nullptr;
 	for (const DecodeBinaryClass& bc : segment->binary_classes)
-		if ((bc.decoder == dec) && (bc.info->bin_class_id == bin_class_id))
-			bin_class = &bc;
-
-	// Determine overall size before copying to resize dest vector only once
-	uint64_t size = 0;
-	uint64_t offset = 0;
-	for (const DecodeBinaryDataChunk& chunk : bin_class->chunks) {
-		if (offset >= start)
-			size += chunk.data.size();
-		offset += chunk.data.size();
-		if (offset >= end)
-			break;
-	}
-	dest->resize(size);
-
-	offset = 0;
-	uint64_t dest_offset = 0;
-	for (const DecodeBinaryDataChunk& chunk : bin_class->chunks) {
-		if (offset >= start) {
-			memcpy(dest->data() + dest_offset, chunk.data.data(), chunk.data.size());
-			dest_offset += chunk.data.size();
+		if ((bc.decoder == dec) && (bc.info->bin_class_id == bin_class_id)) {
+			bc.data.get_data_by_offset(start, end, dest);
+			return;
 		}
-		offset += chunk.data.size();
-		if (offset >= end)
-			break;
-	}
 }
 
 const DecodeBinaryClass* DecodeSignal::get_binary_data_class(uint32_t segment_id,
@@ -736,15 +844,58 @@ const DecodeBinaryClass* DecodeSignal::get_binary_data_class(uint32_t segment_id
 	return nullptr;
 }
 
-const deque<const Annotation*>* DecodeSignal::get_all_annotations_by_segment(
+const deque<Annotation>* DecodeSignal::get_all_annotations_by_segment(
 	uint32_t segment_id) const
 {
+	lock_guard<mutex> lock(output_mutex_);
+
 	if (segment_id >= segments_.size())
 		return nullptr;
 
 	const DecodeSegment *segment = &(segments_[segment_id]);
+	deque<Annotation>& all_annotations = segment->all_annotations;
+
+	// Append the annotations that were added since the last call
+	const size_t prev_count = all_annotations.size();
+
+	for (const auto& row_data : segment->annotation_rows) {
+		const RowData* rd = &(row_data.second);
+		uint32_t& count = segment->all_annotations_row_counts[rd];
+
+		for (; count < rd->get_annotation_count(); count++)
+			all_annotations.emplace_back(rd, count);
+	}
+
+	if (all_annotations.size() == prev_count)
+		return &all_annotations;
 
-	return &(segment->all_annotations);
+	// Sort them and merge them into the rest. Only the new part needs to be
+	// sorted as the rest was sorted on the previous call already
+	auto by_start_and_length = [](const Annotation& a, const Annotation& b) {
+		const uint64_t a_start = a.start_sample();
+		const uint64_t b_start = b.start_sample();
+		return (a_start < b_start) || ((a_start == b_start) && (a.length() > b.length())); };
+
+	const auto middle = all_annotations.begin() + prev_count;
+	stable_sort(middle, all_annotations.end(), by_start_and_length);
+	inplace_merge(all_annotations.begin(), middle, all_annotations.end(),
+		by_start_and_length);
+
+	return &all_annotations;
+}
+
+decode::Profiler::Snapshot DecodeSignal::get_profile() const
+{
+	return profiler_.snapshot();
+}
+
+string DecodeSignal::get_profile_json() const
+{
+	vector<string> decoder_ids;
+	for (const shared_ptr<Decoder>& dec : stack_)
+		decoder_ids.emplace_back(dec->get_srd_decoder()->id);
+
+	return decode::Profiler::to_json(profiler_.snapshot(), decoder_ids);
 }
 
 void DecodeSignal::save_settings(QSettings &settings) const
@@ -833,8 +984,6 @@ void DecodeSignal::restore_settings(QSettings &settings)
 	SignalBase::restore_settings(settings);
 
 	// Restore decoder stack
-	GSList *dec_list = g_slist_copy((GSList*)srd_decoder_list());
-
 	int decoders = settings.value("decoders").toInt();
 
 	for (int decoder_idx = 0; decoder_idx < decoders; decoder_idx++) {
@@ -842,53 +991,48 @@ void DecodeSignal::restore_settings(QSettings &settings)
 
 		QString id = settings.value("id").toString();
 
-		for (GSList *entry = dec_list; entry; entry = entry->next) {
-			const srd_decoder *dec = (srd_decoder*)entry->data;
-			if (!dec)
-				continue;
-
-			if (QString::fromUtf8(dec->id) == id) {
-				shared_ptr<Decoder> decoder = make_shared<Decoder>(dec, stack_.size());
+		// The decoder's module is loaded here if no other signal uses it yet
+		const srd_decoder *dec = DecoderIndex::get_decoder(id);
 
-				connect(decoder.get(), SIGNAL(annotation_visibility_changed()),
-					this, SLOT(on_annotation_visibility_changed()));
+		if (dec) {
+			shared_ptr<Decoder> decoder = make_shared<Decoder>(dec, stack_.size());
 
-				stack_.push_back(decoder);
-				decoder->set_visible(settings.value("visible", true).toBool());
+			connect(decoder.get(), SIGNAL(annotation_visibility_changed()),
+				this, SLOT(on_annotation_visibility_changed()));
 
-				// Restore decoder options that differ from their default
-				int options = settings.value("options").toInt();
+			stack_.push_back(decoder);
+			decoder->set_visible(settings.value("visible", true).toBool());
 
-				for (int i = 0; i < options; i++) {
-					settings.beginGroup("option" + QString::number(i));
-					QString name = settings.value("name").toString();
-					GVariant *value = GlobalSettings::restore_gvariant(settings);
-					decoder->set_option(name.toUtf8(), value);
-					settings.endGroup();
-				}
+			// Restore decoder options that differ from their default
+			int options = settings.value("options").toInt();
 
-				// Include the newly created decode channels in the channel lists
-				update_channel_list();
+			for (int i = 0; i < options; i++) {
+				settings.beginGroup("option" + QString::number(i));
+				QString name = settings.value("name").toString();
+				GVariant *value = GlobalSettings::restore_gvariant(settings);
+				decoder->set_option(name.toUtf8(), value);
+				settings.endGroup();
+			}
 
-				// Restore row properties
-				int i = 0;
-				for (Row* row : decoder->get_rows()) {
-					settings.beginGroup("row" + QString::number(i));
-					row->set_visible(settings.value("visible", true).toBool());
-					settings.endGroup();
-					i++;
-				}
+			// Include the newly created decode channels in the channel lists
+			update_channel_list();
 
-				// Restore class properties
-				i = 0;
-				for (AnnotationClass* ann_class : decoder->ann_classes()) {
-					settings.beginGroup("ann_class" + QString::number(i));
-					ann_class->set_visible(settings.value("visible", true).toBool());
-					settings.endGroup();
-					i++;
-				}
+			// Restore row properties
+			int i = 0;
+			for (Row* row : decoder->get_rows()) {
+				settings.beginGroup("row" + QString::number(i));
+				row->set_visible(settings.value("visible", true).toBool());
+				settings.endGroup();
+				i++;
+			}
 
-				break;
+			// Restore class properties
+			i = 0;
+			for (AnnotationClass* ann_class : decoder->ann_classes()) {
+				settings.beginGroup("ann_class" + QString::number(i));
+				ann_class->set_visible(settings.value("visible", true).toBool());
+				settings.endGroup();
+				i++;
 			}
 		}
 
@@ -982,6 +1126,25 @@ uint32_t DecodeSignal::get_input_segment_count() const
 	return (no_signals_assigned ? 0 : count);
 }
 
+shared_ptr<Logic> DecodeSignal::get_shared_input_data() const
+{
+	shared_ptr<Logic> result;
+
+	for (const decode::DecodeChannel& ch : channels_)
+		if (ch.assigned_signal) {
+			const shared_ptr<Logic> logic_data = ch.assigned_signal->logic_data();
+			if (!logic_data)
+				return nullptr;
+
+			if (!result)
+				result = logic_data;
+			else if (logic_data != result)
+				return nullptr;
+		}
+
+	return result;
+}
+
 double DecodeSignal::get_input_samplerate(uint32_t segment_id) const
 {
 	double samplerate = 0;
@@ -1074,25 +1237,6 @@ void DecodeSignal::update_channel_list()
 		}
 	}
 
-	// Invalidate the logic output data if the channel assignment changed
-	if (prev_channels.size() != channels_.size()) {
-		// The number of channels changed, there's definitely a difference
-		logic_mux_data_invalid_ = true;
-	} else {
-		// Same number but assignment may still differ, so compare all channels
-		for (size_t i = 0; i < channels_.size(); i++) {
-			const decode::DecodeChannel& p_ch = prev_channels[i];
-			const decode::DecodeChannel& ch = channels_[i];
-
-			if ((p_ch.pdch_ != ch.pdch_) ||
-				(p_ch.assigned_signal != ch.assigned_signal)) {
-				logic_mux_data_invalid_ = true;
-				break;
-			}
-		}
-
-	}
-
 	channels_updated();
 }
 
@@ -1109,334 +1253,1118 @@ void DecodeSignal::commit_decoder_channels()
 		dec->set_channels(channel_list);
 	}
 
-	// Channel bit IDs must be in sync with the channel's apperance in channels_
+	// Channel bit IDs must be in sync with the channel's apperance in channels_.
+	// When the muxer is bypassed, the decoders receive the input samples as
+	// they are, so the bit IDs are the channels' positions within those instead
+	const bool bypass_mux = (bool)get_shared_input_data();
+
 	int id = 0;
 	for (decode::DecodeChannel& ch : channels_)
 		if (ch.assigned_signal)
-			ch.bit_id = id++;
+			ch.bit_id = bypass_mux ? ch.assigned_signal->logic_bit_index() : id++;
 }
 
-void DecodeSignal::mux_logic_samples(uint32_t segment_id, const int64_t start, const int64_t end)
+bool DecodeSignal::mux_logic_samples(uint32_t segment_id, const int64_t start,
+	const int64_t end, decode::MuxChunk* chunk)
 {
-	// Enforce end to be greater than start
+	chunk->segment_id = segment_id;
+	chunk->start_sample = start;
+	chunk->end_sample = end;
+	chunk->unit_size = logic_mux_unit_size_;
+	chunk->segment_complete = false;
+	chunk->data.clear();
+	chunk->shared_data.reset();
+
 	if (end <= start)
-		return;
+		return true;
 
-	// Fetch the channel segments and their data
+	// Fetch the channel segments. Channels usually share their segment
+	// with others, so every segment is only read once
 	vector<shared_ptr<const LogicSegment> > segments;
-	vector<const uint8_t*> signal_data;
-	vector<uint8_t> signal_in_bytepos;
-	vector<uint8_t> signal_in_bitpos;
+	vector<size_t> channel_segments;
+	vector<unsigned int> channel_bit_indices;
 
 	for (decode::DecodeChannel& ch : channels_)
 		if (ch.assigned_signal) {
 			const shared_ptr<Logic> logic_data = ch.assigned_signal->logic_data();
 
 			shared_ptr<const LogicSegment> segment;
-			if (segment_id < logic_data->logic_segments().size()) {
+			try {
 				segment = logic_data->logic_segments().at(segment_id)->get_shared_ptr();
-			} else {
+			} catch (out_of_range&) {
 				qDebug() << "Muxer error for" << name() << ":" << ch.assigned_signal->name() \
 					<< "has no logic segment" << segment_id;
-				logic_mux_interrupt_ = true;
-				return;
+				return false;
 			}
 
 			if (!segment)
-				return;
-
-			segments.push_back(segment);
+				return false;
 
-			uint8_t* data = new uint8_t[(end - start) * segment->unit_size()];
-			segment->get_samples(start, end, data);
-			signal_data.push_back(data);
+			const auto it = find(segments.begin(), segments.end(), segment);
+			channel_segments.push_back(it - segments.begin());
+			channel_bit_indices.push_back(ch.assigned_signal->logic_bit_index());
 
-			const int bitpos = ch.assigned_signal->logic_bit_index();
-			signal_in_bytepos.push_back(bitpos / 8);
-			signal_in_bitpos.push_back(bitpos % 8);
+			if (it == segments.end())
+				segments.push_back(segment);
 		}
 
-	shared_ptr<LogicSegment> output_segment;
-	try {
-		output_segment = logic_mux_data_->logic_segments().at(segment_id);
-	} catch (out_of_range&) {
-		qDebug() << "Muxer error for" << name() << ": no logic mux segment" \
-			<< segment_id << "in mux_logic_samples(), mux segments size is" \
-			<< logic_mux_data_->logic_segments().size();
-		logic_mux_interrupt_ = true;
-		return;
-	}
-
-	// Perform the muxing of signal data into the output data
-	uint8_t* output = new uint8_t[(end - start) * output_segment->unit_size()];
-	unsigned int signal_count = signal_data.size();
-
-	for (int64_t sample_cnt = 0; !logic_mux_interrupt_ && (sample_cnt < (end - start));
-		sample_cnt++) {
+	// If the muxer is bypassed, all channels share the same segment and
+	// its samples are handed on as they are
+	if (logic_mux_bypassed_) {
+		const shared_ptr<const LogicSegment> segment = segments.front();
 
-		int bitpos = 0;
-		uint8_t bytepos = 0;
-
-		const int out_sample_pos = sample_cnt * output_segment->unit_size();
-		for (unsigned int i = 0; i < output_segment->unit_size(); i++)
-			output[out_sample_pos + i] = 0;
+		decode::Profiler::StageTimer timer(profiler_, decode::Profiler::CopyStage);
+		chunk->unit_size = segment->unit_size();
+		chunk->data.resize((end - start) * chunk->unit_size);
+		segment->get_samples(start, end, chunk->data.data());
+		return true;
+	}
 
-		for (unsigned int i = 0; i < signal_count; i++) {
-			const int in_sample_pos = sample_cnt * segments[i]->unit_size();
-			const uint8_t in_sample = 1 &
-				((signal_data[i][in_sample_pos + signal_in_bytepos[i]]) >> (signal_in_bitpos[i]));
+	// Decode signals using the same channels share the muxed samples
+	vector<decode::MuxInput> mux_inputs;
+	for (size_t i = 0; i < channel_segments.size(); i++)
+		mux_inputs.push_back({segments[channel_segments[i]], channel_bit_indices[i]});
 
-			const uint8_t out_sample = output[out_sample_pos + bytepos];
+	decode::MuxCache& mux_cache = session_.mux_cache();
 
-			output[out_sample_pos + bytepos] = out_sample | (in_sample << bitpos);
+	chunk->shared_data = mux_cache.find(mux_inputs, start, end);
+	if (chunk->shared_data)
+		return true;
 
-			bitpos++;
-			if (bitpos > 7) {
-				bitpos = 0;
-				bytepos++;
-			}
+	vector<uint8_t*> segment_data;
+	{
+		decode::Profiler::StageTimer timer(profiler_, decode::Profiler::CopyStage);
+		for (const shared_ptr<const LogicSegment>& segment : segments) {
+			uint8_t* data = new uint8_t[(end - start) * segment->unit_size()];
+			segment->get_samples(start, end, data);
+			segment_data.push_back(data);
 		}
 	}
 
-	output_segment->append_payload(output, (end - start) * output_segment->unit_size());
-	delete[] output;
+	vector<decode::MuxChannel> mux_channels;
+	for (size_t i = 0; i < channel_segments.size(); i++)
+		mux_channels.push_back({segment_data[channel_segments[i]],
+			segments[channel_segments[i]]->unit_size(), channel_bit_indices[i]});
+
+	// Perform the muxing of signal data into the output data
+	shared_ptr< vector<uint8_t> > muxed_data =
+		make_shared< vector<uint8_t> >((end - start) * chunk->unit_size);
+	{
+		decode::Profiler::StageTimer timer(profiler_, decode::Profiler::MuxStage);
+		decode::mux_logic_channels(mux_channels, end - start, muxed_data->data(),
+			chunk->unit_size);
+	}
 
-	for (const uint8_t* data : signal_data)
+	for (uint8_t* data : segment_data)
 		delete[] data;
+
+	mux_cache.insert(mux_inputs, start, end, muxed_data);
+	chunk->shared_data = muxed_data;
+
+	return true;
 }
 
 void DecodeSignal::logic_mux_proc()
 {
-	uint32_t input_segment_count;
-	do {
-		input_segment_count = get_input_segment_count();
-		if (input_segment_count == 0) {
-			// Wait for input data
-			unique_lock<mutex> logic_mux_lock(logic_mux_mutex_);
-			logic_mux_cond_.wait(logic_mux_lock);
-		}
-	} while ((!logic_mux_interrupt_) && (input_segment_count == 0));
-
-	if (logic_mux_interrupt_)
-		return;
-
-	assert(logic_mux_data_);
-
 	uint32_t segment_id = 0;
+	uint64_t muxed_sample_count = 0;
+	bool have_segment = false;
+
+	while (!logic_mux_interrupt_) {
+		// Take on the next segment no one else is working on yet
+		if (!have_segment) {
+			have_segment = claim_input_segment(segment_id, false);
+			muxed_sample_count = 0;
 
-	// Create initial logic mux segment
-	shared_ptr<LogicSegment> output_segment =
-		make_shared<LogicSegment>(*logic_mux_data_, segment_id, logic_mux_unit_size_, 0);
-	logic_mux_data_->push_segment(output_segment);
+			if (!have_segment) {
+				// Wait for input data
+				unique_lock<mutex> logic_mux_lock(logic_mux_mutex_);
+				logic_mux_cond_.wait(logic_mux_lock);
+				continue;
+			}
 
-	output_segment->set_samplerate(get_input_samplerate(0));
+			// A complete segment may not need to be decoded at all. The key
+			// is empty for segments that are still being captured
+			if (decode_cache_enabled_) {
+				const QByteArray cache_key = get_cache_key(segment_id);
 
-	// Logic mux data is being updated
-	logic_mux_data_invalid_ = false;
+				if (!cache_key.isEmpty() && load_cached_segment(segment_id, cache_key)) {
+					finish_decode_segment();
+					have_segment = false;
+					continue;
+				}
+			}
+		}
 
-	uint64_t samples_to_process;
-	do {
+		uint64_t samples_to_process;
 		do {
 			const uint64_t input_sample_count = get_working_sample_count(segment_id);
-			const uint64_t output_sample_count = output_segment->get_sample_count();
 
 			samples_to_process =
-				(input_sample_count > output_sample_count) ?
-				(input_sample_count - output_sample_count) : 0;
+				(input_sample_count > muxed_sample_count) ?
+				(input_sample_count - muxed_sample_count) : 0;
 
 			if (samples_to_process > 0) {
-				const uint64_t unit_size = output_segment->unit_size();
-				const uint64_t chunk_sample_count = DecodeChunkLength / unit_size;
+				const uint64_t chunk_sample_count = DecodeChunkLength / logic_mux_unit_size_;
 
 				uint64_t processed_samples = 0;
 				do {
-					const uint64_t start_sample = output_sample_count + processed_samples;
+					const uint64_t start_sample = muxed_sample_count + processed_samples;
 					const uint64_t sample_count =
 						min(samples_to_process - processed_samples,	chunk_sample_count);
 
-					mux_logic_samples(segment_id, start_sample, start_sample + sample_count);
+					// Blocks while the decoder hasn't caught up yet
+					decode::MuxChunk* chunk = logic_mux_queue_.get_free_chunk();
+					if (!chunk)
+						return;
+
+					if (!mux_logic_samples(segment_id, start_sample,
+						start_sample + sample_count, chunk)) {
+						logic_mux_interrupt_ = true;
+						return;
+					}
 					processed_samples += sample_count;
 
-					// ...and process the newly muxed logic data
-					decode_input_cond_.notify_one();
+					// ...and have the decoder process the newly muxed logic data
+					logic_mux_queue_.push(chunk);
 				} while (!logic_mux_interrupt_ && (processed_samples < samples_to_process));
+
+				muxed_sample_count += processed_samples;
 			}
 		} while (!logic_mux_interrupt_ && (samples_to_process > 0));
 
-		if (!logic_mux_interrupt_) {
-			// samples_to_process is now 0, we've exhausted the currently available input data
-
-			// If the input segments are complete, we've completed this segment
-			if (all_input_segments_complete(segment_id)) {
-				if (!output_segment->is_complete())
-					output_segment->set_complete();
+		if (logic_mux_interrupt_)
+			break;
 
-				if (segment_id < get_input_segment_count() - 1) {
+		// samples_to_process is now 0, we've exhausted the currently available input data
 
-					// Process next segment
-					segment_id++;
+		// If the input segments are complete, we've completed this segment
+		if (all_input_segments_complete(segment_id)) {
+			// Let the decoder know that no more samples will follow
+			decode::MuxChunk* chunk = logic_mux_queue_.get_free_chunk();
+			if (!chunk)
+				return;
 
-					output_segment =
-						make_shared<LogicSegment>(*logic_mux_data_, segment_id,
-							logic_mux_unit_size_, 0);
-					logic_mux_data_->push_segment(output_segment);
+			mux_logic_samples(segment_id, muxed_sample_count, muxed_sample_count, chunk);
+			chunk->segment_complete = true;
+			logic_mux_queue_.push(chunk);
 
-					output_segment->set_samplerate(get_input_samplerate(segment_id));
-				} else {
-					// Wait for more input data if we're processing the currently last segment
-					unique_lock<mutex> logic_mux_lock(logic_mux_mutex_);
-					logic_mux_cond_.wait(logic_mux_lock);
-				}
-			} else {
-				// Input segments aren't all complete yet but samples_to_process is 0, wait for more input data
-				unique_lock<mutex> logic_mux_lock(logic_mux_mutex_);
-				logic_mux_cond_.wait(logic_mux_lock);
-			}
+			have_segment = false;
+		} else {
+			// Input segments aren't all complete yet but samples_to_process is 0, wait for more input data
+			unique_lock<mutex> logic_mux_lock(logic_mux_mutex_);
+			logic_mux_cond_.wait(logic_mux_lock);
 		}
-	} while (!logic_mux_interrupt_);
+	}
 }
 
-void DecodeSignal::decode_data(
-	const int64_t abs_start_samplenum, const int64_t sample_count,
-	const shared_ptr<const LogicSegment> input_segment)
+bool DecodeSignal::claim_input_segment(uint32_t& segment_id, bool complete_only)
 {
-	const int64_t unit_size = input_segment->unit_size();
-	const int64_t chunk_sample_count = DecodeChunkLength / unit_size;
+	lock_guard<mutex> lock(output_mutex_);
 
-	for (int64_t i = abs_start_samplenum;
-		!decode_interrupt_ && (i < (abs_start_samplenum + sample_count));
-		i += chunk_sample_count) {
+	if (next_input_segment_ >= get_input_segment_count())
+		return false;
 
-		const int64_t chunk_end = min(i + chunk_sample_count,
-			abs_start_samplenum + sample_count);
+	const bool complete = all_input_segments_complete(next_input_segment_);
 
-		{
-			lock_guard<mutex> lock(output_mutex_);
-			// Update the sample count showing the samples including currently processed ones
-			segments_.at(current_segment_id_).samples_decoded_incl = chunk_end;
-		}
+	if (complete_only && !complete)
+		return false;
+
+	// Complete segments that may be split are left to the decode workers.
+	// Decode ranges are only decoded by them
+	if (!complete_only && complete && decode_split_segments_)
+		return false;
+	if (!complete_only && decode_ranged_)
+		return false;
+
+	segment_id = next_input_segment_++;
+
+	// Segments are claimed in order, so the decode segments are created in
+	// order. If the decode range was extended, they exist already
+	if (segment_id == segments_.size()) {
+		create_decode_segment();
+		segments_.back().samplerate = get_input_samplerate(segment_id);
+		segments_.back().range_limited = decode_ranged_;
+	}
+	assert(segment_id < segments_.size());
+
+	return true;
+}
+
+void DecodeSignal::finish_decode_segment()
+{
+	bool all_segments_decoded;
+	{
+		lock_guard<mutex> lock(output_mutex_);
+		decoded_segment_count_++;
+		all_segments_decoded = (decoded_segment_count_ >= get_input_segment_count());
+	}
+
+	if (all_segments_decoded && !decode_interrupt_)
+		decode_finished();
+}
+
+void DecodeSignal::decode_data(CallbackContext* context, srd_session* session,
+	decode::RemoteDecoder* remote, const decode::MuxChunk* chunk)
+{
+	{
+		lock_guard<mutex> lock(output_mutex_);
+		// Update the sample count showing the samples including currently processed ones
+		segments_.at(chunk->segment_id).samples_decoded_incl = chunk->end_sample;
+	}
+
+	send_to_decoders(context, session, remote, chunk);
+
+	{
+		lock_guard<mutex> lock(output_mutex_);
+		// Now that all samples are processed, the exclusive sample count catches up.
+		// A worker process may still be busy with the last few chunks though
+		segments_.at(chunk->segment_id).samples_decoded_excl =
+			remote ? remote->consumed_end_sample() : chunk->end_sample;
+	}
+
+	// Notify the frontend that we processed some data and
+	// possibly have new annotations as well
+	notify_new_annotations();
 
-		int64_t data_size = (chunk_end - i) * unit_size;
-		uint8_t* chunk = new uint8_t[data_size];
-		input_segment->get_samples(i, chunk_end, chunk);
+	wait_while_paused();
+}
 
-		if (srd_session_send(srd_session_, i, chunk_end, chunk,
-				data_size, unit_size) != SRD_OK) {
+void DecodeSignal::send_to_decoders(CallbackContext* context, srd_session* session,
+	decode::RemoteDecoder* remote, const decode::MuxChunk* chunk)
+{
+	{
+		decode::Profiler::StageTimer timer(profiler_, decode::Profiler::DecodeStage);
+		profiler_.add_samples(chunk->end_sample - chunk->start_sample);
+
+		if (remote) {
+			if (!remote->send(chunk))
+				handle_remote_decoder_error(remote);
+		} else if (srd_session_send(session, chunk->start_sample, chunk->end_sample,
+				chunk->samples().data(), chunk->samples().size(), chunk->unit_size) != SRD_OK) {
 			set_error_message(tr("Decoder reported an error"));
 			decode_interrupt_ = true;
 		}
+	}
+
+	store_pending_annotations(context->segment_id, context->annotations);
+}
 
-		delete[] chunk;
+void DecodeSignal::send_eof_to_decoders(CallbackContext* context, srd_session* session,
+	decode::RemoteDecoder* remote)
+{
+	{
+		decode::Profiler::StageTimer timer(profiler_, decode::Profiler::DecodeStage);
 
-		{
-			lock_guard<mutex> lock(output_mutex_);
-			// Now that all samples are processed, the exclusive sample count catches up
-			segments_.at(current_segment_id_).samples_decoded_excl = chunk_end;
+		if (remote) {
+			if (!remote->end_segment())
+				handle_remote_decoder_error(remote);
+		} else {
+#if defined HAVE_SRD_SESSION_SEND_EOF && HAVE_SRD_SESSION_SEND_EOF
+			// Tell protocol decoders about the end of
+			// the input data, which may result in more
+			// annotations being emitted
+			(void)srd_session_send_eof(session);
+#else
+			(void)session;
+#endif
 		}
+	}
 
-		// Notify the frontend that we processed some data and
-		// possibly have new annotations as well
-		new_annotations();
+	store_pending_annotations(context->segment_id, context->annotations);
+}
 
-		if (decode_paused_) {
-			unique_lock<mutex> pause_wait_lock(decode_pause_mutex_);
-			decode_pause_cond_.wait(pause_wait_lock);
-		}
+void DecodeSignal::end_decode_segment(CallbackContext* context, srd_session* session,
+	decode::RemoteDecoder* remote)
+{
+	send_eof_to_decoders(context, session, remote);
+
+	if (remote && !decode_interrupt_) {
+		lock_guard<mutex> lock(output_mutex_);
+		segments_.at(context->segment_id).samples_decoded_excl = remote->consumed_end_sample();
 	}
+
+	notify_new_annotations();
 }
 
-void DecodeSignal::decode_proc()
+void DecodeSignal::wait_while_paused()
 {
-	current_segment_id_ = 0;
+	if (decode_paused_) {
+		unique_lock<mutex> pause_wait_lock(decode_pause_mutex_);
+		decode_pause_cond_.wait(pause_wait_lock);
+	}
+}
 
+void DecodeSignal::decode_proc()
+{
 	// If there is no input data available yet, wait until it is or we're interrupted
-	do {
-		if (logic_mux_data_->logic_segments().size() == 0) {
-			// Wait for input data
-			unique_lock<mutex> input_wait_lock(input_mutex_);
-			decode_input_cond_.wait(input_wait_lock);
-		}
-	} while ((!decode_interrupt_) && (logic_mux_data_->logic_segments().size() == 0));
-
-	if (decode_interrupt_)
+	decode::MuxChunk* chunk = logic_mux_queue_.pop();
+	if (!chunk)
 		return;
 
-	shared_ptr<const LogicSegment> input_segment = logic_mux_data_->logic_segments().front()->get_shared_ptr();
-	if (!input_segment)
-		return;
+	// The decode segment has been created when the muxer took on the
+	// input segment, so its sample rate is known and can be passed to SRD
+	current_segment_id_ = chunk->segment_id;
+	main_callback_context_.segment_id = current_segment_id_;
 
-	// Create the initial segment and set its sample rate so that we can pass it to SRD
-	create_decode_segment();
-	segments_.at(current_segment_id_).samplerate = input_segment->samplerate();
-	segments_.at(current_segment_id_).start_time = input_segment->start_time();
+	decode::RemoteDecoder* remote = nullptr;
+	if (decode_out_of_process_) {
+		remote = create_remote_decoder(&main_callback_context_);
+		if (!remote) {
+			logic_mux_queue_.release(chunk);
+			return;
+		}
+	} else
+		start_srd_session();
+
+	// Decode the muxed data chunk by chunk. Once a chunk is processed, it's
+	// returned to the muxer, so only a few of them exist at any time
+	while (chunk) {
+		profiler_.add_queue_depth(logic_mux_queue_.filled_count() + 1);
+
+		if (chunk->segment_id != current_segment_id_) {
+			// Process next segment
+			current_segment_id_ = chunk->segment_id;
+			main_callback_context_.segment_id = current_segment_id_;
+
+			// Reset decoder state but keep the decoder stack intact
+			if (remote) {
+				uint64_t samplerate;
+				{
+					lock_guard<mutex> lock(output_mutex_);
+					samplerate = segments_.at(current_segment_id_).samplerate;
+				}
+				if (!remote->reset(samplerate))
+					handle_remote_decoder_error(remote);
+			} else
+				terminate_srd_session();
+		}
 
-	start_srd_session();
+		if (chunk->end_sample > chunk->start_sample)
+			decode_data(&main_callback_context_, srd_session_, remote, chunk);
 
-	uint64_t samples_to_process = 0;
-	uint64_t abs_start_samplenum = 0;
-	do {
-		// Keep processing new samples until we exhaust the input data
-		do {
-			samples_to_process = input_segment->get_sample_count() - abs_start_samplenum;
+		if (!decode_interrupt_ && chunk->segment_complete) {
+			end_decode_segment(&main_callback_context_, srd_session_, remote);
 
-			if (samples_to_process > 0) {
-				decode_data(abs_start_samplenum, samples_to_process, input_segment);
-				abs_start_samplenum += samples_to_process;
+			if (!decode_interrupt_ && decode_cache_enabled_) {
+				const QByteArray cache_key = get_cache_key(current_segment_id_);
+				if (!cache_key.isEmpty())
+					save_cached_segment(current_segment_id_, cache_key);
 			}
-		} while (!decode_interrupt_ && (samples_to_process > 0));
 
-		if (!decode_interrupt_) {
-			// samples_to_process is now 0, we've exhausted the currently available input data
+			finish_decode_segment();
+		}
 
-			// If the input segment is complete, we've exhausted this segment
-			if (input_segment->is_complete()) {
-#if defined HAVE_SRD_SESSION_SEND_EOF && HAVE_SRD_SESSION_SEND_EOF
-				// Tell protocol decoders about the end of
-				// the input data, which may result in more
-				// annotations being emitted
-				(void)srd_session_send_eof(srd_session_);
-				new_annotations();
-#endif
+		logic_mux_queue_.release(chunk);
 
-				if (current_segment_id_ < (logic_mux_data_->logic_segments().size() - 1)) {
-					// Process next segment
-					current_segment_id_++;
-
-					try {
-						input_segment = logic_mux_data_->logic_segments().at(current_segment_id_);
-					} catch (out_of_range&) {
-						qDebug() << "Decode error for" << name() << ": no logic mux segment" \
-							<< current_segment_id_ << "in decode_proc(), mux segments size is" \
-							<< logic_mux_data_->logic_segments().size();
-						decode_interrupt_ = true;
-						return;
-					}
-					abs_start_samplenum = 0;
-
-					// Create the next segment and set its metadata
-					create_decode_segment();
-					segments_.at(current_segment_id_).samplerate = input_segment->samplerate();
-					segments_.at(current_segment_id_).start_time = input_segment->start_time();
-
-					// Reset decoder state but keep the decoder stack intact
-					terminate_srd_session();
-				} else {
-					// All segments have been processed
-					if (!decode_interrupt_)
-						decode_finished();
-
-					// Wait for more input data
-					unique_lock<mutex> input_wait_lock(input_mutex_);
-					decode_input_cond_.wait(input_wait_lock);
-				}
+		chunk = decode_interrupt_ ? nullptr : logic_mux_queue_.pop();
+	}
+
+	delete remote;
+}
+
+void DecodeSignal::decode_worker_proc()
+{
+	decode::MuxChunk chunk;
+	uint32_t segment_id;
+
+	// Every segment is decoded by a session of its own, so that the
+	// callbacks know which segment the output belongs to. A worker process
+	// is kept for all segments, only its decoder state is reset
+	CallbackContext context = {this, 0, nullptr, {}};
+	decode::RemoteDecoder* remote = nullptr;
+	bool has_thread = false;
+
+	while (!decode_interrupt_) {
+		if (!has_thread) {
+			// Wait until split segments leave a thread for this worker
+			unique_lock<mutex> worker_lock(decode_worker_mutex_);
+			while (!decode_interrupt_ && (decode_thread_budget_ == 0))
+				decode_worker_cond_.wait(worker_lock);
+			if (decode_interrupt_)
+				break;
+
+			decode_thread_budget_--;
+			has_thread = true;
+		}
+
+		if (!claim_input_segment(segment_id, true)) {
+			// Wait for another input segment to complete. Meanwhile, split
+			// segments may use the thread
+			unique_lock<mutex> worker_lock(decode_worker_mutex_);
+			decode_thread_budget_++;
+			has_thread = false;
+			if (!decode_interrupt_)
+				decode_worker_cond_.wait(worker_lock);
+			continue;
+		}
+
+		if (decode_ranged_) {
+			decode_segment_range(segment_id);
+			if (!decode_interrupt_)
+				finish_decode_segment();
+			continue;
+		}
+
+		QByteArray cache_key;
+		if (decode_cache_enabled_) {
+			cache_key = get_cache_key(segment_id);
+
+			if (!cache_key.isEmpty() && load_cached_segment(segment_id, cache_key)) {
+				finish_decode_segment();
+				continue;
+			}
+		}
+
+		if (decode_split_segments_ && decode_split_segment(segment_id)) {
+			if (!decode_interrupt_) {
+				if (!cache_key.isEmpty())
+					save_cached_segment(segment_id, cache_key);
+				finish_decode_segment();
+			}
+			continue;
+		}
+
+		context.segment_id = segment_id;
+		srd_session* session = nullptr;
+
+		if (decode_out_of_process_) {
+			if (!remote) {
+				remote = create_remote_decoder(&context);
+				if (!remote)
+					break;
 			} else {
-				// Input segment isn't complete yet but samples_to_process is 0, wait for more input data
-				unique_lock<mutex> input_wait_lock(input_mutex_);
-				decode_input_cond_.wait(input_wait_lock);
+				uint64_t samplerate;
+				{
+					lock_guard<mutex> lock(output_mutex_);
+					samplerate = segments_.at(segment_id).samplerate;
+				}
+				if (!remote->reset(samplerate)) {
+					handle_remote_decoder_error(remote);
+					break;
+				}
+			}
+		} else {
+			session = create_worker_srd_session(&context);
+			if (!session) {
+				set_error_message(tr("Failed to create decoder instance"));
+				decode_interrupt_ = true;
+				break;
+			}
+		}
+
+		const int64_t sample_count = get_working_sample_count(segment_id);
+		const int64_t chunk_sample_count = DecodeChunkLength / logic_mux_unit_size_;
+
+		for (int64_t i = 0; !decode_interrupt_ && (i < sample_count); i += chunk_sample_count) {
+			const int64_t chunk_end = min(i + chunk_sample_count, sample_count);
+
+			if (!mux_logic_samples(segment_id, i, chunk_end, &chunk)) {
+				decode_interrupt_ = true;
+				break;
+			}
+
+			decode_data(&context, session, remote, &chunk);
+		}
+
+		if (!decode_interrupt_) {
+			end_decode_segment(&context, session, remote);
+
+			if (!decode_interrupt_ && !cache_key.isEmpty())
+				save_cached_segment(segment_id, cache_key);
+
+			finish_decode_segment();
+		}
+
+		if (session)
+			srd_session_destroy(session);
+	}
+
+	if (has_thread)
+		return_decode_threads(1);
+
+	delete remote;
+}
+
+bool DecodeSignal::find_idle_gap(const vector< pair<shared_ptr<LogicSegment>, int> >& inputs,
+	int64_t start, int64_t end, int64_t& gap_start, int64_t& gap_end)
+{
+	int64_t prev_edge = start;  // The window boundaries count as edges
+	int64_t min_interval = 0;
+	bool have_edge = false;
+
+	gap_start = gap_end = start;
+
+	vector<LogicSegment::EdgePair> edges;
+	vector<int64_t> positions;
+
+	// Blockwise, so that busy signals don't make the edge lists grow too large
+	for (int64_t block_start = start; block_start < end;
+		block_start += SplitScanBlockLength) {
+		const int64_t block_end = min(block_start + SplitScanBlockLength, end);
+
+		positions.clear();
+		for (const pair<shared_ptr<LogicSegment>, int>& input : inputs) {
+			edges.clear();
+			input.first->get_subsampled_edges(edges, block_start, block_end, 1, input.second);
+
+			// The first and last entries are the states at the block boundaries
+			for (size_t i = 1; i + 1 < edges.size(); i++)
+				positions.push_back(edges[i].first);
+		}
+
+		sort(positions.begin(), positions.end());
+
+		for (const int64_t pos : positions) {
+			if (pos <= prev_edge)
+				continue;
+
+			if (have_edge && ((min_interval == 0) || (pos - prev_edge < min_interval)))
+				min_interval = pos - prev_edge;
+
+			if (pos - prev_edge > gap_end - gap_start) {
+				gap_start = prev_edge;
+				gap_end = pos;
+			}
+
+			prev_edge = pos;
+			have_edge = true;
+		}
+	}
+
+	if (end - prev_edge > gap_end - gap_start) {
+		gap_start = prev_edge;
+		gap_end = end;
+	}
+
+	// The bus must be idle for much longer than it takes to transfer a
+	// bit or so for the decoders to resynchronize during the gap. If there
+	// are hardly any edges, the bus is idle most of the time anyway
+	return (min_interval == 0) || (gap_end - gap_start >= SplitIdleFactor * min_interval);
+}
+
+vector<DecodeSignal::SplitRange> DecodeSignal::find_split_ranges(uint32_t segment_id,
+	unsigned int max_range_count) const
+{
+	vector<SplitRange> ranges;
+
+	const int64_t sample_count = get_working_sample_count(segment_id);
+	const int64_t range_count = min((int64_t)max_range_count,
+		sample_count / SplitMinRangeLength);
+
+	if (range_count < 2)
+		return ranges;
+
+	vector< pair<shared_ptr<LogicSegment>, int> > inputs;
+	if (!get_input_segments(segment_id, inputs))
+		return ranges;
+
+	// Look for the longest idle gap around each of the points that would
+	// split the segment evenly
+	const int64_t window = sample_count / (4 * range_count);
+	vector< pair<int64_t, int64_t> > gaps;
+
+	for (int64_t i = 1; i < range_count; i++) {
+		const int64_t target = sample_count * i / range_count;
+		int64_t gap_start, gap_end;
+
+		if (find_idle_gap(inputs, target - window, min(target + window, sample_count - 1),
+			gap_start, gap_end))
+			gaps.emplace_back(gap_start, gap_end);
+	}
+
+	if (gaps.empty())
+		return ranges;
+
+	int64_t start_sample = 0, keep_start = 0;
+
+	for (const pair<int64_t, int64_t>& gap : gaps) {
+		const int64_t split_sample = (gap.first + gap.second) / 2;
+
+		ranges.emplace_back();
+		ranges.back().start_sample = start_sample;
+		ranges.back().end_sample = gap.second;
+		ranges.back().keep_start = keep_start;
+		ranges.back().keep_end = split_sample;
+
+		start_sample = gap.first;
+		keep_start = split_sample;
+	}
+
+	// Output that comes with the end of the input data is kept as well
+	ranges.emplace_back();
+	ranges.back().start_sample = start_sample;
+	ranges.back().end_sample = sample_count;
+	ranges.back().keep_start = keep_start;
+	ranges.back().keep_end = numeric_limits<int64_t>::max();
+
+	return ranges;
+}
+
+bool DecodeSignal::get_input_segments(uint32_t segment_id,
+	vector< pair<shared_ptr<LogicSegment>, int> >& inputs) const
+{
+	for (const decode::DecodeChannel& ch : channels_)
+		if (ch.assigned_signal) {
+			const shared_ptr<Logic> logic_data = ch.assigned_signal->logic_data();
+
+			try {
+				inputs.emplace_back(logic_data->logic_segments().at(segment_id),
+					ch.assigned_signal->logic_bit_index());
+			} catch (out_of_range&) {
+				return false;
+			}
+		}
+
+	return true;
+}
+
+bool DecodeSignal::decode_split_segment(uint32_t segment_id)
+{
+	// The worker's own thread decodes the first part, the others need
+	// threads that other workers don't use
+	const unsigned int extra_threads = take_decode_threads(MaxDecodeWorkerCount - 1);
+
+	vector<SplitRange> ranges = find_split_ranges(segment_id, extra_threads + 1);
+
+	if (ranges.empty()) {
+		return_decode_threads(extra_threads);
+		return false;
+	}
+
+	return_decode_threads(extra_threads + 1 - ranges.size());
+
+	{
+		lock_guard<mutex> lock(output_mutex_);
+		segments_.at(segment_id).samples_decoded_incl = ranges.back().end_sample;
+	}
+
+	vector<std::thread> threads;
+	for (size_t i = 1; i < ranges.size(); i++)
+		threads.emplace_back(&DecodeSignal::decode_split_range, this, segment_id, &ranges[i]);
+
+	decode_split_range(segment_id, &ranges[0]);
+
+	// Store the output in order, so that the annotations are appended
+	// to the rows just like when the segment is decoded serially
+	for (size_t i = 0; i < ranges.size(); i++) {
+		if (i > 0)
+			threads[i - 1].join();
+
+		if (!decode_interrupt_) {
+			commit_split_range(segment_id, ranges[i]);
+
+			{
+				lock_guard<mutex> lock(output_mutex_);
+				segments_.at(segment_id).samples_decoded_excl =
+					min(ranges[i].keep_end, ranges[i].end_sample);
 			}
 
+			notify_new_annotations();
+		}
+	}
+
+	return_decode_threads(ranges.size() - 1);
+
+	return true;
+}
+
+void DecodeSignal::decode_split_range(uint32_t segment_id, SplitRange* range)
+{
+	CallbackContext context = {this, segment_id, range, {}};
+	srd_session* session = nullptr;
+	decode::RemoteDecoder* remote = nullptr;
+
+	if (decode_out_of_process_) {
+		remote = create_remote_decoder(&context);
+		if (!remote)
+			return;
+	} else {
+		session = create_worker_srd_session(&context);
+		if (!session) {
+			set_error_message(tr("Failed to create decoder instance"));
+			decode_interrupt_ = true;
+			return;
+		}
+	}
+
+	decode::MuxChunk chunk;
+	const int64_t chunk_sample_count = DecodeChunkLength / logic_mux_unit_size_;
+
+	for (int64_t i = range->start_sample; !decode_interrupt_ && (i < range->end_sample);
+		i += chunk_sample_count) {
+		const int64_t chunk_end = min(i + chunk_sample_count, range->end_sample);
+
+		if (!mux_logic_samples(segment_id, i, chunk_end, &chunk)) {
+			decode_interrupt_ = true;
+			break;
+		}
+
+		// The callbacks move the output back into place
+		chunk.start_sample -= range->start_sample;
+		chunk.end_sample -= range->start_sample;
+
+		send_to_decoders(&context, session, remote, &chunk);
+
+		wait_while_paused();
+	}
+
+	if (!decode_interrupt_)
+		send_eof_to_decoders(&context, session, remote);
+
+	if (session)
+		srd_session_destroy(session);
+	delete remote;
+}
+
+void DecodeSignal::commit_split_range(uint32_t segment_id, SplitRange& range)
+{
+	store_pending_annotations(segment_id, range.annotations);
+
+	for (const SplitRangeBinaryData& b : range.binary_data)
+		store_binary_data(segment_id, b.decoder, b.start_sample, b.bin_class,
+			b.data.data(), b.data.size());
+
+	range.binary_data.clear();
+}
+
+void DecodeSignal::decode_segment_range(uint32_t segment_id)
+{
+	const int64_t sample_count = get_working_sample_count(segment_id);
+	const int64_t range_start = min(max(decode_range_start_, (int64_t)0), sample_count);
+	const int64_t range_end = min(max(decode_range_end_, range_start), sample_count);
+
+	vector< pair<int64_t, int64_t> > missing_parts;
+	{
+		lock_guard<mutex> lock(output_mutex_);
+		DecodeSegment& segment = segments_.at(segment_id);
+
+		// The parts that haven't been decoded are shown as such, so there's
+		// no need to crop the output to the decoded samples
+		segment.samples_decoded_incl = sample_count;
+		segment.samples_decoded_excl = sample_count;
+
+		int64_t pos = range_start;
+		for (const pair<int64_t, int64_t>& r : segment.decoded_ranges) {
+			if (pos >= range_end)
+				break;
+			if (r.first > pos)
+				missing_parts.emplace_back(pos, min(r.first, range_end));
+			pos = max(pos, r.second);
+		}
+
+		if (pos < range_end)
+			missing_parts.emplace_back(pos, range_end);
+	}
+
+	vector< pair<shared_ptr<LogicSegment>, int> > inputs;
+	if (!get_input_segments(segment_id, inputs))
+		return;
+
+	for (const pair<int64_t, int64_t>& part : missing_parts) {
+		if (decode_interrupt_)
+			return;
+
+		SplitRange range;
+		range.keep_start = part.first;
+		range.keep_end = (part.second < sample_count) ?
+			part.second : numeric_limits<int64_t>::max();
+
+		// Let the decoders synchronize during an idle gap before the part
+		// and see the bus idle again after it, just like for split segments
+		int64_t gap_start, gap_end;
+
+		range.start_sample = max(part.first - DecodeRangeMargin, (int64_t)0);
+		if ((range.start_sample > 0) &&
+			find_idle_gap(inputs, range.start_sample, part.first, gap_start, gap_end))
+			range.start_sample = gap_start;
+
+		range.end_sample = min(part.second + DecodeRangeMargin, sample_count);
+		if ((range.end_sample < sample_count) &&
+			find_idle_gap(inputs, part.second, range.end_sample, gap_start, gap_end))
+			range.end_sample = gap_end;
+
+		decode_split_range(segment_id, &range);
+
+		if (decode_interrupt_)
+			return;
+
+		commit_split_range(segment_id, range);
+
+		{
+			lock_guard<mutex> lock(output_mutex_);
+			vector< pair<int64_t, int64_t> >& decoded =
+				segments_.at(segment_id).decoded_ranges;
+
+			decoded.insert(upper_bound(decoded.begin(), decoded.end(), part), part);
+
+			// Join the ranges that touch
+			vector< pair<int64_t, int64_t> > merged;
+			for (const pair<int64_t, int64_t>& r : decoded)
+				if (!merged.empty() && (r.first <= merged.back().second))
+					merged.back().second = max(merged.back().second, r.second);
+				else
+					merged.push_back(r);
+			decoded.swap(merged);
+		}
+
+		notify_new_annotations();
+	}
+}
+
+void DecodeSignal::apply_decode_range(bool range_set, int64_t start_sample,
+	int64_t end_sample)
+{
+	// What has been decoded so far can only be kept if the segments have
+	// been decoded range by range, otherwise they're decoded from scratch
+	const bool keep_output = decode_ranged_;
+
+	resume_decode();  // Make sure the decode threads aren't blocked by pausing
+	stop_decode_threads();
+
+	decode_range_set_ = range_set;
+	decode_range_start_ = start_sample;
+	decode_range_end_ = end_sample;
+
+	if (!keep_output) {
+		begin_decode();
+		return;
+	}
+
+	logic_mux_queue_.reset();
+	profiler_.reset();
+
+	{
+		lock_guard<mutex> lock(output_mutex_);
+		next_input_segment_ = 0;
+		decoded_segment_count_ = 0;
+	}
+
+	start_decode_threads(false);
+}
+
+QByteArray DecodeSignal::get_cache_key(uint32_t segment_id)
+{
+	QCryptographicHash hash(QCryptographicHash::Sha1);
+
+	double samplerate;
+	{
+		lock_guard<mutex> lock(output_mutex_);
+		samplerate = segments_.at(segment_id).samplerate;
+	}
+
+	vector< pair<shared_ptr<LogicSegment>, int> > inputs;
+	if (!get_input_segments(segment_id, inputs))
+		return QByteArray();
+
+	// A decoder that was updated may produce different output
+	QString setup = DecoderIndex::stamp().join("\n") + "\n";
+
+	setup += QString("%1 %2 %3 %4 %5\n").arg(srd_lib_version_string_get())
+		.arg(samplerate, 0, 'g', 17).arg(logic_mux_unit_size_).arg((int)logic_mux_bypassed_)
+		.arg(get_working_sample_count(segment_id));
+
+	for (const shared_ptr<Decoder>& dec : stack_) {
+		setup += QString("%1\n").arg(dec->get_srd_decoder()->id);
+
+		for (const auto& option : dec->options()) {
+			gchar *const value = g_variant_print(option.second, TRUE);
+			setup += QString("%1=%2\n").arg(QString::fromStdString(option.first),
+				QString::fromUtf8(value));
+			g_free(value);
+		}
+
+		for (const decode::DecodeChannel* ch : dec->channels())
+			setup += QString("ch %1 %2 %3 %4\n").arg(ch->id).arg(ch->bit_id)
+				.arg((int)(bool)ch->assigned_signal).arg(ch->initial_pin_state);
+	}
+
+	hash.addData(setup.toUtf8());
+
+	// The input data is covered by the hashes of the input segments, which
+	// they calculate only once, and the bits the channels take from them.
+	// This saves muxing the whole segment just to find the cache file
+	for (const pair<shared_ptr<LogicSegment>, int>& input : inputs) {
+		const QByteArray content_hash = input.first->content_hash();
+		if (content_hash.isEmpty())
+			return QByteArray();
+
+		hash.addData(content_hash);
+		hash.addData(QString(" %1 %2\n").arg(input.first->unit_size())
+			.arg(input.second).toUtf8());
+	}
+
+	return hash.result();
+}
+
+bool DecodeSignal::load_cached_segment(uint32_t segment_id, const QByteArray& key)
+{
+	decode::DecodeCacheReader reader(decode::decodecache::file_path(key));
+
+	if (!reader.open())
+		return false;
+
+	// Don't use any of the file unless it fits the decoder stack
+	const decode::decodecache::AnnotationRecord* records = reader.annotations();
+
+	for (uint64_t i = 0; i < reader.annotation_count(); i++)
+		if (records[i].decoder >= stack_.size())
+			return false;
+
+	for (uint64_t i = 0; i < reader.binary_data_count(); i++)
+		if (reader.binary_data(i)->decoder >= stack_.size())
+			return false;
+
+	const int64_t sample_count = get_working_sample_count(segment_id);
+
+	{
+		lock_guard<mutex> lock(output_mutex_);
+
+		for (uint64_t i = 0; i < reader.annotation_count(); i++) {
+			srd_proto_data_annotation pda;
+			memset(&pda, 0, sizeof(pda));
+			pda.ann_class = records[i].ann_class;
+			pda.ann_text = (decltype(pda.ann_text))reader.texts(records[i].text_id);
+
+			srd_proto_data pdata;
+			memset(&pdata, 0, sizeof(pdata));
+			pdata.start_sample = records[i].start_sample;
+			pdata.end_sample = records[i].end_sample;
+			pdata.data = &pda;
+
+			store_annotation(segment_id,
+				stack_[records[i].decoder]->get_srd_decoder(), &pdata);
 		}
-	} while (!decode_interrupt_);
+
+		DecodeSegment& segment = segments_.at(segment_id);
+		segment.samples_decoded_incl = sample_count;
+		segment.samples_decoded_excl = sample_count;
+	}
+
+	for (uint64_t i = 0; i < reader.binary_data_count(); i++) {
+		const decode::decodecache::BinaryDataRecord* record = reader.binary_data(i);
+
+		store_binary_data(segment_id, stack_[record->decoder]->get_srd_decoder(),
+			record->sample, record->bin_class, reader.binary_data_bytes(i),
+			record->size);
+	}
+
+	notify_new_annotations();
+
+	return true;
+}
+
+void DecodeSignal::save_cached_segment(uint32_t segment_id, const QByteArray& key)
+{
+	decode::DecodeCacheWriter writer(decode::decodecache::file_path(key));
+
+	if (!writer.open()) {
+		qWarning() << "Can't create decode cache file for" << display_name();
+		return;
+	}
+
+	// The output of a segment doesn't change anymore once it's decoded,
+	// so the lock is only needed to find the segment
+	const DecodeSegment* segment;
+	{
+		lock_guard<mutex> lock(output_mutex_);
+		segment = &(segments_.at(segment_id));
+	}
+
+	auto decoder_index = [&](const Decoder* dec) {
+		uint16_t index = 0;
+		while ((index < stack_.size()) && (stack_[index].get() != dec))
+			index++;
+		return index; };
+
+	// Only the texts that are used go into the file
+	unordered_map<uint32_t, uint32_t> text_ids;
+
+	for (const auto& row_data : segment->annotation_rows) {
+		const RowData& rd = row_data.second;
+		const uint16_t decoder = decoder_index(rd.row()->decoder());
+
+		for (uint32_t i = 0; i < rd.get_annotation_count(); i++) {
+			const uint32_t pool_id = rd.annotation_text_id(i);
+
+			auto it = text_ids.find(pool_id);
+			if (it == text_ids.end())
+				it = text_ids.emplace(pool_id,
+					writer.add_texts(annotation_texts_.raw_texts(pool_id))).first;
+
+			writer.add_annotation(decoder, rd.annotation_class_id(i),
+				rd.annotation_start_sample(i), rd.annotation_end_sample(i), it->second);
+		}
+	}
+
+	for (const DecodeBinaryClass& bc : segment->binary_classes) {
+		const uint16_t decoder = decoder_index(bc.decoder);
+
+		vector<uint8_t> data;
+		for (uint64_t i = 0; i < bc.data.chunk_count(); i++) {
+			bc.data.get_data_by_offset(bc.data.chunk_offset(i),
+				bc.data.chunk_offset(i) + bc.data.chunk_size(i), &data);
+			writer.add_binary_data(decoder, bc.info->bin_class_id,
+				bc.data.chunk_sample(i), data.data(), data.size());
+		}
+	}
+
+	if (writer.finish())
+		decode::decodecache::prune(DecodeCacheMaxSize);
+	else
+		qWarning() << "Can't write decode cache file for" << display_name();
+}
+
+unsigned int DecodeSignal::take_decode_threads(unsigned int count)
+{
+	lock_guard<mutex> worker_lock(decode_worker_mutex_);
+
+	count = min(count, decode_thread_budget_);
+	decode_thread_budget_ -= count;
+
+	return count;
+}
+
+void DecodeSignal::return_decode_threads(unsigned int count)
+{
+	if (count == 0)
+		return;
+
+	{
+		lock_guard<mutex> worker_lock(decode_worker_mutex_);
+		decode_thread_budget_ += count;
+	}
+
+	// A worker may be waiting for a thread
+	decode_worker_cond_.notify_all();
+}
+
+void DecodeSignal::stop_decode_threads()
+{
+	if (decode_thread_.joinable() || !decode_workers_.empty()) {
+		decode_interrupt_ = true;
+		logic_mux_queue_.interrupt();
+
+		// Taking the mutex makes sure that no worker is about to wait
+		{
+			lock_guard<mutex> worker_lock(decode_worker_mutex_);
+		}
+		decode_worker_cond_.notify_all();
+
+		if (decode_thread_.joinable())
+			decode_thread_.join();
+
+		for (std::thread& worker : decode_workers_)
+			worker.join();
+		decode_workers_.clear();
+	}
+
+	if (logic_mux_thread_.joinable()) {
+		logic_mux_interrupt_ = true;
+		logic_mux_queue_.interrupt();
+		logic_mux_cond_.notify_one();
+		logic_mux_thread_.join();
+	}
 }
 
 void DecodeSignal::start_srd_session()
@@ -1456,8 +2384,11 @@ void DecodeSignal::start_srd_session()
 
 		// Metadata is cleared also, so re-set it
 		uint64_t samplerate = 0;
-		if (segments_.size() > 0)
-			samplerate = segments_.at(current_segment_id_).samplerate;
+		{
+			lock_guard<mutex> lock(output_mutex_);
+			if (segments_.size() > 0)
+				samplerate = segments_.at(current_segment_id_).samplerate;
+		}
 		if (samplerate)
 			srd_session_metadata_set(srd_session_, SRD_CONF_SAMPLERATE,
 				g_variant_new_uint64(samplerate));
@@ -1494,18 +2425,24 @@ void DecodeSignal::start_srd_session()
 	}
 
 	// Start the session
-	if (segments_.size() > 0)
+	uint64_t samplerate = 0;
+	{
+		lock_guard<mutex> lock(output_mutex_);
+		if (segments_.size() > 0)
+			samplerate = segments_.at(current_segment_id_).samplerate;
+	}
+	if (samplerate)
 		srd_session_metadata_set(srd_session_, SRD_CONF_SAMPLERATE,
-			g_variant_new_uint64(segments_.at(current_segment_id_).samplerate));
+			g_variant_new_uint64(samplerate));
 
 	srd_pd_output_callback_add(srd_session_, SRD_OUTPUT_ANN,
-		DecodeSignal::annotation_callback, this);
+		DecodeSignal::annotation_callback, &main_callback_context_);
 
 	srd_pd_output_callback_add(srd_session_, SRD_OUTPUT_BINARY,
-		DecodeSignal::binary_callback, this);
+		DecodeSignal::binary_callback, &main_callback_context_);
 
 	srd_pd_output_callback_add(srd_session_, SRD_OUTPUT_LOGIC,
-		DecodeSignal::logic_output_callback, this);
+		DecodeSignal::logic_output_callback, &main_callback_context_);
 
 	srd_session_start(srd_session_);
 
@@ -1513,6 +2450,82 @@ void DecodeSignal::start_srd_session()
 	stack_config_changed_ = false;
 }
 
+srd_session* DecodeSignal::create_worker_srd_session(CallbackContext* context)
+{
+	srd_session* session = nullptr;
+	srd_session_new(&session);
+	assert(session);
+
+	// Create the decoders. Their instances belong to this session only
+	srd_decoder_inst *prev_di = nullptr;
+	for (const shared_ptr<Decoder>& dec : stack_) {
+		srd_decoder_inst *const di = dec->create_additional_decoder_inst(session);
+
+		if (!di) {
+			srd_session_destroy(session);
+			return nullptr;
+		}
+
+		if (prev_di)
+			srd_inst_stack(session, prev_di, di);
+
+		prev_di = di;
+	}
+
+	uint64_t samplerate;
+	{
+		lock_guard<mutex> lock(output_mutex_);
+		samplerate = segments_.at(context->segment_id).samplerate;
+	}
+	if (samplerate)
+		srd_session_metadata_set(session, SRD_CONF_SAMPLERATE,
+			g_variant_new_uint64(samplerate));
+
+	// No logic output callback as there's no parallel decoding when
+	// a decoder provides logic output
+	srd_pd_output_callback_add(session, SRD_OUTPUT_ANN,
+		DecodeSignal::annotation_callback, context);
+
+	srd_pd_output_callback_add(session, SRD_OUTPUT_BINARY,
+		DecodeSignal::binary_callback, context);
+
+	srd_session_start(session);
+
+	return session;
+}
+
+decode::RemoteDecoder* DecodeSignal::create_remote_decoder(CallbackContext* context)
+{
+	decode::RemoteDecoder* remote = new decode::RemoteDecoder(stack_, decode_interrupt_);
+
+	// The output arrives in the same form it does from libsigrokdecode
+	remote->set_callbacks(DecodeSignal::annotation_callback,
+		DecodeSignal::binary_callback, context);
+
+	uint64_t samplerate;
+	{
+		lock_guard<mutex> lock(output_mutex_);
+		samplerate = segments_.at(context->segment_id).samplerate;
+	}
+
+	if (!remote->start(samplerate, DecodeChunkLength)) {
+		handle_remote_decoder_error(remote);
+		delete remote;
+		return nullptr;
+	}
+
+	return remote;
+}
+
+void DecodeSignal::handle_remote_decoder_error(const decode::RemoteDecoder* remote)
+{
+	// Without an error message, the remote decoder was merely interrupted
+	if (!decode_interrupt_ && !remote->error().isEmpty())
+		set_error_message(tr("Decoder process failed: %1").arg(remote->error()));
+
+	decode_interrupt_ = true;
+}
+
 void DecodeSignal::terminate_srd_session()
 {
 	// Call the "terminate and reset" routine for the decoder stack
@@ -1528,8 +2541,11 @@ void DecodeSignal::terminate_srd_session()
 
 		// Metadata is cleared also, so re-set it
 		uint64_t samplerate = 0;
-		if (segments_.size() > 0)
-			samplerate = segments_.at(current_segment_id_).samplerate;
+		{
+			lock_guard<mutex> lock(output_mutex_);
+			if (segments_.size() > 0)
+				samplerate = segments_.at(current_segment_id_).samplerate;
+		}
 		if (samplerate)
 			srd_session_metadata_set(srd_session_, SRD_CONF_SAMPLERATE,
 				g_variant_new_uint64(samplerate));
@@ -1564,6 +2580,14 @@ void DecodeSignal::connect_input_notifiers()
 		connect(signal, SIGNAL(samples_added(uint64_t, uint64_t, uint64_t)),
 			this, SLOT(on_data_received()), Qt::UniqueConnection);
 
+		// The decode threads must be stopped before the input's data is
+		// replaced, so this can't be a queued connection
+		connect(signal, SIGNAL(data_about_to_change()),
+			this, SLOT(on_input_data_about_to_change()),
+			Qt::ConnectionType(Qt::DirectConnection | Qt::UniqueConnection));
+		connect(signal, SIGNAL(data_changed()),
+			this, SLOT(on_input_data_changed()), Qt::UniqueConnection);
+
 		if (signal->logic_data())
 			connect(signal->logic_data().get(), SIGNAL(segment_completed()),
 				this, SLOT(on_input_segment_completed()), Qt::UniqueConnection);
@@ -1579,6 +2603,8 @@ void DecodeSignal::disconnect_input_notifiers()
 		const data::SignalBase *signal = ch.assigned_signal.get();
 		disconnect(signal, nullptr, this, SLOT(on_data_cleared()));
 		disconnect(signal, nullptr, this, SLOT(on_data_received()));
+		disconnect(signal, nullptr, this, SLOT(on_input_data_about_to_change()));
+		disconnect(signal, nullptr, this, SLOT(on_input_data_changed()));
 
 		if (signal->logic_data())
 			disconnect(signal->logic_data().get(), nullptr, this, SLOT(on_input_segment_completed()));
@@ -1590,10 +2616,14 @@ void DecodeSignal::create_decode_segment()
 	// Create annotation segment
 	segments_.emplace_back();
 
+	decode::AnnotationSpill* const spill = decode_spill_annotations_ ?
+		&(segments_.back().annotation_spill) : nullptr;
+
 	// Add annotation classes
 	for (const shared_ptr<Decoder>& dec : stack_)
 		for (Row* row : dec->get_rows())
-			segments_.back().annotation_rows.emplace(row, RowData(row));
+			segments_.back().annotation_rows.emplace(piecewise_construct,
+				forward_as_tuple(row), forward_as_tuple(row, &annotation_texts_, spill));
 
 	// Prepare our binary output classes
 	for (const shared_ptr<Decoder>& dec : stack_) {
@@ -1601,42 +2631,136 @@ void DecodeSignal::create_decode_segment()
 
 		for (uint32_t i = 0; i < n; i++)
 			segments_.back().binary_classes.push_back(
-				{dec.get(), dec->get_binary_class(i), deque<DecodeBinaryDataChunk>()});
+				{dec.get(), dec->get_binary_class(i), decode::BinaryData()});
 	}
 }
 
-void DecodeSignal::annotation_callback(srd_proto_data *pdata, void *decode_signal)
+void DecodeSignal::notify_new_annotations()
+{
+	// Only one notification is queued at a time, it takes care of everything
+	// that happens until it's delivered
+	if (notification_pending_.exchange(true))
+		return;
+
+	QMetaObject::invokeMethod(this, "on_notification_requested", Qt::QueuedConnection);
+}
+
+int DecodeSignal::get_notification_interval() const
+{
+	qreal rate = MaxNotificationRate;
+
+	const QScreen* screen = QGuiApplication::primaryScreen();
+	if (screen && (screen->refreshRate() > 0))
+		rate = min(rate, screen->refreshRate());
+
+	return max((int)(1000 / rate), 1);
+}
+
+void DecodeSignal::annotation_callback(srd_proto_data *pdata, void *context)
 {
 	assert(pdata);
-	assert(decode_signal);
+	assert(context);
 
-	DecodeSignal *const ds = (DecodeSignal*)decode_signal;
+	CallbackContext *const ctx = (CallbackContext*)context;
+	DecodeSignal *const ds = ctx->decode_signal;
 	assert(ds);
 
 	if (ds->decode_interrupt_)
 		return;
 
-	if (ds->segments_.empty())
-		return;
-
-	lock_guard<mutex> lock(ds->output_mutex_);
-
 	// Get the decoder and the annotation data
 	assert(pdata->pdo);
 	assert(pdata->pdo->di);
 	const srd_decoder *const srd_dec = pdata->pdo->di->decoder;
 	assert(srd_dec);
 
+	// The annotations are stored in batches once the decoders are done
+	// with the chunk, so that the output mutex isn't taken for each
+	vector<PendingAnnotation>* annotations = &(ctx->annotations);
+	int64_t offset = 0;
+
+	if (ctx->split_range) {
+		// Only keep annotations that start in the range's own part of the
+		// segment, the others are found by the neighbouring ranges
+		SplitRange *const range = ctx->split_range;
+		const int64_t start_sample = range->start_sample + pdata->start_sample;
+
+		if ((start_sample < range->keep_start) || (start_sample >= range->keep_end))
+			return;
+
+		annotations = &(range->annotations);
+		offset = range->start_sample;
+	}
+
+	const srd_proto_data_annotation *const pda = (const srd_proto_data_annotation*)pdata->data;
+	assert(pda);
+
+	annotations->emplace_back();
+	PendingAnnotation& a = annotations->back();
+	a.decoder = srd_dec;
+	a.start_sample = offset + pdata->start_sample;
+	a.end_sample = offset + pdata->end_sample;
+	a.ann_class = pda->ann_class;
+
+	for (const char* const* text = (char**)pda->ann_text; *text; text++)
+		a.texts.emplace_back(*text);
+
+	ds->profiler_.add_annotation();
+}
+
+void DecodeSignal::store_pending_annotations(uint32_t segment_id,
+	vector<PendingAnnotation>& annotations)
+{
+	if (annotations.empty())
+		return;
+
+	decode::Profiler::StageTimer timer(profiler_, decode::Profiler::AnnotationStage);
+
+	{
+		lock_guard<mutex> lock(output_mutex_);
+
+		for (PendingAnnotation& a : annotations) {
+			vector<char*> texts;
+			for (string& text : a.texts)
+				texts.push_back(&text[0]);
+			texts.push_back(nullptr);
+
+			srd_proto_data_annotation pda;
+			memset(&pda, 0, sizeof(pda));
+			pda.ann_class = a.ann_class;
+			pda.ann_text = (decltype(pda.ann_text))texts.data();
+
+			srd_proto_data pdata;
+			memset(&pdata, 0, sizeof(pdata));
+			pdata.start_sample = a.start_sample;
+			pdata.end_sample = a.end_sample;
+			pdata.data = &pda;
+
+			store_annotation(segment_id, a.decoder, &pdata);
+		}
+	}
+
+	annotations.clear();
+}
+
+void DecodeSignal::store_annotation(uint32_t segment_id, const srd_decoder* srd_dec,
+	srd_proto_data *pdata)
+{
+	assert(srd_dec);
+
+	if (segment_id >= segments_.size())
+		return;
+
 	const srd_proto_data_annotation *const pda = (const srd_proto_data_annotation*)pdata->data;
 	assert(pda);
 
 	// Find the row
-	Decoder* dec = ds->get_decoder_by_instance(srd_dec);
+	Decoder* dec = get_decoder_by_instance(srd_dec);
 	assert(dec);
 
 	AnnotationClass* ann_class = dec->get_ann_class_by_id(pda->ann_class);
 	if (!ann_class) {
-		qWarning() << "Decoder" << ds->display_name() << "wanted to add annotation" <<
+		qWarning() << "Decoder" << display_name() << "wanted to add annotation" <<
 			"with class ID" << pda->ann_class << "but there are only" <<
 			dec->ann_classes().size() << "known classes";
 		return;
@@ -1647,75 +2771,31 @@ void DecodeSignal::annotation_callback(srd_proto_data *pdata, void *decode_signa
 	if (!row)
 		row = dec->get_row_by_id(0);
 
-	RowData& row_data = ds->segments_[ds->current_segment_id_].annotation_rows.at(row);
+	DecodeSegment& segment = segments_[segment_id];
+	RowData& row_data = segment.annotation_rows.at(row);
 
-	// Add the annotation to the row
-	const Annotation* ann = row_data.emplace_annotation(pdata);
-
-	// We insert the annotation into the global annotation list in a way so that
-	// the annotation list is sorted by start sample and length. Otherwise, we'd
-	// have to sort the model, which is expensive
-	deque<const Annotation*>& all_annotations =
-		ds->segments_[ds->current_segment_id_].all_annotations;
-
-	if (all_annotations.empty()) {
-		all_annotations.emplace_back(ann);
+	// Remember which samples the views must be told about
+	if (segment.has_dirty_range) {
+		segment.dirty_start = min(segment.dirty_start, (int64_t)pdata->start_sample);
+		segment.dirty_end = max(segment.dirty_end, (int64_t)pdata->end_sample);
 	} else {
-		const uint64_t new_ann_len = (pdata->end_sample - pdata->start_sample);
-		bool ann_has_earlier_start = (pdata->start_sample < all_annotations.back()->start_sample());
-		bool ann_is_longer = (new_ann_len >
-			(all_annotations.back()->end_sample() - all_annotations.back()->start_sample()));
-
-		if (ann_has_earlier_start && ann_is_longer) {
-			bool ann_has_same_start;
-			auto it = all_annotations.end();
-
-			do {
-				it--;
-				ann_has_earlier_start = (pdata->start_sample < (*it)->start_sample());
-				ann_has_same_start = (pdata->start_sample == (*it)->start_sample());
-				ann_is_longer = (new_ann_len > (*it)->length());
-			} while ((ann_has_earlier_start || (ann_has_same_start && ann_is_longer)) && (it != all_annotations.begin()));
-
-			// Allow inserting at the front
-			if (it != all_annotations.begin())
-				it++;
-
-			all_annotations.emplace(it, ann);
-		} else
-			all_annotations.emplace_back(ann);
-	}
-
-	// When emplace_annotation() inserts instead of appends an annotation,
-	// the pointers in all_annotations that follow the inserted annotation and
-	// point to annotations for this row are off by one and must be updated
-	if (&(row_data.annotations().back()) != ann) {
-		// Search backwards until we find the annotation we just added
-		auto row_it = row_data.annotations().end();
-		auto all_it = all_annotations.end();
-		do {
-			all_it--;
-			if ((*all_it)->row_data() == &row_data)
-				row_it--;
-		} while (&(*row_it) != ann);
-
-		// Update the annotation addresses for this row's annotations until the end
-		do {
-			if ((*all_it)->row_data() == &row_data) {
-				*all_it = &(*row_it);
-				row_it++;
-			}
-			all_it++;
-		} while (all_it != all_annotations.end());
+		segment.has_dirty_range = true;
+		segment.dirty_start = pdata->start_sample;
+		segment.dirty_end = pdata->end_sample;
 	}
+
+	// Add the annotation to the row. The list of all annotations is updated
+	// lazily by get_all_annotations_by_segment()
+	row_data.emplace_annotation(pdata);
 }
 
-void DecodeSignal::binary_callback(srd_proto_data *pdata, void *decode_signal)
+void DecodeSignal::binary_callback(srd_proto_data *pdata, void *context)
 {
 	assert(pdata);
-	assert(decode_signal);
+	assert(context);
 
-	DecodeSignal *const ds = (DecodeSignal*)decode_signal;
+	const CallbackContext *const ctx = (CallbackContext*)context;
+	DecodeSignal *const ds = ctx->decode_signal;
 	assert(ds);
 
 	if (ds->decode_interrupt_)
@@ -1730,41 +2810,64 @@ void DecodeSignal::binary_callback(srd_proto_data *pdata, void *decode_signal)
 	const srd_proto_data_binary *const pdb = (const srd_proto_data_binary*)pdata->data;
 	assert(pdb);
 
-	// Find the matching DecodeBinaryClass
-	DecodeSegment* segment = &(ds->segments_.at(ds->current_segment_id_));
+	if (ctx->split_range) {
+		SplitRange *const range = ctx->split_range;
+		const int64_t start_sample = range->start_sample + pdata->start_sample;
+
+		if ((start_sample < range->keep_start) || (start_sample >= range->keep_end))
+			return;
 
-	DecodeBinaryClass* bin_class = nullptr;
-	for (DecodeBinaryClass& bc : segment->binary_classes)
-		if ((bc.decoder->get_srd_decoder() == srd_dec) &&
-			(bc.info->bin_class_id == (uint32_t)pdb->bin_class))
-			bin_class = &bc;
+		range->binary_data.emplace_back();
+		SplitRangeBinaryData& b = range->binary_data.back();
+		b.decoder = srd_dec;
+		b.start_sample = start_sample;
+		b.bin_class = pdb->bin_class;
+		b.data.assign(pdb->data, pdb->data + pdb->size);
 
-	if (!bin_class) {
-		qWarning() << "Could not find valid DecodeBinaryClass in segment" <<
-				ds->current_segment_id_ << "for binary class ID" << pdb->bin_class <<
-				", segment only knows" << segment->binary_classes.size() << "classes";
 		return;
 	}
 
-	// Add the data chunk
-	bin_class->chunks.emplace_back();
-	DecodeBinaryDataChunk* chunk = &(bin_class->chunks.back());
+	ds->store_binary_data(ctx->segment_id, srd_dec, pdata->start_sample,
+		pdb->bin_class, pdb->data, pdb->size);
+}
 
-	chunk->sample = pdata->start_sample;
-	chunk->data.resize(pdb->size);
-	memcpy(chunk->data.data(), pdb->data, pdb->size);
+void DecodeSignal::store_binary_data(uint32_t segment_id, const srd_decoder* srd_dec,
+	uint64_t start_sample, int bin_class_id, const uint8_t* data, uint64_t size)
+{
+	{
+		lock_guard<mutex> lock(output_mutex_);
+
+		// Find the matching DecodeBinaryClass
+		DecodeSegment* segment = &(segments_.at(segment_id));
+
+		DecodeBinaryClass* bin_class = nullptr;
+		for (DecodeBinaryClass& bc : segment->binary_classes)
+			if ((bc.decoder->get_srd_decoder() == srd_dec) &&
+				(bc.info->bin_class_id == (uint32_t)bin_class_id))
+				bin_class = &bc;
+
+		if (!bin_class) {
+			qWarning() << "Could not find valid DecodeBinaryClass in segment" <<
+					segment_id << "for binary class ID" << bin_class_id <<
+					", segment only knows" << segment->binary_classes.size() << "classes";
+			return;
+		}
 
-	Decoder* dec = ds->get_decoder_by_instance(srd_dec);
+		// Add the data chunk
+		bin_class->data.append(start_sample, data, size);
+	}
+
+	Decoder* dec = get_decoder_by_instance(srd_dec);
 
-	ds->new_binary_data(ds->current_segment_id_, (void*)dec, pdb->bin_class);
+	new_binary_data(segment_id, (void*)dec, bin_class_id);
 }
 
-void DecodeSignal::logic_output_callback(srd_proto_data *pdata, void *decode_signal)
+void DecodeSignal::logic_output_callback(srd_proto_data *pdata, void *context)
 {
 	assert(pdata);
-	assert(decode_signal);
+	assert(context);
 
-	DecodeSignal *const ds = (DecodeSignal*)decode_signal;
+	DecodeSignal *const ds = ((CallbackContext*)context)->decode_signal;
 	assert(ds);
 
 	if (ds->decode_interrupt_)
@@ -1803,29 +2906,10 @@ void DecodeSignal::logic_output_callback(srd_proto_data *pdata, void *decode_sig
 		output_logic->push_segment(last_segment);
 	}
 
-	if (pdata->start_sample < pdata->end_sample) {
-		vector<uint8_t> data;
-		const unsigned int unit_size = last_segment->unit_size();
-		data.resize(unit_size * (1 + pdl->repeat_count));
-
-		if (unit_size == 1)
-			for (unsigned int i = 0; i <= pdl->repeat_count; i++)
-				data.data()[i * unit_size] = *((uint8_t*)pdl->data);
-		else if (unit_size == 2)
-			for (unsigned int i = 0; i <= pdl->repeat_count; i++)
-				data.data()[i * unit_size] = *((uint16_t*)pdl->data);
-		else if (unit_size <= 4)
-			for (unsigned int i = 0; i <= pdl->repeat_count; i++)
-				data.data()[i * unit_size] = *((uint32_t*)pdl->data);
-		else if (unit_size <= 8)
-			for (unsigned int i = 0; i <= pdl->repeat_count; i++)
-				data.data()[i * unit_size] = *((uint64_t*)pdl->data);
-		else
-			for (unsigned int i = 0; i <= pdl->repeat_count; i++)
-				memcpy((void*)&data.data()[i * unit_size], (void*)pdl->data, unit_size);
-
-		last_segment->append_payload(data.data(), data.size());
-	} else
+	// The decoder provides its output as runs of a constant sample value
+	if (pdata->start_sample < pdata->end_sample)
+		last_segment->append_repeated_payload(pdl->data, 1 + pdl->repeat_count);
+	else
 		qWarning() << "Ignoring malformed logic output state change for group" << pdl->logic_group << "from decoder" \
 			<< QString::fromUtf8(decc->name) << "from" << pdata->start_sample << "to" << pdata->end_sample;
 }
@@ -1833,10 +2917,8 @@ void DecodeSignal::logic_output_callback(srd_proto_data *pdata, void *decode_sig
 void DecodeSignal::on_capture_state_changed(int state)
 {
 	// If a new acquisition was started, we need to start decoding from scratch
-	if (state == Session::Running) {
-		logic_mux_data_invalid_ = true;
+	if (state == Session::Running)
 		begin_decode();
-	}
 }
 
 void DecodeSignal::on_data_cleared()
@@ -1868,6 +2950,26 @@ void DecodeSignal::on_input_segment_completed()
 {
 	if (!logic_mux_thread_.joinable())
 		logic_mux_cond_.notify_one();
+
+	// Idle workers may take on the completed segment now
+	decode_worker_cond_.notify_all();
+}
+
+void DecodeSignal::on_input_data_about_to_change()
+{
+	// Stop the decode threads while the old data is still in place and
+	// drop its notifications, the replacement is connected afterwards
+	reset_decode();
+
+	SignalBase* const sb = qobject_cast<SignalBase*>(QObject::sender());
+	if (sb && sb->logic_data())
+		disconnect(sb->logic_data().get(), nullptr, this, SLOT(on_input_segment_completed()));
+}
+
+void DecodeSignal::on_input_data_changed()
+{
+	connect_input_notifiers();
+	begin_decode();
 }
 
 void DecodeSignal::on_annotation_visibility_changed()
@@ -1875,5 +2977,45 @@ void DecodeSignal::on_annotation_visibility_changed()
 	annotation_visibility_changed();
 }
 
+void DecodeSignal::on_notification_requested()
+{
+	if (notification_timer_.isActive())
+		return;
+
+	const int interval = get_notification_interval();
+
+	if (last_notification_.isValid() && (last_notification_.elapsed() < interval))
+		notification_timer_.start(interval - last_notification_.elapsed());
+	else
+		on_notification_timeout();
+}
+
+void DecodeSignal::on_notification_timeout()
+{
+	// Output that is stored from now on needs another notification
+	notification_pending_ = false;
+	last_notification_.start();
+
+	vector< pair<uint32_t, pair<int64_t, int64_t> > > dirty_ranges;
+	{
+		lock_guard<mutex> lock(output_mutex_);
+
+		for (uint32_t i = 0; i < segments_.size(); i++) {
+			DecodeSegment& segment = segments_[i];
+
+			if (segment.has_dirty_range) {
+				dirty_ranges.emplace_back(i,
+					make_pair(segment.dirty_start, segment.dirty_end));
+				segment.has_dirty_range = false;
+			}
+		}
+	}
+
+	for (const pair<uint32_t, pair<int64_t, int64_t> >& r : dirty_ranges)
+		annotations_updated(r.first, r.second.first, r.second.second);
+
+	new_annotations();
+}
+
 } // namespace data
 } // namespace pv
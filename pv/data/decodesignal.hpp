@@ -23,17 +23,25 @@
 #include <atomic>
 #include <deque>
 #include <condition_variable>
+#include <string>
 #include <unordered_set>
 #include <vector>
 
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QSettings>
+#include <QTimer>
 
 #include <libsigrokdecode/libsigrokdecode.h>
 
+#include <pv/data/decode/annotationspill.hpp>
+#include <pv/data/decode/binarydata.hpp>
 #include <pv/data/decode/decoder.hpp>
+#include <pv/data/decode/muxqueue.hpp>
+#include <pv/data/decode/profiler.hpp>
 #include <pv/data/decode/row.hpp>
 #include <pv/data/decode/rowdata.hpp>
+#include <pv/data/decode/textpool.hpp>
 #include <pv/data/signalbase.hpp>
 #include <pv/util.hpp>
 
@@ -42,6 +50,8 @@ using std::condition_variable;
 using std::deque;
 using std::map;
 using std::mutex;
+using std::pair;
+using std::string;
 using std::vector;
 using std::shared_ptr;
 
@@ -57,22 +67,20 @@ class Session;
 
 namespace data {
 
+namespace decode {
+class RemoteDecoder;
+}
+
 class Logic;
 class LogicSegment;
 class SignalBase;
 class SignalData;
 
-struct DecodeBinaryDataChunk
-{
-	vector<uint8_t> data;
-	uint64_t sample;   ///< Number of the sample where this data was provided by the PD
-};
-
 struct DecodeBinaryClass
 {
 	const Decoder* decoder;
 	const DecodeBinaryClassInfo* info;
-	deque<DecodeBinaryDataChunk> chunks;
+	decode::BinaryData data;
 };
 
 struct DecodeSegment
@@ -82,12 +90,29 @@ struct DecodeSegment
 	// Copy constructor is a no-op
 	DecodeSegment(DecodeSegment&& ds) { (void)ds; qCritical() << "Empty DecodeSegment copy constructor called"; };
 
+	// Holds the older annotation blocks of the rows if spilling is enabled
+	decode::AnnotationSpill annotation_spill;
+
 	map<const Row*, RowData> annotation_rows;  // Note: Row is the same for all segments while RowData is not
 	pv::util::Timestamp start_time;
 	double samplerate;
 	int64_t samples_decoded_incl, samples_decoded_excl;
 	vector<DecodeBinaryClass> binary_classes;
-	deque<const Annotation*> all_annotations;
+
+	// Set if only the decode range is decoded. The parts that have been
+	// decoded so far are kept sorted and don't overlap or touch
+	bool range_limited = false;
+	vector< pair<int64_t, int64_t> > decoded_ranges;
+
+	// Samples covered by the annotations that were added since the views
+	// were last notified
+	bool has_dirty_range = false;
+	int64_t dirty_start = 0, dirty_end = 0;
+
+	// Annotations of all rows, sorted by start sample and length. Built on
+	// demand by get_all_annotations_by_segment() as few views need it
+	mutable deque<Annotation> all_annotations;
+	mutable map<const RowData*, uint32_t> all_annotations_row_counts;
 };
 
 class DecodeSignal : public SignalBase
@@ -98,6 +123,61 @@ private:
 	static const double DecodeMargin;
 	static const double DecodeThreshold;
 	static const int64_t DecodeChunkLength;
+	static const unsigned int LogicMuxQueueLength;
+	static const unsigned int MaxDecodeWorkerCount;
+	static const unsigned int InProcessDecodeWorkerCount;
+	static const int64_t SplitMinRangeLength;
+	static const int64_t SplitScanBlockLength;
+	static const int64_t SplitIdleFactor;
+	static const uint64_t DecodeCacheMaxSize;
+	static const int64_t DecodeRangeMargin;
+	static const int MaxNotificationRate;
+
+	/**
+	 * Copy of an annotation that is stored later on, so that the output
+	 * mutex is taken once per batch of annotations instead of for each.
+	 */
+	struct PendingAnnotation
+	{
+		const srd_decoder* decoder;
+		uint64_t start_sample, end_sample;
+		int ann_class;
+		vector<string> texts;
+	};
+
+	struct SplitRangeBinaryData
+	{
+		const srd_decoder* decoder;
+		uint64_t start_sample;
+		int bin_class;
+		vector<uint8_t> data;
+	};
+
+	/**
+	 * Part of a segment that is decoded on its own when the segment is
+	 * split at idle gaps. The decoders see the samples as if the part was
+	 * all there is, i.e. numbered from 0, and its output is held back
+	 * until all parts before it have been stored.
+	 */
+	struct SplitRange
+	{
+		int64_t start_sample, end_sample;  ///< Samples to decode, including the overlap
+		int64_t keep_start, keep_end;      ///< Output that starts in here is kept
+		vector<PendingAnnotation> annotations;
+		vector<SplitRangeBinaryData> binary_data;
+	};
+
+	/**
+	 * Passed to the libsigrokdecode callbacks so that they know which
+	 * segment the output of a session belongs to.
+	 */
+	struct CallbackContext
+	{
+		DecodeSignal* decode_signal;
+		uint32_t segment_id;
+		SplitRange* split_range;  ///< Set if only a part of the segment is decoded
+		vector<PendingAnnotation> annotations;  ///< Stored once the decoders return
+	};
 
 public:
 	DecodeSignal(pv::Session &session);
@@ -126,6 +206,33 @@ public:
 	void resume_decode();
 	bool is_paused() const;
 
+	/**
+	 * Restricts decoding to the samples from @c start_sample up to
+	 * @c end_sample. The decoders start a little earlier so that they can
+	 * synchronize to the data. If nothing but decode ranges has been
+	 * decoded so far, the decoded parts are kept and only the parts of
+	 * the new range that are missing are decoded.
+	 */
+	void set_decode_range(int64_t start_sample, int64_t end_sample);
+	/**
+	 * Decodes the segments in full again, keeping what has been decoded
+	 * within the previous decode range.
+	 */
+	void clear_decode_range();
+	bool has_decode_range() const;
+
+	/**
+	 * Tells whether only parts of the segment have been decoded because
+	 * of a decode range.
+	 */
+	bool is_partially_decoded(uint32_t segment_id) const;
+	/**
+	 * Returns the sample ranges of the segment that have been decoded
+	 * within decode ranges, sorted by start sample. Empty if the segment
+	 * isn't decoded range by range.
+	 */
+	vector< pair<int64_t, int64_t> > get_decoded_ranges(uint32_t segment_id) const;
+
 	const vector<decode::DecodeChannel> get_channels() const;
 	void auto_assign_signals(const shared_ptr<Decoder> dec);
 	void assign_signal(const uint16_t channel_id, shared_ptr<const SignalBase> signal);
@@ -166,7 +273,7 @@ public:
 	 * Note: The annotations may be unsorted and only annotations that fully
 	 * fit into the sample range are considered.
 	 */
-	void get_annotation_subset(deque<const Annotation*> &dest, const Row* row,
+	void get_annotation_subset(deque<Annotation> &dest, const Row* row,
 		uint32_t segment_id, uint64_t start_sample, uint64_t end_sample) const;
 
 	/**
@@ -174,18 +281,26 @@ public:
 	 * Note: The annotations may be unsorted and only annotations that fully
 	 * fit into the sample range are considered.
 	 */
-	void get_annotation_subset(deque<const Annotation*> &dest, uint32_t segment_id,
+	void get_annotation_subset(deque<Annotation> &dest, uint32_t segment_id,
 		uint64_t start_sample, uint64_t end_sample) const;
 
 	uint32_t get_binary_data_chunk_count(uint32_t segment_id,
 		const Decoder* dec, uint32_t bin_class_id) const;
 	void get_binary_data_chunk(uint32_t segment_id, const Decoder* dec,
-		uint32_t bin_class_id, uint32_t chunk_id, const vector<uint8_t> **dest,
-		uint64_t *size);
+		uint32_t bin_class_id, uint32_t chunk_id, vector<uint8_t> *dest) const;
+
+	/**
+	 * Copies the binary data emitted at samples from @c start_sample up to
+	 * but not including @c end_sample.
+	 */
 	void get_merged_binary_data_chunks_by_sample(uint32_t segment_id,
 		const Decoder* dec, uint32_t bin_class_id,
 		uint64_t start_sample, uint64_t end_sample,
 		vector<uint8_t> *dest) const;
+	/**
+	 * Copies the bytes of binary data from offset @c start up to but not
+	 * including offset @c end.
+	 */
 	void get_merged_binary_data_chunks_by_offset(uint32_t segment_id,
 		const Decoder* dec, uint32_t bin_class_id,
 		uint64_t start, uint64_t end,
@@ -193,7 +308,22 @@ public:
 	const DecodeBinaryClass* get_binary_data_class(uint32_t segment_id,
 		const Decoder* dec, uint32_t bin_class_id) const;
 
-	const deque<const Annotation*>* get_all_annotations_by_segment(uint32_t segment_id) const;
+	/**
+	 * Returns the annotations of all rows, sorted by start sample and with
+	 * longer annotations first. Annotations that were added since the last
+	 * call are merged in first.
+	 */
+	const deque<Annotation>* get_all_annotations_by_segment(uint32_t segment_id) const;
+
+	/**
+	 * Returns where the time of the current or last decode run went.
+	 */
+	decode::Profiler::Snapshot get_profile() const;
+
+	/**
+	 * Returns the profile of get_profile() as a JSON object.
+	 */
+	string get_profile_json() const;
 
 	virtual void save_settings(QSettings &settings) const;
 
@@ -202,6 +332,13 @@ public:
 private:
 	bool all_input_segments_complete(uint32_t segment_id) const;
 	uint32_t get_input_segment_count() const;
+
+	/**
+	 * Returns the logic data that all assigned channels take their samples
+	 * from or nullptr if they use different ones. If there is such data,
+	 * the muxer is bypassed and its samples are passed on as they are.
+	 */
+	shared_ptr<Logic> get_shared_input_data() const;
 	double get_input_samplerate(uint32_t segment_id) const;
 
 	Decoder* get_decoder_by_instance(const srd_decoder *const srd_dec);
@@ -210,14 +347,110 @@ private:
 
 	void commit_decoder_channels();
 
-	void mux_logic_samples(uint32_t segment_id, const int64_t start, const int64_t end);
+	bool mux_logic_samples(uint32_t segment_id, const int64_t start,
+		const int64_t end, decode::MuxChunk* chunk);
 	void logic_mux_proc();
 
-	void decode_data(const int64_t abs_start_samplenum, const int64_t sample_count,
-		const shared_ptr<const LogicSegment> input_segment);
+	/**
+	 * Assigns the next input segment that no thread is working on yet to
+	 * the caller and creates its decode segment. If @c complete_only is
+	 * set, this only succeeds if the input segment is complete.
+	 */
+	bool claim_input_segment(uint32_t& segment_id, bool complete_only);
+	void finish_decode_segment();
+
+	/**
+	 * Passes the chunk on to the srd session or, if set, to the decoders
+	 * running in a worker process.
+	 */
+	void decode_data(CallbackContext* context, srd_session* session,
+		decode::RemoteDecoder* remote, const decode::MuxChunk* chunk);
+	void send_to_decoders(CallbackContext* context, srd_session* session,
+		decode::RemoteDecoder* remote, const decode::MuxChunk* chunk);
+	void send_eof_to_decoders(CallbackContext* context, srd_session* session,
+		decode::RemoteDecoder* remote);
+	void end_decode_segment(CallbackContext* context, srd_session* session,
+		decode::RemoteDecoder* remote);
+	void wait_while_paused();
 	void decode_proc();
+	void decode_worker_proc();
+
+	/**
+	 * Splits the segment in the middle of idle gaps of the input signals,
+	 * i.e. where protocols like UART or I2C resynchronize. Every range
+	 * overlaps the neighbouring gaps so that the decoders see the bus
+	 * idle before and after the data. Returns at most @c max_range_count
+	 * ranges, or none if the segment is too short or lacks suitable gaps.
+	 */
+	vector<SplitRange> find_split_ranges(uint32_t segment_id,
+		unsigned int max_range_count) const;
+	/**
+	 * Fetches the logic segments and bit indices of all assigned channels.
+	 * Returns false if a channel lacks the segment.
+	 */
+	bool get_input_segments(uint32_t segment_id,
+		vector< pair<shared_ptr<LogicSegment>, int> >& inputs) const;
+	/**
+	 * Finds the longest stretch between start and end in which none of the
+	 * inputs change and tells whether it's long enough to be an idle gap
+	 * of the bus.
+	 */
+	static bool find_idle_gap(const vector< pair<shared_ptr<LogicSegment>, int> >& inputs,
+		int64_t start, int64_t end, int64_t& gap_start, int64_t& gap_end);
+
+	/**
+	 * Decodes the ranges of a complete segment in parallel and stores
+	 * their output in order, so that the result is the same as if the
+	 * segment was decoded in one go. Returns false if the segment
+	 * couldn't be split.
+	 */
+	bool decode_split_segment(uint32_t segment_id);
+	void decode_split_range(uint32_t segment_id, SplitRange* range);
+	void commit_split_range(uint32_t segment_id, SplitRange& range);
+
+	/**
+	 * Decodes the parts of the decode range that are missing in the
+	 * segment. Each part is decoded on its own, beginning and ending in
+	 * idle gaps of the input signals close to it where possible.
+	 */
+	void decode_segment_range(uint32_t segment_id);
+	/**
+	 * Changes the decode range and restarts the decode threads, so that
+	 * they decode the parts of the range that haven't been decoded yet.
+	 * If the segments weren't decoded range by range, decoding starts over.
+	 */
+	void apply_decode_range(bool range_set, int64_t start_sample,
+		int64_t end_sample);
+
+	/**
+	 * Returns a hash of everything the output of the decoders depends on:
+	 * the input segments, the decoder stack and the decoders' versions, the
+	 * decoder options and the channel assignments. Returns an empty array
+	 * if an input segment is missing or not complete.
+	 */
+	QByteArray get_cache_key(uint32_t segment_id);
+	/**
+	 * Fills the decode segment with the output found in the decode cache.
+	 * Returns false if there is no usable cache file for the key.
+	 */
+	bool load_cached_segment(uint32_t segment_id, const QByteArray& key);
+	void save_cached_segment(uint32_t segment_id, const QByteArray& key);
+
+	void start_decode_threads(bool has_logic_output);
+	void stop_decode_threads();
+
+	/**
+	 * Takes up to @c count threads from the budget that the decode workers
+	 * share with the threads decoding the parts of split segments.
+	 * @return The number of threads taken, which may be less than @c count.
+	 */
+	unsigned int take_decode_threads(unsigned int count);
+	void return_decode_threads(unsigned int count);
 
 	void start_srd_session();
+	srd_session* create_worker_srd_session(CallbackContext* context);
+	decode::RemoteDecoder* create_remote_decoder(CallbackContext* context);
+	void handle_remote_decoder_error(const decode::RemoteDecoder* remote);
 	void terminate_srd_session();
 	void stop_srd_session();
 
@@ -226,14 +459,40 @@ private:
 
 	void create_decode_segment();
 
-	static void annotation_callback(srd_proto_data *pdata, void *decode_signal);
-	static void binary_callback(srd_proto_data *pdata, void *decode_signal);
-	static void logic_output_callback(srd_proto_data *pdata, void *decode_signal);
+	/**
+	 * Stores the annotations that were held back in one go and clears
+	 * the list.
+	 */
+	void store_pending_annotations(uint32_t segment_id,
+		vector<PendingAnnotation>& annotations);
+
+	/**
+	 * Adds an annotation to the segment. The output mutex must be held.
+	 */
+	void store_annotation(uint32_t segment_id, const srd_decoder* srd_dec,
+		srd_proto_data *pdata);
+	void store_binary_data(uint32_t segment_id, const srd_decoder* srd_dec,
+		uint64_t start_sample, int bin_class_id, const uint8_t* data, uint64_t size);
+
+	/**
+	 * Lets the views know that decoding progressed. May be called by any
+	 * thread as often as needed: the notifications are coalesced and
+	 * delivered by the UI thread no more often than the display refreshes.
+	 */
+	void notify_new_annotations();
+	int get_notification_interval() const;
+
+	static void annotation_callback(srd_proto_data *pdata, void *context);
+	static void binary_callback(srd_proto_data *pdata, void *context);
+	static void logic_output_callback(srd_proto_data *pdata, void *context);
 
 Q_SIGNALS:
 	void decoder_stacked(void* decoder); ///< decoder is of type decode::Decoder*
 	void decoder_removed(void* decoder); ///< decoder is of type decode::Decoder*
-	void new_annotations(); // TODO Supply segment for which they belong to
+	void new_annotations();  ///< Decoding progressed, possibly adding annotations
+	/// Annotations were added to the segment within the given sample range
+	void annotations_updated(unsigned int segment_id, uint64_t start_sample,
+		uint64_t end_sample);
 	void new_binary_data(unsigned int segment_id, void* decoder, unsigned int bin_class_id);
 	void decode_reset();
 	void decode_finished();
@@ -245,35 +504,59 @@ private Q_SLOTS:
 	void on_data_cleared();
 	void on_data_received();
 	void on_input_segment_completed();
+	void on_input_data_about_to_change();
+	void on_input_data_changed();
 
 	void on_annotation_visibility_changed();
 
+	void on_notification_requested();
+	void on_notification_timeout();
+
 private:
 	pv::Session &session_;
 
 	vector<decode::DecodeChannel> channels_;
 
 	struct srd_session *srd_session_;
+	CallbackContext main_callback_context_;
 
-	shared_ptr<Logic> logic_mux_data_;
 	uint32_t logic_mux_unit_size_;
-	bool logic_mux_data_invalid_;
+	bool logic_mux_bypassed_;  ///< Input samples are passed on without muxing
+	decode::MuxQueue logic_mux_queue_;
 
 	vector< shared_ptr<Decoder> > stack_;
 	bool stack_config_changed_;
+	bool decode_out_of_process_;  ///< Decoders run in worker processes
+	bool decode_split_segments_;  ///< Complete segments are split at idle gaps
+	bool decode_cache_enabled_;   ///< Output of complete segments is cached on disk
+	bool decode_spill_annotations_;  ///< Older annotations are moved to disk
+	bool decode_range_set_;       ///< Only the decode range is to be decoded
+	bool decode_ranged_;          ///< Segments are decoded range by range
+	int64_t decode_range_start_, decode_range_end_;
 
 	deque<DecodeSegment> segments_;
-	uint32_t current_segment_id_;
+	decode::TextPool annotation_texts_;  ///< Shared by all rows and segments
+	uint32_t current_segment_id_;  ///< Segment the main srd session works on
+	uint32_t next_input_segment_, decoded_segment_count_;
 
-	mutable mutex input_mutex_, output_mutex_, decode_pause_mutex_, logic_mux_mutex_;
-	mutable condition_variable decode_input_cond_, decode_pause_cond_,
-		logic_mux_cond_;
+	decode::Profiler profiler_;
+
+	mutable mutex output_mutex_, decode_pause_mutex_, logic_mux_mutex_,
+		decode_worker_mutex_;
+	mutable condition_variable decode_pause_cond_, logic_mux_cond_,
+		decode_worker_cond_;
 
 	std::thread decode_thread_, logic_mux_thread_;
+	vector<std::thread> decode_workers_;
+	unsigned int decode_thread_budget_;  ///< Guarded by decode_worker_mutex_
 	atomic<bool> decode_interrupt_, logic_mux_interrupt_;
 
 	bool decode_paused_;
 
+	atomic<bool> notification_pending_;
+	QTimer notification_timer_;
+	QElapsedTimer last_notification_;
+
 	map<const srd_decoder*, shared_ptr<Logic>> output_logic_;
 	map<const srd_decoder*, vector<uint8_t>> output_logic_muxed_data_;
 	vector< shared_ptr<SignalBase>> output_signals_;
@@ -161,7 +161,7 @@ void LogicSegment::downsampleT(const uint8_t *in_, uint8_t *&out_, uint64_t len)
 			last_append_extra_++;
 			len--;
 		}
-		if (!len) {
+		if (last_append_extra_ < MipMapScaleFactor) {
 			// Not enough samples available to complete downsample
 			last_append_sample_ = prev;
 			last_append_accumulator_ = acc;
@@ -214,7 +214,7 @@ void LogicSegment::downsampleGeneric(const uint8_t *in, uint8_t *&out, uint64_t
 			last_append_extra_++;
 			len--;
 		}
-		if (!len) {
+		if (last_append_extra_ < MipMapScaleFactor) {
 			// Not enough samples available to complete downsample
 			last_append_sample_ = prev;
 			last_append_accumulator_ = acc;
@@ -363,6 +363,33 @@ void LogicSegment::append_payload(void *data, uint64_t data_size)
 			prev_sample_count + 1, prev_sample_count + 1);
 }
 
+void LogicSegment::append_repeated_payload(const void *sample, uint64_t count)
+{
+	assert(unit_size_ > 0);
+
+	if (count == 0)
+		return;
+
+	lock_guard<recursive_mutex> lock(mutex_);
+
+	const uint64_t prev_sample_count = sample_count_;
+
+	append_repeated_samples(sample, count);
+
+	// unpack_sample() may read a whole uint64_t, so don't let it read
+	// beyond the sample
+	uint8_t padded_sample[sizeof(uint64_t)] = {0};
+	memcpy(padded_sample, sample, min(unit_size_, (unsigned int)sizeof(uint64_t)));
+	append_repeated_sample_to_mipmap(unpack_sample(padded_sample), count);
+
+	if (count > 1)
+		owner_.notify_samples_added(SharedPtrToSegment(shared_from_this()),
+			prev_sample_count + 1, prev_sample_count + 1 + count);
+	else
+		owner_.notify_samples_added(SharedPtrToSegment(shared_from_this()),
+			prev_sample_count + 1, prev_sample_count + 1);
+}
+
 void LogicSegment::append_subsignal_payload(unsigned int index, void *data,
 	uint64_t data_size, vector<uint8_t>& destination)
 {
@@ -634,25 +661,26 @@ void LogicSegment::append_payload_to_mipmap()
 	uint64_t prev_length;
 	uint8_t *dest_ptr;
 	SegmentDataIterator* it;
-	uint64_t accumulator;
-	unsigned int diff_counter;
 
 	// Expand the data buffer to fit the new samples
 	prev_length = m0.length;
 	m0.length = sample_count_ / MipMapScaleFactor;
 
+	// The samples of an incomplete downsample are accumulated as well,
+	// so that runs appended by append_repeated_payload() can continue it
+	const uint64_t start_sample = prev_length * MipMapScaleFactor + last_append_extra_;
+	uint64_t len_sample = sample_count_ - start_sample;
+
 	// Break off if there are no new samples to compute
-	if (m0.length == prev_length)
+	if (len_sample == 0)
 		return;
 
-	reallocate_mipmap_level(m0);
+	if (m0.length > prev_length)
+		reallocate_mipmap_level(m0);
 
 	dest_ptr = (uint8_t*)m0.data + prev_length * unit_size_;
 
 	// Iterate through the samples to populate the first level mipmap
-	const uint64_t start_sample = prev_length * MipMapScaleFactor;
-	const uint64_t end_sample = m0.length * MipMapScaleFactor;
-	uint64_t len_sample = end_sample - start_sample;
 	it = begin_sample_iteration(start_sample);
 	while (len_sample > 0) {
 		// Number of samples available in this chunk
@@ -677,7 +705,77 @@ void LogicSegment::append_payload_to_mipmap()
 	}
 	end_sample_iteration(it);
 
-	// Compute higher level mipmaps
+	if (m0.length > prev_length)
+		append_to_higher_mipmap_levels();
+}
+
+void LogicSegment::append_repeated_sample_to_mipmap(uint64_t value, uint64_t count)
+{
+	MipMapLevel &m0 = mip_map_[0];
+	uint64_t prev = last_append_sample_;
+	uint64_t acc = last_append_accumulator_;
+
+	const uint64_t prev_length = m0.length;
+	m0.length = sample_count_ / MipMapScaleFactor;
+
+	if (m0.length > prev_length)
+		reallocate_mipmap_level(m0);
+
+	uint8_t *dest_ptr = (uint8_t*)m0.data + prev_length * unit_size_;
+
+	// Only the first sample of the run can differ from its predecessor,
+	// so the first downsample it contributes to takes up that change and
+	// all further ones are 0
+	if (last_append_extra_) {
+		const uint64_t n = min(count, MipMapScaleFactor - last_append_extra_);
+		acc |= prev ^ value;
+		prev = value;
+		last_append_extra_ += n;
+		count -= n;
+
+		if (last_append_extra_ < MipMapScaleFactor) {
+			last_append_sample_ = prev;
+			last_append_accumulator_ = acc;
+			return;
+		}
+
+		// We have a complete downsample
+		pack_sample(dest_ptr, acc);
+		dest_ptr += unit_size_;
+		acc = 0;
+		last_append_extra_ = 0;
+	}
+
+	const uint64_t block_count = count / MipMapScaleFactor;
+	if (block_count > 0) {
+		pack_sample(dest_ptr, prev ^ value);
+		memset(dest_ptr + unit_size_, 0, (block_count - 1) * unit_size_);
+		dest_ptr += block_count * unit_size_;
+		prev = value;
+		count -= block_count * MipMapScaleFactor;
+	}
+
+	// Remainder, not enough for a complete downsample
+	if (count > 0) {
+		acc |= prev ^ value;
+		prev = value;
+		last_append_extra_ += count;
+	}
+
+	last_append_sample_ = prev;
+	last_append_accumulator_ = acc;
+
+	if (m0.length > prev_length)
+		append_to_higher_mipmap_levels();
+}
+
+void LogicSegment::append_to_higher_mipmap_levels()
+{
+	uint64_t prev_length;
+	uint8_t *dest_ptr;
+	uint64_t accumulator;
+	unsigned int diff_counter;
+
 	for (unsigned int level = 1; level < ScaleStepCount; level++) {
 		MipMapLevel &m = mip_map_[level];
 		const MipMapLevel &ml = mip_map_[level - 1];
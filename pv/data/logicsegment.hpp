@@ -43,6 +43,10 @@ struct Pulses;
 struct LongPulses;
 }
 
+namespace LogicSegmentRunTest {
+struct RepeatedPayload;
+}
+
 namespace pv {
 namespace data {
 
@@ -86,6 +90,14 @@ public:
 	void append_payload(shared_ptr<sigrok::Logic> logic);
 	void append_payload(void *data, uint64_t data_size);
 
+	/**
+	 * Appends @c count samples that all have the value of @c sample,
+	 * as decoders provide logic output. The samples are written to the
+	 * chunks directly and the mip-map entries of the run are set without
+	 * looking at the samples.
+	 */
+	void append_repeated_payload(const void *sample, uint64_t count);
+
 	/**
 	 * Appends sample data for a single channel where each byte
 	 * represents one sample - if it's 0 the state is low, if 1 high.
@@ -125,6 +137,8 @@ private:
 	void reallocate_mipmap_level(MipMapLevel &m);
 
 	void append_payload_to_mipmap();
+	void append_repeated_sample_to_mipmap(uint64_t value, uint64_t count);
+	void append_to_higher_mipmap_levels();
 
 	uint64_t get_unpacked_sample(uint64_t index) const;
 
@@ -150,6 +164,7 @@ private:
 	friend struct LogicSegmentTest::LargeData;
 	friend struct LogicSegmentTest::Pulses;
 	friend struct LogicSegmentTest::LongPulses;
+	friend struct LogicSegmentRunTest::RepeatedPayload;
 };
 
 } // namespace data
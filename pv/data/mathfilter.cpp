@@ -0,0 +1,288 @@
+/*
+ * This file is part of the PulseView project.
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+#include "mathfilter.hpp"
+
+using std::copy;
+using std::fill;
+using std::max;
+using std::min;
+using std::numeric_limits;
+using std::reverse;
+
+namespace pv {
+namespace data {
+
+const unsigned int MathFilter::MaxTaps = 4095;
+const unsigned int MathFilter::MaxAverageLength = 1024 * 1024;
+
+/// Number of output samples that are kept in the cache while convolving
+static const size_t FIRRunLength = 1024;
+
+MathFilter::MathFilter(Type type, double samplerate, double param1,
+	double param2, double param3) :
+	type_(type),
+	samplerate_(samplerate),
+	param1_(param1),
+	param2_(param2),
+	param3_(param3),
+	history_length_(0),
+	b0_(1), b1_(0), b2_(0), a1_(0), a2_(0),
+	z1_(0), z2_(0)
+{
+	switch (type_) {
+	case MovingAverage:
+		param1_ = min(max(round(param1_), 1.0), (double)MaxAverageLength);
+		history_length_ = param1_ - 1;
+		break;
+	case FIRLowpass:
+	case FIRHighpass:
+	case FIRBandpass:
+		design_fir();
+		history_length_ = taps_.size() - 1;
+		break;
+	case IIRLowpass:
+	case IIRHighpass:
+	case IIRBandpass:
+		design_iir();
+		break;
+	}
+
+	reset();
+}
+
+MathFilter::Type MathFilter::type() const
+{
+	return type_;
+}
+
+uint64_t MathFilter::history_length() const
+{
+	if ((type_ == IIRLowpass) || (type_ == IIRHighpass) || (type_ == IIRBandpass))
+		return numeric_limits<uint64_t>::max();
+
+	return history_length_;
+}
+
+void MathFilter::reset()
+{
+	window_.assign(history_length_, 0);
+	z1_ = z2_ = 0;
+}
+
+void MathFilter::process(const float* input, float* output, size_t count)
+{
+	switch (type_) {
+	case MovingAverage:
+		process_moving_average(input, output, count);
+		break;
+	case FIRLowpass:
+	case FIRHighpass:
+	case FIRBandpass:
+		process_fir(input, output, count);
+		break;
+	case IIRLowpass:
+	case IIRHighpass:
+	case IIRBandpass:
+		process_iir(input, output, count);
+		break;
+	}
+}
+
+void MathFilter::design_fir_lowpass(vector<float> &taps, double cutoff) const
+{
+	// Windowed sinc with a Hamming window, normalized to unity gain at DC
+	const double fc = min(max(cutoff / samplerate_, 0.0), 0.5);
+	const size_t length = taps.size();
+	const double center = (length - 1) / 2.0;
+
+	double sum = 0;
+	for (size_t i = 0; i < length; i++) {
+		const double m = i - center;
+		double h = (m == 0) ? (2 * fc) : (sin(2 * M_PI * fc * m) / (M_PI * m));
+
+		if (length > 1)
+			h *= 0.54 - 0.46 * cos(2 * M_PI * i / (length - 1));
+
+		taps[i] = h;
+		sum += h;
+	}
+
+	if (sum != 0)
+		for (float& tap : taps)
+			tap /= sum;
+}
+
+void MathFilter::design_fir()
+{
+	const double tap_count = (type_ == FIRBandpass) ? param3_ : param2_;
+
+	// High- and bandpass filters are derived from lowpass filters by
+	// spectral inversion, which requires an odd number of taps
+	size_t length = min(max(round(tap_count), 1.0), (double)MaxTaps);
+	if (type_ != FIRLowpass)
+		length |= 1;
+
+	vector<float> taps(length);
+
+	if (type_ == FIRLowpass)
+		design_fir_lowpass(taps, param1_);
+
+	if (type_ == FIRHighpass) {
+		design_fir_lowpass(taps, param1_);
+		for (float& tap : taps)
+			tap = -tap;
+		taps[length / 2] += 1;
+	}
+
+	if (type_ == FIRBandpass) {
+		vector<float> lower(length);
+		design_fir_lowpass(lower, min(param1_, param2_));
+		design_fir_lowpass(taps, max(param1_, param2_));
+		for (size_t i = 0; i < length; i++)
+			taps[i] -= lower[i];
+	}
+
+	reverse(taps.begin(), taps.end());
+	taps_ = taps;
+}
+
+void MathFilter::design_iir()
+{
+	// Biquad coefficients as per the Audio EQ Cookbook by R. Bristow-Johnson
+	const double f0 = min(max(param1_, samplerate_ * 1e-6), samplerate_ * 0.499);
+	const double q = (param2_ > 0) ? param2_ : M_SQRT1_2;
+
+	const double w0 = 2 * M_PI * f0 / samplerate_;
+	const double cos_w0 = cos(w0);
+	const double alpha = sin(w0) / (2 * q);
+
+	double b0 = 1, b1 = 0, b2 = 0;
+
+	switch (type_) {
+	case IIRLowpass:
+		b0 = (1 - cos_w0) / 2;
+		b1 = 1 - cos_w0;
+		b2 = (1 - cos_w0) / 2;
+		break;
+	case IIRHighpass:
+		b0 = (1 + cos_w0) / 2;
+		b1 = -(1 + cos_w0);
+		b2 = (1 + cos_w0) / 2;
+		break;
+	case IIRBandpass:
+		// Constant 0 dB peak gain
+		b0 = alpha;
+		b1 = 0;
+		b2 = -alpha;
+		break;
+	default:
+		assert(false);
+	}
+
+	const double a0 = 1 + alpha;
+
+	b0_ = b0 / a0;
+	b1_ = b1 / a0;
+	b2_ = b2 / a0;
+	a1_ = (-2 * cos_w0) / a0;
+	a2_ = (1 - alpha) / a0;
+}
+
+void MathFilter::process_fir(const float* input, float* output, size_t count)
+{
+	const size_t tap_count = taps_.size();
+	const float* const taps = taps_.data();
+
+	window_.resize(history_length_ + count);
+	copy(input, input + count, window_.begin() + history_length_);
+
+	// The convolution is done tap by tap for a run of output samples at a
+	// time. The output samples are independent of each other, so the inner
+	// loop can be vectorized by the compiler without reordering additions
+	const float* const window = window_.data();
+	for (size_t run_start = 0; run_start < count; run_start += FIRRunLength) {
+		const size_t run_length = min(count - run_start, FIRRunLength);
+		float* const out = output + run_start;
+
+		fill(out, out + run_length, 0.0f);
+
+		for (size_t k = 0; k < tap_count; k++) {
+			const float tap = taps[k];
+			const float* const x = window + run_start + k;
+
+			for (size_t i = 0; i < run_length; i++)
+				out[i] += tap * x[i];
+		}
+	}
+
+	// Keep the most recent samples for the next block
+	copy(window_.end() - history_length_, window_.end(), window_.begin());
+	window_.resize(history_length_);
+}
+
+void MathFilter::process_moving_average(const float* input, float* output, size_t count)
+{
+	const size_t length = history_length_ + 1;
+
+	window_.resize(history_length_ + count);
+	copy(input, input + count, window_.begin() + history_length_);
+
+	// The sum is rebuilt for every block so that rounding errors of the
+	// running sum can't accumulate over the entire stream
+	double sum = 0;
+	for (size_t i = 0; i < history_length_; i++)
+		sum += window_[i];
+
+	for (size_t i = 0; i < count; i++) {
+		sum += window_[i + history_length_];
+		output[i] = sum / length;
+		sum -= window_[i];
+	}
+
+	copy(window_.end() - history_length_, window_.end(), window_.begin());
+	window_.resize(history_length_);
+}
+
+void MathFilter::process_iir(const float* input, float* output, size_t count)
+{
+	// Direct form II transposed
+	double z1 = z1_, z2 = z2_;
+
+	for (size_t i = 0; i < count; i++) {
+		const double x = input[i];
+		const double y = b0_ * x + z1;
+
+		z1 = b1_ * x - a1_ * y + z2;
+		z2 = b2_ * x - a2_ * y;
+
+		output[i] = y;
+	}
+
+	z1_ = z1;
+	z2_ = z2;
+}
+
+} // namespace data
+} // namespace pv
@@ -0,0 +1,118 @@
+/*
+ * This file is part of the PulseView project.
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PULSEVIEW_PV_DATA_MATHFILTER_HPP
+#define PULSEVIEW_PV_DATA_MATHFILTER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using std::vector;
+
+namespace pv {
+namespace data {
+
+/**
+ * A causal filter that processes a stream of samples block by block.
+ * The state carried over from one block to the next is kept internally,
+ * so feeding a signal in several blocks yields the same output as feeding
+ * it in one go.
+ */
+class MathFilter
+{
+public:
+	enum Type {
+		MovingAverage,
+		FIRLowpass,
+		FIRHighpass,
+		FIRBandpass,
+		IIRLowpass,
+		IIRHighpass,
+		IIRBandpass
+	};
+
+	static const unsigned int MaxTaps;
+	static const unsigned int MaxAverageLength;
+
+public:
+	/**
+	 * Creates a filter.
+	 *
+	 * @param type The kind of filter.
+	 * @param samplerate The sample rate of the input signal in Hz.
+	 * @param param1 MovingAverage: window length in samples.
+	 *        FIR and IIR: corner or center frequency in Hz.
+	 *        FIRBandpass: lower corner frequency in Hz.
+	 * @param param2 FIR: number of taps, IIR: quality factor (1/sqrt(2)
+	 *        if not positive).
+	 *        FIRBandpass: upper corner frequency in Hz.
+	 * @param param3 FIRBandpass: number of taps.
+	 */
+	MathFilter(Type type, double samplerate, double param1,
+		double param2 = 0, double param3 = 0);
+
+	Type type() const;
+
+	/**
+	 * Returns the number of preceding input samples that influence an
+	 * output sample. IIR filters depend on all preceding samples, for them
+	 * the maximum value of uint64_t is returned.
+	 */
+	uint64_t history_length() const;
+
+	/**
+	 * Clears the filter state as if no samples had been processed yet.
+	 */
+	void reset();
+
+	/**
+	 * Filters the next @c count samples of the stream.
+	 */
+	void process(const float* input, float* output, size_t count);
+
+private:
+	void design_fir_lowpass(vector<float> &taps, double cutoff) const;
+	void design_fir();
+	void design_iir();
+
+	void process_fir(const float* input, float* output, size_t count);
+	void process_moving_average(const float* input, float* output, size_t count);
+	void process_iir(const float* input, float* output, size_t count);
+
+private:
+	const Type type_;
+	const double samplerate_;
+	double param1_, param2_, param3_;
+
+	/// FIR taps in reverse order so that the convolution runs forward
+	vector<float> taps_;
+
+	/// Input samples preceding the next block followed by the next block
+	vector<float> window_;
+	size_t history_length_;
+
+	double b0_, b1_, b2_, a1_, a2_;    ///< Normalized biquad coefficients
+	double z1_, z2_;                   ///< Biquad state
+};
+
+} // namespace data
+} // namespace pv
+
+#endif // PULSEVIEW_PV_DATA_MATHFILTER_HPP
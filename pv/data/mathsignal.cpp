@@ -17,21 +17,29 @@
  * along with this program; if not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+#include <deque>
 #include <limits>
 
 #include <QDebug>
 
+#include "mathfilter.hpp"
 #include "mathsignal.hpp"
 
 #include <extdef.h>
 #include <pv/globalsettings.hpp>
 #include <pv/session.hpp>
 #include <pv/data/analogsegment.hpp>
+#include <pv/data/logicsegment.hpp>
 #include <pv/data/signalbase.hpp>
 
-using std::dynamic_pointer_cast;
+using std::copy;
+using std::equal;
+using std::lock_guard;
 using std::make_shared;
 using std::min;
+using std::none_of;
+using std::static_pointer_cast;
 using std::unique_lock;
 
 namespace pv {
@@ -44,6 +52,7 @@ namespace data {
 #define MATH_ERR_ENABLE         4
 
 const int64_t MathSignal::ChunkLength = 256 * 1024;
+const uint64_t MathSignal::SampleWindowLength = 64 * 1024;
 
 
 template<typename T>
@@ -90,12 +99,225 @@ struct fnc_sample : public exprtk::igeneric_function<T>
 };
 
 
+struct filter_state
+{
+	filter_state(const std::string& _name, const void* const* _call_site,
+		const double* _params, const shared_ptr<SignalBase> sb,
+		const MathFilter& _filter) :
+		name(_name),
+		input(sb),
+		filter(_filter),
+		segment_id(0),
+		next_sample(0),
+		output_start(0)
+	{
+		copy(_call_site, _call_site + 3, call_site);
+		copy(_params, _params + 3, params);
+	}
+
+	const std::string name;
+	const void* call_site[3];  ///< Where exprtk keeps the parameters of the call
+	double params[3];
+
+	signal_data input;
+	MathFilter filter;
+
+	uint32_t segment_id;
+	uint64_t next_sample;  ///< Next input sample to feed to the filter
+	uint64_t output_start;
+	vector<float> output;  ///< Most recently filtered block
+};
+
+
+template<typename T>
+struct fnc_filter : public exprtk::igeneric_function<T>
+{
+	typedef typename exprtk::igeneric_function<T>::parameter_list_t parameter_list_t;
+	typedef typename exprtk::igeneric_function<T>::generic_type generic_type;
+	typedef typename generic_type::scalar_view scalar_t;
+	typedef typename generic_type::string_view string_t;
+
+	fnc_filter(MathSignal& owner, const char* name, MathFilter::Type type,
+		const char* parameter_sequence) :
+		exprtk::igeneric_function<T>(parameter_sequence),
+		owner_(owner),
+		name_(name),
+		type_(type),
+		current_segment(0)
+	{
+	}
+
+	T operator()(parameter_list_t parameters)
+	{
+		const string_t exprtk_sig_name = string_t(parameters[0]);
+
+		// exprtk stores the value of each parameter at an address that is
+		// specific to the call (or to the variable passed), so it tells the
+		// call sites apart and every call site keeps one filter state
+		const void* call_site[3] = {nullptr, nullptr, nullptr};
+		double params[3] = {0, 0, 0};
+		for (size_t i = 1; (i < parameters.size()) && (i <= 3); i++) {
+			call_site[i - 1] = parameters[i].data;
+			params[i - 1] = scalar_t(parameters[i])();
+		}
+
+		filter_state* state = find_state(exprtk_sig_name, call_site);
+
+		if (state && !equal(params, params + 3, state->params)) {
+			// The filter would have to start over for every new set of
+			// parameters, so they can't depend on the sample
+			if (owner_.error_type_ == MATH_ERR_NONE)
+				owner_.set_error(MATH_ERR_EXPRESSION,
+					QString(MathSignal::tr("The parameters of %1() must be constant"))
+					.arg(name_));
+			return 0;
+		}
+
+		if (!state) {
+			const std::string str_sig_name = to_str(exprtk_sig_name);
+			signal_data* sig_data = owner_.signal_from_name(str_sig_name);
+
+			if (!sig_data)
+				// There doesn't actually exist a signal with that name
+				return 0;
+
+			const MathFilter filter(type_, sig_data->sb->analog_data()->get_samplerate(),
+				params[0], params[1], params[2]);
+
+			states_.push_back(make_shared<filter_state>(str_sig_name, call_site,
+				params, sig_data->sb, filter));
+			state = states_.back().get();
+		}
+
+		return T(filtered_sample(state, (uint64_t)owner_.exprtk_current_sample_));
+	}
+
+	filter_state* find_state(const string_t& sig_name, const void* const* call_site) const
+	{
+		for (const shared_ptr<filter_state>& state : states_)
+			if ((state->name.size() == sig_name.size()) &&
+				equal(sig_name.begin(), sig_name.end(), state->name.begin()) &&
+				equal(call_site, call_site + 3, state->call_site))
+				return state.get();
+
+		return nullptr;
+	}
+
+	float filtered_sample(filter_state* state, uint64_t sample_num)
+	{
+		if (state->segment_id != current_segment) {
+			state->filter.reset();
+			state->segment_id = current_segment;
+			state->next_sample = 0;
+			state->output.clear();
+		}
+
+		if ((sample_num >= state->output_start) &&
+			(sample_num < state->output_start + state->output.size()))
+			return state->output[sample_num - state->output_start];
+
+		const shared_ptr<Analog> analog = state->input.sb->analog_data();
+		if (!analog || (current_segment >= analog->analog_segments().size()))
+			return 0;
+
+		const uint64_t available_samples =
+			analog->analog_segments().at(current_segment)->get_sample_count();
+		if (sample_num >= available_samples)
+			return 0;
+
+		// If we have to go back or skip ahead further than the filter
+		// remembers, restart it just early enough to produce the same output
+		const uint64_t history = state->filter.history_length();
+		if ((sample_num < state->next_sample) ||
+			(sample_num - state->next_sample > history)) {
+			state->filter.reset();
+			state->next_sample = (history == numeric_limits<uint64_t>::max()) ?
+				0 : (sample_num - min(sample_num, history));
+		}
+
+		// Filter whole blocks of input samples at once. As far as the input
+		// is available, this reaches well ahead of the requested sample
+		do {
+			const uint64_t start = state->next_sample;
+			const uint64_t count =
+				min(available_samples - start, (uint64_t)MathSignal::ChunkLength);
+
+			owner_.fetch_signal_block(&(state->input), current_segment, start, count);
+
+			state->output.resize(count);
+			state->filter.process(state->input.block.data(), state->output.data(), count);
+
+			state->output_start = start;
+			state->next_sample = start + count;
+		} while (sample_num >= state->next_sample);
+
+		return state->output[sample_num - state->output_start];
+	}
+
+	MathSignal& owner_;
+	const char* const name_;
+	const MathFilter::Type type_;
+	uint32_t current_segment;
+	vector< shared_ptr<filter_state> > states_;  ///< One per call site
+};
+
+
+static const struct {
+	const char* name;
+	MathFilter::Type type;
+	const char* parameter_sequence;
+} filter_functions[] = {
+	{"movavg",       MathFilter::MovingAverage, "ST"},    // Signal, length
+	{"fir_lowpass",  MathFilter::FIRLowpass,    "STT"},   // Signal, cutoff, taps
+	{"fir_highpass", MathFilter::FIRHighpass,   "STT"},   // Signal, cutoff, taps
+	{"fir_bandpass", MathFilter::FIRBandpass,   "STTT"},  // Signal, low, high, taps
+	{"iir_lowpass",  MathFilter::IIRLowpass,    "STT"},   // Signal, cutoff, Q
+	{"iir_highpass", MathFilter::IIRHighpass,   "STT"},   // Signal, cutoff, Q
+	{"iir_bandpass", MathFilter::IIRBandpass,   "STT"},   // Signal, center, Q
+};
+
+static bool is_filter_function(const std::string& name)
+{
+	for (const auto& entry : filter_functions)
+		if (name == entry.name)
+			return true;
+
+	return false;
+}
+
+
+struct expression_instance
+{
+	expression_instance() :
+		current_time(0), current_sample(0),
+		pending(false), segment_id(0), start_sample(0)
+	{
+	}
+
+	exprtk::symbol_table<double> input_symbol_table, symbol_table;
+	exprtk::expression<double> expression;
+	double current_time, current_sample;
+	map<std::string, signal_data> inputs;
+
+	bool pending;  ///< The chunk below is yet to be evaluated by a worker
+	uint32_t segment_id;
+	uint64_t start_sample;
+	vector<float> output;
+};
+
+
 MathSignal::MathSignal(pv::Session &session) :
 	SignalBase(nullptr, SignalBase::MathChannel),
 	session_(session),
 	use_custom_sample_rate_(false),
 	use_custom_sample_count_(false),
+	expression_is_stateless_(false),
+	gen_workers_busy_(0),
+	gen_workers_exit_(false),
 	expression_(""),
+	output_type_(AnalogOutput),
+	analog_output_(make_shared<Analog>()),
+	logic_output_(make_shared<Logic>(1)),  // Contains only one channel
 	error_type_(MATH_ERR_NONE),
 	exprtk_unknown_symbol_table_(nullptr),
 	exprtk_symbol_table_(nullptr),
@@ -107,7 +329,7 @@ MathSignal::MathSignal(pv::Session &session) :
 	set_name(QString(tr("Math%1")).arg(sig_idx));
 	set_color(AnalogSignalColors[(sig_idx - 1) % countof(AnalogSignalColors)]);
 
-	set_data(std::make_shared<data::Analog>());
+	set_data(analog_output_);
 
 	connect(&session_, SIGNAL(capture_state_changed(int)),
 		this, SLOT(on_capture_state_changed(int)));
@@ -123,6 +345,7 @@ void MathSignal::save_settings(QSettings &settings) const
 	SignalBase::save_settings(settings);
 
 	settings.setValue("expression", expression_);
+	settings.setValue("output_type", output_type_);
 
 	settings.setValue("custom_sample_rate", (qulonglong)custom_sample_rate_);
 	settings.setValue("custom_sample_count", (qulonglong)custom_sample_count_);
@@ -137,6 +360,12 @@ void MathSignal::restore_settings(QSettings &settings)
 	if (settings.contains("expression"))
 		expression_ = settings.value("expression").toString();
 
+	if (settings.contains("output_type")) {
+		output_type_ = (OutputType)(settings.value("output_type").toInt());
+		if (output_type_ == LogicOutput)
+			set_data(logic_output_);
+	}
+
 	if (settings.contains("custom_sample_rate"))
 		custom_sample_rate_ = settings.value("custom_sample_rate").toULongLong();
 
@@ -162,6 +391,33 @@ void MathSignal::set_expression(QString expression)
 	begin_generation();
 }
 
+MathSignal::OutputType MathSignal::get_output_type() const
+{
+	return output_type_;
+}
+
+void MathSignal::set_output_type(OutputType type)
+{
+	if (type == output_type_)
+		return;
+
+	reset_generation();
+
+	// The A2L conversion would hide a logic output, and a logic signal
+	// can't be converted anyway
+	if (type == LogicOutput)
+		set_conversion_type(NoConversion);
+
+	output_type_ = type;
+	set_data((type == LogicOutput) ?
+		static_pointer_cast<SignalData>(logic_output_) :
+		static_pointer_cast<SignalData>(analog_output_));
+
+	output_type_changed(type);
+
+	begin_generation();
+}
+
 void MathSignal::set_error(uint8_t type, QString msg)
 {
 	error_type_ = type;
@@ -189,6 +445,12 @@ uint64_t MathSignal::get_working_sample_count(uint32_t segment_id) const
 				const shared_ptr<SignalBase>& sb = input_signal.second.sb;
 
 				shared_ptr<Analog> a = sb->analog_data();
+				if (!a) {
+					// The input is a math signal that now generates logic data
+					result = 0;
+					continue;
+				}
+
 				auto analog_segments = a->analog_segments();
 
 				if (analog_segments.size() == 0) {
@@ -219,6 +481,11 @@ void MathSignal::update_completeness(uint32_t segment_id, uint64_t output_sample
 			const shared_ptr<SignalBase>& sb = input_signal.second.sb;
 
 			shared_ptr<Analog> a = sb->analog_data();
+			if (!a) {
+				output_complete = false;
+				continue;
+			}
+
 			auto analog_segments = a->analog_segments();
 
 			if (analog_segments.size() == 0) {
@@ -249,7 +516,38 @@ void MathSignal::update_completeness(uint32_t segment_id, uint64_t output_sample
 	}
 
 	if (output_complete)
-		analog_data()->analog_segments().at(segment_id)->set_complete();
+		data_->segments().at(segment_id)->set_complete();
+}
+
+shared_ptr<Segment> MathSignal::create_output_segment(uint32_t segment_id)
+{
+	if (output_type_ == LogicOutput) {
+		shared_ptr<LogicSegment> segment = make_shared<LogicSegment>(
+			*logic_output_.get(), segment_id, 1, logic_output_->get_samplerate());
+		logic_output_->push_segment(segment);
+		return segment;
+	}
+
+	shared_ptr<AnalogSegment> segment = make_shared<AnalogSegment>(
+		*analog_output_.get(), segment_id, analog_output_->get_samplerate());
+	analog_output_->push_segment(segment);
+	return segment;
+}
+
+void MathSignal::append_output_samples(uint32_t segment_id, const float* samples,
+	uint64_t sample_count)
+{
+	if (output_type_ == LogicOutput) {
+		// Any non-zero result is a logic high
+		vector<uint8_t> logic_samples(sample_count);
+		for (uint64_t i = 0; i < sample_count; i++)
+			logic_samples[i] = (samples[i] != 0) ? 1 : 0;
+
+		logic_output_->logic_segments().at(segment_id)->append_payload(
+			logic_samples.data(), sample_count);
+	} else
+		analog_output_->analog_segments().at(segment_id)->append_interleaved_samples(
+			samples, sample_count, 1);
 }
 
 void MathSignal::reset_generation()
@@ -260,8 +558,11 @@ void MathSignal::reset_generation()
 		gen_thread_.join();
 	}
 
+	stop_gen_workers();
+
 	data_->clear();
 	input_signals_.clear();
+	gen_instances_.clear();
 
 	if (exprtk_parser_) {
 		delete exprtk_parser_;
@@ -288,6 +589,10 @@ void MathSignal::reset_generation()
 		fnc_sample_ = nullptr;
 	}
 
+	for (fnc_filter<double>* f : fnc_filters_)
+		delete f;
+	fnc_filters_.clear();
+
 	if (!error_message_.isEmpty()) {
 		error_message_.clear();
 		error_type_ = MATH_ERR_NONE;
@@ -296,6 +601,7 @@ void MathSignal::reset_generation()
 	}
 
 	generation_chunk_size_ = ChunkLength;
+	expression_is_stateless_ = false;
 }
 
 void MathSignal::begin_generation()
@@ -313,6 +619,8 @@ void MathSignal::begin_generation()
 		if (sb->analog_data())
 			disconnect(sb->analog_data().get(), nullptr, this, SLOT(on_data_received()));
 		disconnect(sb.get(), nullptr, this, SLOT(on_enabled_changed()));
+		disconnect(sb.get(), nullptr, this, SLOT(on_input_data_about_to_change()));
+		disconnect(sb.get(), nullptr, this, SLOT(on_input_data_changed()));
 	}
 
 	fnc_sample_ = new fnc_sample<double>(*this);
@@ -322,6 +630,11 @@ void MathSignal::begin_generation()
 	exprtk_symbol_table_ = new exprtk::symbol_table<double>();
 	exprtk_symbol_table_->add_constant("T", 1 / session_.get_samplerate());
 	exprtk_symbol_table_->add_function("sample", *fnc_sample_);
+	for (const auto& entry : filter_functions) {
+		fnc_filters_.push_back(new fnc_filter<double>(*this, entry.name,
+			entry.type, entry.parameter_sequence));
+		exprtk_symbol_table_->add_function(entry.name, *fnc_filters_.back());
+	}
 	exprtk_symbol_table_->add_variable("t", exprtk_current_time_);
 	exprtk_symbol_table_->add_variable("s", exprtk_current_sample_);
 	exprtk_symbol_table_->add_constants();
@@ -332,6 +645,8 @@ void MathSignal::begin_generation()
 
 	exprtk_parser_ = new exprtk::parser<double>();
 	exprtk_parser_->enable_unknown_symbol_resolver();
+	exprtk_parser_->dec().collect_functions() = true;
+	exprtk_parser_->dec().collect_assignments() = true;
 
 	if (!exprtk_parser_->compile(expression_.toStdString(), *exprtk_expression_)) {
 		QString error_details;
@@ -366,6 +681,18 @@ void MathSignal::begin_generation()
 			} else
 				sig_data->ref = &(exprtk_unknown_symbol_table_->variable_ref(unknown));
 		}
+
+		// Samples can be generated independently of each other unless the
+		// expression assigns variables, uses sample(), which may access
+		// any sample of any signal - including this one - or uses a filter
+		typedef exprtk::parser<double>::dependent_entity_collector::symbol_t symbol_t;
+		std::deque<symbol_t> functions, assignments;
+		exprtk_parser_->dec().symbols(functions);
+		exprtk_parser_->dec().assignment_symbols(assignments);
+
+		expression_is_stateless_ = assignments.empty() &&
+			none_of(functions.begin(), functions.end(), [](const symbol_t& f) {
+				return (f.first == "sample") || is_filter_function(f.first); });
 	}
 
 	QString disabled_signals;
@@ -388,24 +715,36 @@ uint64_t MathSignal::generate_samples(uint32_t segment_id, const uint64_t start_
 {
 	uint64_t count = 0;
 
-	shared_ptr<Analog> analog = dynamic_pointer_cast<Analog>(data_);
-	shared_ptr<AnalogSegment> segment = analog->analog_segments().at(segment_id);
-
 	// Keep the math functions segment IDs in sync
 	fnc_sample_->current_segment = segment_id;
+	for (fnc_filter<double>* f : fnc_filters_)
+		f->current_segment = segment_id;
 
 	const double sample_rate = data_->get_samplerate();
 
 	exprtk_current_sample_ = start_sample;
 
+	// Signals used as scalars get their samples for the entire chunk
+	// up front, others are accessed through the sample() function
+	vector<signal_data*> block_inputs;
+	for (auto& entry : input_signals_) {
+		signal_data* sig_data = &(entry.second);
+		if (!sig_data->ref)
+			continue;
+
+		fetch_signal_block(sig_data, segment_id, start_sample, sample_count);
+		block_inputs.push_back(sig_data);
+	}
+
 	float *sample_data = new float[sample_count];
 
 	for (int64_t i = 0; i < sample_count; i++) {
 		exprtk_current_time_ = exprtk_current_sample_ / sample_rate;
 
-		for (auto& entry : input_signals_) {
-			signal_data* sig_data  = &(entry.second);
-			update_signal_sample(sig_data, segment_id, exprtk_current_sample_);
+		for (signal_data* sig_data : block_inputs) {
+			sig_data->sample_num = start_sample + i;
+			sig_data->sample_value = sig_data->block[i];
+			*(sig_data->ref) = sig_data->sample_value;
 		}
 
 		double value = exprtk_expression_->value();
@@ -420,13 +759,190 @@ uint64_t MathSignal::generate_samples(uint32_t segment_id, const uint64_t start_
 			break;
 	}
 
-	segment->append_interleaved_samples(sample_data, count, 1);
+	append_output_samples(segment_id, sample_data, count);
 
 	delete[] sample_data;
 
+	for (signal_data* sig_data : block_inputs)
+		sig_data->block.clear();
+
+	return count;
+}
+
+uint64_t MathSignal::generate_samples_parallel(uint32_t segment_id,
+	const uint64_t start_sample, const uint64_t sample_count)
+{
+	const unsigned int thread_count = std::thread::hardware_concurrency();
+
+	// There's nothing to gain from an additional instance on a single core
+	if (thread_count <= 1)
+		return generate_samples(segment_id, start_sample,
+			min(sample_count, generation_chunk_size_));
+
+	while (gen_instances_.size() < thread_count) {
+		shared_ptr<expression_instance> instance = create_expression_instance();
+
+		if (!instance) {
+			// Shouldn't happen as the expression compiled before, but in
+			// that case we fall back to sequential generation
+			expression_is_stateless_ = false;
+			return generate_samples(segment_id, start_sample,
+				min(sample_count, generation_chunk_size_));
+		}
+
+		gen_instances_.push_back(instance);
+	}
+
+	if (gen_workers_.empty()) {
+		gen_workers_exit_ = false;
+		for (size_t i = 1; i < gen_instances_.size(); i++)
+			gen_workers_.emplace_back(&MathSignal::gen_worker_proc, this,
+				gen_instances_[i].get());
+	}
+
+	const uint64_t end_sample = start_sample + sample_count;
+
+	// Hand out one chunk to each instance, the first one is ours
+	size_t chunk_count = 0;
+	{
+		lock_guard<mutex> lock(gen_worker_mutex_);
+
+		uint64_t chunk_start = start_sample;
+		for (size_t i = 0; (i < gen_instances_.size()) && (chunk_start < end_sample); i++) {
+			expression_instance* instance = gen_instances_[i].get();
+			const uint64_t chunk_length = min(end_sample - chunk_start, (uint64_t)ChunkLength);
+
+			instance->segment_id = segment_id;
+			instance->start_sample = chunk_start;
+			instance->output.resize(chunk_length);
+
+			if (i > 0) {
+				instance->pending = true;
+				gen_workers_busy_++;
+			}
+
+			chunk_start += chunk_length;
+			chunk_count++;
+		}
+	}
+	gen_worker_cond_.notify_all();
+
+	expression_instance* const first = gen_instances_.front().get();
+	evaluate_chunk(first, segment_id, first->start_sample, first->output.size(),
+		first->output.data());
+
+	{
+		unique_lock<mutex> lock(gen_worker_mutex_);
+		while (gen_workers_busy_ > 0)
+			gen_worker_done_cond_.wait(lock);
+	}
+
+	// The chunks are incomplete if the generation was interrupted
+	if (gen_interrupt_)
+		return 0;
+
+	// Append the chunks in order so that the output segment stays sequential
+	uint64_t count = 0;
+	for (size_t i = 0; i < chunk_count; i++) {
+		const vector<float>& output = gen_instances_[i]->output;
+		append_output_samples(segment_id, output.data(), output.size());
+		count += output.size();
+	}
+
 	return count;
 }
 
+shared_ptr<expression_instance> MathSignal::create_expression_instance() const
+{
+	shared_ptr<expression_instance> instance = make_shared<expression_instance>();
+
+	instance->symbol_table.add_constant("T", 1 / session_.get_samplerate());
+	instance->symbol_table.add_variable("t", instance->current_time);
+	instance->symbol_table.add_variable("s", instance->current_sample);
+	instance->symbol_table.add_constants();
+
+	// The input signals are known by now, so we declare them up front
+	// instead of using the unknown symbol resolver
+	for (const auto& entry : input_signals_) {
+		instance->input_symbol_table.create_variable(entry.first);
+
+		signal_data sig_data(entry.second.sb);
+		sig_data.ref = &(instance->input_symbol_table.variable_ref(entry.first));
+		instance->inputs.insert({entry.first, sig_data});
+	}
+
+	instance->expression.register_symbol_table(instance->input_symbol_table);
+	instance->expression.register_symbol_table(instance->symbol_table);
+
+	exprtk::parser<double> parser;
+	if (!parser.compile(expression_.toStdString(), instance->expression))
+		return nullptr;
+
+	return instance;
+}
+
+void MathSignal::evaluate_chunk(expression_instance* instance, uint32_t segment_id,
+	uint64_t start_sample, uint64_t sample_count, float* dest)
+{
+	const double sample_rate = data_->get_samplerate();
+
+	vector<signal_data*> inputs;
+	for (auto& entry : instance->inputs) {
+		fetch_signal_block(&(entry.second), segment_id, start_sample, sample_count);
+		inputs.push_back(&(entry.second));
+	}
+
+	instance->current_sample = start_sample;
+
+	for (uint64_t i = 0; (i < sample_count) && !gen_interrupt_; i++) {
+		instance->current_time = instance->current_sample / sample_rate;
+
+		for (signal_data* sig_data : inputs)
+			*(sig_data->ref) = sig_data->block[i];
+
+		dest[i] = instance->expression.value();
+		instance->current_sample += 1;
+	}
+
+	for (signal_data* sig_data : inputs)
+		sig_data->block.clear();
+}
+
+void MathSignal::gen_worker_proc(expression_instance* instance)
+{
+	unique_lock<mutex> lock(gen_worker_mutex_);
+
+	while (true) {
+		while (!gen_workers_exit_ && !instance->pending)
+			gen_worker_cond_.wait(lock);
+
+		if (gen_workers_exit_)
+			break;
+
+		lock.unlock();
+		evaluate_chunk(instance, instance->segment_id, instance->start_sample,
+			instance->output.size(), instance->output.data());
+		lock.lock();
+
+		instance->pending = false;
+		gen_workers_busy_--;
+		gen_worker_done_cond_.notify_one();
+	}
+}
+
+void MathSignal::stop_gen_workers()
+{
+	{
+		lock_guard<mutex> lock(gen_worker_mutex_);
+		gen_workers_exit_ = true;
+	}
+	gen_worker_cond_.notify_all();
+
+	for (std::thread& worker : gen_workers_)
+		worker.join();
+	gen_workers_.clear();
+}
+
 void MathSignal::generation_proc()
 {
 	// Don't do anything until we have a valid sample rate
@@ -446,14 +962,11 @@ void MathSignal::generation_proc()
 		return;
 
 	uint32_t segment_id = 0;
-	shared_ptr<Analog> analog = analog_data();
 
-	// Create initial analog segment
-	shared_ptr<AnalogSegment> output_segment =
-		make_shared<AnalogSegment>(*analog.get(), segment_id, analog->get_samplerate());
-	analog->push_segment(output_segment);
+	// Create initial output segment
+	shared_ptr<Segment> output_segment = create_output_segment(segment_id);
 
-	// Create analog samples
+	// Create output samples
 	do {
 		const uint64_t input_sample_count = get_working_sample_count(segment_id);
 		const uint64_t output_sample_count = output_segment->get_sample_count();
@@ -467,10 +980,21 @@ void MathSignal::generation_proc()
 			uint64_t processed_samples = 0;
 			do {
 				const uint64_t start_sample = output_sample_count + processed_samples;
-				uint64_t sample_count =
-					min(samples_to_process - processed_samples,	generation_chunk_size_);
+				const uint64_t remaining_samples = samples_to_process - processed_samples;
+				uint64_t sample_count;
+
+				// Once the first chunk has been generated, we know whether the
+				// expression refers to this signal. If it doesn't and has no
+				// state, the remaining chunks can be generated concurrently
+				if (expression_is_stateless_ && (start_sample > 0) &&
+					(generation_chunk_size_ == (uint64_t)ChunkLength) &&
+					(remaining_samples > (uint64_t)ChunkLength))
+					sample_count = generate_samples_parallel(segment_id,
+						start_sample, remaining_samples);
+				else
+					sample_count = generate_samples(segment_id, start_sample,
+						min(remaining_samples, generation_chunk_size_));
 
-				sample_count = generate_samples(segment_id, start_sample, sample_count);
 				processed_samples += sample_count;
 
 				// Notify consumers of this signal's data
@@ -484,9 +1008,7 @@ void MathSignal::generation_proc()
 				// Process next segment
 				segment_id++;
 
-				output_segment =
-					make_shared<AnalogSegment>(*analog.get(), segment_id, analog->get_samplerate());
-				analog->push_segment(output_segment);
+				output_segment = create_output_segment(segment_id);
 		}
 
 		if (!gen_interrupt_ && (samples_to_process == 0)) {
@@ -527,6 +1049,14 @@ signal_data* MathSignal::signal_from_name(const std::string& name)
 				connect(sb.get(), SIGNAL(enabled_changed(bool)),
 					this, SLOT(on_enabled_changed()));
 
+				// The generation thread must be stopped before the input's
+				// data is replaced, so this can't be a queued connection
+				connect(sb.get(), SIGNAL(data_about_to_change()),
+					this, SLOT(on_input_data_about_to_change()),
+					Qt::ConnectionType(Qt::DirectConnection | Qt::UniqueConnection));
+				connect(sb.get(), SIGNAL(data_changed()),
+					this, SLOT(on_input_data_changed()), Qt::UniqueConnection);
+
 				return &(input_signals_.insert({name, signal_data(sb)}).first->second);
 			}
 	}
@@ -547,20 +1077,57 @@ void MathSignal::update_signal_sample(signal_data* sig_data, uint32_t segment_id
 	if (sig_data->sample_num == sample_num)
 		return;
 
-	assert(sig_data->sb);
-	const shared_ptr<pv::data::Analog> analog = sig_data->sb->analog_data();
-	assert(analog);
+	sig_data->sample_num = sample_num;
 
-	assert(segment_id < analog->analog_segments().size());
+	vector<float>& window = sig_data->window;
+	const uint64_t window_end = sig_data->window_start + window.size();
+	const bool window_valid = (sig_data->window_segment == segment_id) && !window.empty();
 
-	const shared_ptr<AnalogSegment> segment = analog->analog_segments().at(segment_id);
+	if (window_valid && (sample_num >= sig_data->window_start) && (sample_num < window_end))
+		sig_data->sample_value = window[sample_num - sig_data->window_start];
+	else {
+		assert(sig_data->sb);
+		const shared_ptr<pv::data::Analog> analog = sig_data->sb->analog_data();
+		assert(analog);
+
+		assert(segment_id < analog->analog_segments().size());
+
+		const shared_ptr<AnalogSegment> segment = analog->analog_segments().at(segment_id);
+		const uint64_t sample_count = segment->get_sample_count();
+
+		if (sample_num >= sample_count)
+			sig_data->sample_value = 0;
+		else if (window_valid && (sample_num >= window_end) &&
+			(sample_num - window_end < SampleWindowLength)) {
+			// Near-sequential access, which also happens when the math signal
+			// accesses its own output: extend the window with the new samples
+			// and discard old samples only once in a while
+			if (window.size() >= 2 * SampleWindowLength) {
+				const uint64_t discard = window.size() - SampleWindowLength;
+				window.erase(window.begin(), window.begin() + discard);
+				sig_data->window_start += discard;
+			}
 
-	sig_data->sample_num = sample_num;
+			const uint64_t end = min(sample_count, sample_num + SampleWindowLength);
+			window.resize(window.size() + (end - window_end));
+			segment->get_samples(window_end, end,
+				window.data() + (window_end - sig_data->window_start));
+
+			sig_data->sample_value = window[sample_num - sig_data->window_start];
+		} else {
+			// Keep some samples before the requested one as expressions
+			// usually look at the past
+			const uint64_t start = sample_num - min(sample_num, SampleWindowLength / 4);
+			const uint64_t end = min(sample_count, sample_num + SampleWindowLength);
 
-	if (sample_num < segment->get_sample_count())
-		sig_data->sample_value = segment->get_sample(sample_num);
-	else
-		sig_data->sample_value = 0;
+			window.resize(end - start);
+			segment->get_samples(start, end, window.data());
+			sig_data->window_start = start;
+			sig_data->window_segment = segment_id;
+
+			sig_data->sample_value = window[sample_num - start];
+		}
+	}
 
 	// We only have a reference if this signal is used as a scalar;
 	// if it's used by a function, it's null
@@ -568,6 +1135,30 @@ void MathSignal::update_signal_sample(signal_data* sig_data, uint32_t segment_id
 		*(sig_data->ref) = sig_data->sample_value;
 }
 
+void MathSignal::fetch_signal_block(signal_data* sig_data, uint32_t segment_id,
+	uint64_t start_sample, uint64_t sample_count)
+{
+	assert(sig_data);
+	assert(sig_data->sb);
+
+	sig_data->block.assign(sample_count, 0);
+
+	const shared_ptr<pv::data::Analog> analog = sig_data->sb->analog_data();
+	assert(analog);
+
+	if (segment_id >= analog->analog_segments().size())
+		return;
+
+	const shared_ptr<AnalogSegment> segment = analog->analog_segments().at(segment_id);
+
+	const uint64_t input_sample_count = segment->get_sample_count();
+	if (start_sample >= input_sample_count)
+		return;
+
+	const uint64_t end_sample = min(start_sample + sample_count, input_sample_count);
+	segment->get_samples(start_sample, end_sample, sig_data->block.data());
+}
+
 bool MathSignal::all_input_signals_enabled(QString &disabled_signals) const
 {
 	bool all_enabled = true;
@@ -602,6 +1193,22 @@ void MathSignal::on_data_received()
 	gen_input_cond_.notify_one();
 }
 
+void MathSignal::on_input_data_about_to_change()
+{
+	reset_generation();
+
+	SignalBase* const sb = qobject_cast<SignalBase*>(QObject::sender());
+	if (sb && sb->analog_data())
+		disconnect(sb->analog_data().get(), nullptr, this, SLOT(on_data_received()));
+}
+
+void MathSignal::on_input_data_changed()
+{
+	// Resolve the input signals again, an input that no longer has analog
+	// data is reported as an error
+	begin_generation();
+}
+
 void MathSignal::on_enabled_changed()
 {
 	QString disabled_signals;
@@ -31,6 +31,7 @@
 #include <pv/exprtk.hpp>
 #include <pv/util.hpp>
 #include <pv/data/analog.hpp>
+#include <pv/data/logic.hpp>
 #include <pv/data/signalbase.hpp>
 
 using std::atomic;
@@ -44,20 +45,33 @@ class Session;
 
 namespace data {
 
+class Segment;
 class SignalBase;
 
 template<typename T>
 struct fnc_sample;
 
+template<typename T>
+struct fnc_filter;
+
+struct expression_instance;
+
 struct signal_data {
 	signal_data(const shared_ptr<SignalBase> _sb) :
-		sb(_sb), sample_num(numeric_limits<uint64_t>::max()), sample_value(0), ref(nullptr)
+		sb(_sb), sample_num(numeric_limits<uint64_t>::max()), sample_value(0), ref(nullptr),
+		window_start(0), window_segment(0)
 	{}
 
 	const shared_ptr<SignalBase> sb;
 	uint64_t sample_num;
 	double sample_value;
 	double* ref;
+
+	vector<float> block;  ///< Input samples of the chunk currently being generated
+
+	vector<float> window;  ///< Input samples around the ones last accessed by sample()
+	uint64_t window_start;
+	uint32_t window_segment;
 };
 
 class MathSignal : public SignalBase
@@ -67,6 +81,13 @@ class MathSignal : public SignalBase
 
 private:
 	static const int64_t ChunkLength;
+	static const uint64_t SampleWindowLength;
+
+public:
+	enum OutputType {
+		AnalogOutput = 0,  ///< One float per sample
+		LogicOutput = 1    ///< One bit per sample, set if the result isn't 0
+	};
 
 public:
 	MathSignal(pv::Session &session);
@@ -78,6 +99,15 @@ public:
 	QString get_expression() const;
 	void set_expression(QString expression);
 
+	OutputType get_output_type() const;
+
+	/**
+	 * Selects whether the results are stored as analog samples or as a
+	 * logic signal that can e.g. be used as decoder input. Changing the
+	 * type discards the generated data and restarts the generation.
+	 */
+	void set_output_type(OutputType type);
+
 private:
 	void set_error(uint8_t type, QString msg);
 
@@ -92,20 +122,59 @@ private:
 
 	void update_completeness(uint32_t segment_id, uint64_t output_sample_count);
 
+	shared_ptr<Segment> create_output_segment(uint32_t segment_id);
+	void append_output_samples(uint32_t segment_id, const float* samples,
+		uint64_t sample_count);
+
 	void reset_generation();
 	virtual void begin_generation();
 
 	uint64_t generate_samples(uint32_t segment_id, const uint64_t start_sample,
 		const int64_t sample_count);
+
+	/**
+	 * Generates up to one chunk per available CPU core concurrently, using
+	 * a separate instance of the expression for each thread. The generation
+	 * thread evaluates the first chunk, workers that are kept until the
+	 * generation is reset evaluate the others. Only valid for expressions
+	 * that don't carry state from one sample to the next.
+	 *
+	 * @return the number of samples generated
+	 */
+	uint64_t generate_samples_parallel(uint32_t segment_id,
+		const uint64_t start_sample, const uint64_t sample_count);
+	shared_ptr<expression_instance> create_expression_instance() const;
+	void evaluate_chunk(expression_instance* instance, uint32_t segment_id,
+		uint64_t start_sample, uint64_t sample_count, float* dest);
+	void gen_worker_proc(expression_instance* instance);
+	void stop_gen_workers();
+
 	void generation_proc();
 
 	signal_data* signal_from_name(const std::string& name);
+
+	/**
+	 * Sets the current value of a signal to the given sample. The samples
+	 * are read from the input segment in windows of SampleWindowLength
+	 * samples so that accessing neighboring samples doesn't require a
+	 * segment lookup each time.
+	 */
 	void update_signal_sample(signal_data* sig_data, uint32_t segment_id, uint64_t sample_num);
 
+	/**
+	 * Fetches the input samples [start_sample, start_sample + sample_count)
+	 * of a signal in one go so that they can be handed to the expression
+	 * without looking up and locking the input segment for every sample.
+	 * Samples that don't exist (yet) are set to 0.
+	 */
+	void fetch_signal_block(signal_data* sig_data, uint32_t segment_id,
+		uint64_t start_sample, uint64_t sample_count);
+
 	bool all_input_signals_enabled(QString &disabled_signals) const;
 
 Q_SIGNALS:
 	void expression_changed(QString expression);
+	void output_type_changed(int type);
 
 private Q_SLOTS:
 	void on_capture_state_changed(int state);
@@ -113,6 +182,9 @@ private Q_SLOTS:
 
 	void on_enabled_changed();
 
+	void on_input_data_about_to_change();
+	void on_input_data_changed();
+
 private:
 	pv::Session &session_;
 
@@ -120,14 +192,23 @@ private:
 	uint64_t custom_sample_count_;
 	bool use_custom_sample_rate_, use_custom_sample_count_;
 	uint64_t generation_chunk_size_;
+	bool expression_is_stateless_;
 	map<std::string, signal_data> input_signals_;
+	vector< shared_ptr<expression_instance> > gen_instances_;
+	vector<std::thread> gen_workers_;  ///< One for each instance but the first
+	unsigned int gen_workers_busy_;
+	bool gen_workers_exit_;
 
 	QString expression_;
 
+	OutputType output_type_;
+	shared_ptr<Analog> analog_output_;
+	shared_ptr<Logic> logic_output_;
+
 	uint8_t error_type_;
 
-	mutable mutex input_mutex_;
-	mutable condition_variable gen_input_cond_;
+	mutable mutex input_mutex_, gen_worker_mutex_;
+	mutable condition_variable gen_input_cond_, gen_worker_cond_, gen_worker_done_cond_;
 
 	std::thread gen_thread_;
 	atomic<bool> gen_interrupt_;
@@ -138,9 +219,11 @@ private:
 	double exprtk_current_time_, exprtk_current_sample_;
 
 	fnc_sample<double>* fnc_sample_;
+	vector< fnc_filter<double>* > fnc_filters_;
 
-	// Give sig_sample access to the private helper functions
+	// Give the math functions access to the private helper functions
 	friend struct fnc_sample<double>;
+	friend struct fnc_filter<double>;
 };
 
 } // namespace data
@@ -24,11 +24,13 @@
 #include <cstdlib>
 #include <cstring>
 
+#include <QCryptographicHash>
 #include <QDebug>
 
 using std::bad_alloc;
 using std::lock_guard;
 using std::min;
+using std::mutex;
 using std::recursive_mutex;
 
 namespace pv {
@@ -132,6 +134,29 @@ void Segment::free_unused_memory()
 	}
 }
 
+QByteArray Segment::content_hash() const
+{
+	if (!is_complete_)
+		return QByteArray();
+
+	lock_guard<mutex> hash_lock(content_hash_mutex_);
+
+	if (content_hash_.isEmpty()) {
+		QCryptographicHash hash(QCryptographicHash::Sha1);
+		const uint64_t size = sample_count_ * unit_size_;
+
+		for (uint64_t i = 0, offset = 0; offset < size; i++, offset += chunk_size_) {
+			// Only hold up others accessing the data for one chunk at a time
+			lock_guard<recursive_mutex> lock(mutex_);
+			hash.addData((const char*)data_chunks_[i], min(chunk_size_, size - offset));
+		}
+
+		content_hash_ = hash.result();
+	}
+
+	return content_hash_;
+}
+
 void Segment::append_single_sample(void *data)
 {
 	lock_guard<recursive_mutex> lock(mutex_);
@@ -181,36 +206,77 @@ void Segment::append_samples(void* data, uint64_t samples)
 		remaining_samples -= copy_count;
 		data_offset += (copy_count * unit_size_);
 
-		if (unused_samples_ == 0) {
-			try {
-				// If we're out of memory, allocating a chunk will throw
-				// std::bad_alloc. To give the application some usable memory
-				// to work with in case chunk allocation fails, we allocate
-				// extra memory and throw it away if it all succeeded.
-				// This way, memory allocation will fail early enough to let
-				// PV remain alive. Otherwise, PV will crash in a random
-				// memory-allocating part of the application.
-				current_chunk_ = new uint8_t[chunk_size_ + 7];  /* FIXME +7 is workaround for #1284 */
-
-				const int dummy_size = 2 * chunk_size_;
-				auto dummy_chunk = new uint8_t[dummy_size];
-				memset(dummy_chunk, 0xFF, dummy_size);
-				delete[] dummy_chunk;
-			} catch (bad_alloc&) {
-				delete[] current_chunk_;  // The new may have succeeded
-				current_chunk_ = nullptr;
-				throw;
-			}
-
-			data_chunks_.push_back(current_chunk_);
-			used_samples_ = 0;
-			unused_samples_ = chunk_size_ / unit_size_;
-		}
+		if (unused_samples_ == 0)
+			append_chunk();
 	} while (remaining_samples > 0);
 
 	sample_count_ += samples;
 }
 
+void Segment::append_repeated_samples(const void* sample, uint64_t count)
+{
+	lock_guard<recursive_mutex> lock(mutex_);
+
+	uint64_t remaining_samples = count;
+
+	while (remaining_samples > 0) {
+		const uint64_t fill_count = min(remaining_samples, unused_samples_);
+		uint8_t* const dest = &(current_chunk_[used_samples_ * unit_size_]);
+
+		// Fill the chunk by copying what has been filled in already,
+		// doubling the amount with every step
+		if (unit_size_ == 1)
+			memset(dest, *(const uint8_t*)sample, fill_count);
+		else {
+			const uint64_t size = fill_count * unit_size_;
+			uint64_t filled = unit_size_;
+
+			memcpy(dest, sample, unit_size_);
+			while (filled < size) {
+				const uint64_t n = min(filled, size - filled);
+				memcpy(dest + filled, dest, n);
+				filled += n;
+			}
+		}
+
+		used_samples_ += fill_count;
+		unused_samples_ -= fill_count;
+		remaining_samples -= fill_count;
+
+		if (unused_samples_ == 0)
+			append_chunk();
+	}
+
+	sample_count_ += count;
+}
+
+void Segment::append_chunk()
+{
+	try {
+		// If we're out of memory, allocating a chunk will throw
+		// std::bad_alloc. To give the application some usable memory
+		// to work with in case chunk allocation fails, we allocate
+		// extra memory and throw it away if it all succeeded.
+		// This way, memory allocation will fail early enough to let
+		// PV remain alive. Otherwise, PV will crash in a random
+		// memory-allocating part of the application.
+		current_chunk_ = new uint8_t[chunk_size_ + 7];  /* FIXME +7 is workaround for #1284 */
+
+		const int dummy_size = 2 * chunk_size_;
+		auto dummy_chunk = new uint8_t[dummy_size];
+		memset(dummy_chunk, 0xFF, dummy_size);
+		delete[] dummy_chunk;
+	} catch (bad_alloc&) {
+		delete[] current_chunk_;  // The new may have succeeded
+		current_chunk_ = nullptr;
+		throw;
+	}
+
+	data_chunks_.push_back(current_chunk_);
+	used_samples_ = 0;
+	unused_samples_ = chunk_size_ / unit_size_;
+}
+
 const uint8_t* Segment::get_raw_sample(uint64_t sample_num) const
 {
 	assert(sample_num <= sample_count_);
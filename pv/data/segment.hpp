@@ -29,9 +29,11 @@
 #include <thread>
 #include <deque>
 
+#include <QByteArray>
 #include <QObject>
 
 using std::atomic;
+using std::mutex;
 using std::recursive_mutex;
 using std::deque;
 
@@ -46,6 +48,7 @@ struct MediumSize32Multi;
 struct MaxSize32Multi;
 struct MaxSize32MultiAtOnce;
 struct MaxSize32MultiIterated;
+struct ContentHash;
 }  // namespace SegmentTest
 
 namespace pv {
@@ -84,12 +87,24 @@ public:
 
 	void free_unused_memory();
 
+	/**
+	 * Returns a hash of the samples of a complete segment or an empty
+	 * array if the segment isn't complete. The hash is calculated by the
+	 * first call and kept since the samples don't change anymore.
+	 */
+	QByteArray content_hash() const;
+
 Q_SIGNALS:
 	void completed();
 
 protected:
 	void append_single_sample(void *data);
 	void append_samples(void *data, uint64_t samples);
+	/**
+	 * Appends @c count copies of the given sample, filling the chunks
+	 * directly.
+	 */
+	void append_repeated_samples(const void* sample, uint64_t count);
 	const uint8_t* get_raw_sample(uint64_t sample_num) const;
 	void get_raw_samples(uint64_t start, uint64_t count, uint8_t *dest) const;
 
@@ -99,6 +114,11 @@ protected:
 	uint8_t* get_iterator_value(SegmentDataIterator* it);
 	uint64_t get_iterator_valid_length(SegmentDataIterator* it);
 
+private:
+	void append_chunk();
+
+protected:
+
 	uint32_t segment_id_;
 	mutable recursive_mutex mutex_;
 	deque<uint8_t*> data_chunks_;
@@ -113,6 +133,9 @@ protected:
 	bool mem_optimization_requested_;
 	bool is_complete_;
 
+	mutable mutex content_hash_mutex_;
+	mutable QByteArray content_hash_;
+
 	friend struct SegmentTest::SmallSize8Single;
 	friend struct SegmentTest::MediumSize8Single;
 	friend struct SegmentTest::MaxSize8Single;
@@ -123,6 +146,7 @@ protected:
 	friend struct SegmentTest::MaxSize32Multi;
 	friend struct SegmentTest::MaxSize32MultiAtOnce;
 	friend struct SegmentTest::MaxSize32MultiIterated;
+	friend struct SegmentTest::ContentHash;
 };
 
 } // namespace data
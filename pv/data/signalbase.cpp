@@ -26,6 +26,8 @@
 #include "signalbase.hpp"
 #include "signaldata.hpp"
 
+#include <cstring>
+
 #include <QDebug>
 
 #include <extdef.h>
@@ -33,7 +35,9 @@
 #include <pv/binding/decoder.hpp>
 
 using std::dynamic_pointer_cast;
+using std::lock_guard;
 using std::make_shared;
+using std::min;
 using std::out_of_range;
 using std::shared_ptr;
 using std::tie;
@@ -124,6 +128,10 @@ SignalBase::SignalBase(shared_ptr<sigrok::Channel> channel, ChannelType channel_
 	conversion_type_(NoConversion),
 	min_value_(0),
 	max_value_(0),
+	conversion_focus_segment_(0),
+	conversion_focus_start_(0),
+	conversion_focus_end_(0),
+	conversion_preview_offset_(0),
 	index_(0),
 	error_message_("")
 {
@@ -271,10 +279,13 @@ QString SignalBase::get_error_message() const
 void SignalBase::set_data(shared_ptr<pv::data::SignalData> data)
 {
 	if (data_) {
-		disconnect(data.get(), SIGNAL(samples_cleared()),
+		// Give the consumers of the old data a chance to stop using it
+		data_about_to_change();
+
+		disconnect(data_.get(), SIGNAL(samples_cleared()),
 			this, SLOT(on_samples_cleared()));
-		disconnect(data.get(), SIGNAL(samples_added(shared_ptr<Segment>, uint64_t, uint64_t)),
-			this, SLOT(on_samples_added(shared_ptr<Segment>, uint64_t, uint64_t)));
+		disconnect(data_.get(), SIGNAL(samples_added(SharedPtrToSegment, uint64_t, uint64_t)),
+			this, SLOT(on_samples_added(SharedPtrToSegment, uint64_t, uint64_t)));
 
 		shared_ptr<Analog> analog = analog_data();
 		if (analog)
@@ -295,6 +306,8 @@ void SignalBase::set_data(shared_ptr<pv::data::SignalData> data)
 			connect(analog.get(), SIGNAL(min_max_changed(float, float)),
 				this, SLOT(on_min_max_changed(float, float)));
 	}
+
+	data_changed();
 }
 
 void SignalBase::clear_sample_data()
@@ -629,8 +642,91 @@ bool SignalBase::conversion_is_a2l() const
 		(conversion_type_ == A2LConversionBySchmittTrigger)));
 }
 
+bool SignalBase::convert_block_by_envelope(shared_ptr<AnalogSegment> asegment,
+	uint64_t start_sample, uint64_t sample_count,
+	const vector<double> &thresholds, uint8_t &state, uint8_t *lsamples) const
+{
+	AnalogSegment::EnvelopeSample env;
+
+	if (!asegment->get_envelope_min_max(env, start_sample, start_sample + sample_count))
+		return false;
+
+	// Note: the comparisons must match those of sr_a2l_threshold() and
+	// sr_a2l_schmitt_trigger() so that the result is the same as if we had
+	// converted every single sample
+	if (conversion_type_ == A2LConversionByThreshold) {
+		const float threshold = thresholds[0];
+
+		if (env.min >= threshold)
+			state = 1;
+		else if (env.max < threshold)
+			state = 0;
+		else
+			return false;
+	}
+
+	if (conversion_type_ == A2LConversionBySchmittTrigger) {
+		const float lo_thr = thresholds[0];
+		const float hi_thr = thresholds[1];
+
+		if (env.max < lo_thr)
+			state = 0;
+		else if (env.min > hi_thr)
+			state = 1;
+		else if ((env.min < lo_thr) || (env.max > hi_thr))
+			return false;
+		// else: all samples are within the hysteresis, the state is unchanged
+	}
+
+	memset(lsamples, state, sample_count);
+
+	return true;
+}
+
+uint8_t SignalBase::get_schmitt_trigger_state(shared_ptr<AnalogSegment> asegment,
+	uint64_t sample_num, float lo_thr, float hi_thr) const
+{
+	uint8_t state = 0;
+	bool state_found = false;
+
+	float *asamples = new float[ConversionBlockSize];
+	assert(asamples);
+
+	// Search backwards for the last sample that left the hysteresis band
+	uint64_t end = sample_num;
+	while ((end > 0) && !state_found) {
+		const uint64_t start = ((end - 1) / ConversionBlockSize) * ConversionBlockSize;
+
+		AnalogSegment::EnvelopeSample env;
+		if (asegment->get_envelope_min_max(env, start, end) &&
+			(env.min >= lo_thr) && (env.max <= hi_thr)) {
+			end = start;
+			continue;
+		}
+
+		asegment->get_samples(start, end, asamples);
+
+		for (uint64_t i = end - start; (i > 0) && !state_found; i--) {
+			if (asamples[i - 1] < lo_thr) {
+				state = 0;
+				state_found = true;
+			} else if (asamples[i - 1] > hi_thr) {
+				state = 1;
+				state_found = true;
+			}
+		}
+
+		end = start;
+	}
+
+	delete[] asamples;
+
+	return state;
+}
+
 void SignalBase::convert_single_segment_range(shared_ptr<AnalogSegment> asegment,
-	shared_ptr<LogicSegment> lsegment, uint64_t start_sample, uint64_t end_sample)
+	shared_ptr<LogicSegment> lsegment, uint64_t start_sample, uint64_t end_sample,
+	bool is_preview)
 {
 	if (end_sample > start_sample) {
 		tie(min_value_, max_value_) = asegment->get_min_max();
@@ -649,77 +745,56 @@ void SignalBase::convert_single_segment_range(shared_ptr<AnalogSegment> asegment
 		const sigrok::Quantity * const mq = sigrok::Quantity::VOLTAGE;
 		const sigrok::Unit * const unit = sigrok::Unit::VOLT;
 
+		uint64_t packet_size = ConversionBlockSize;
 		shared_ptr<sigrok::Packet> packet =
 			Session::sr_context->create_analog_packet(channels,
-			asamples, ConversionBlockSize, mq, unit, mq_flags);
+			asamples, packet_size, mq, unit, mq_flags);
 
 		shared_ptr<sigrok::Analog> analog =
 			dynamic_pointer_cast<sigrok::Analog>(packet->payload());
 
-		// Convert
-		uint64_t i = start_sample;
-
-		if (conversion_type_ == A2LConversionByThreshold) {
-			const double threshold = get_conversion_thresholds()[0];
+		const vector<double> thresholds = get_conversion_thresholds();
 
-			// Convert as many sample blocks as we can
-			while ((end_sample - i) > ConversionBlockSize) {
-				asegment->get_samples(i, i + ConversionBlockSize, asamples);
+		uint8_t state = 0;
+		if ((conversion_type_ == A2LConversionBySchmittTrigger) && (start_sample > 0))
+			state = get_schmitt_trigger_state(asegment, start_sample,
+				thresholds[0], thresholds[1]);
 
-				shared_ptr<sigrok::Logic> logic =
-					analog->get_logic_via_threshold(threshold, lsamples);
-
-				lsegment->append_payload(logic->data_pointer(), logic->data_length());
-				samples_added(lsegment->segment_id(), i, i + ConversionBlockSize);
-				i += ConversionBlockSize;
-			}
-
-			// Re-create sigrok::Analog and convert remaining samples
-			packet = Session::sr_context->create_analog_packet(channels,
-				asamples, end_sample - i, mq, unit, mq_flags);
-
-			analog = dynamic_pointer_cast<sigrok::Analog>(packet->payload());
-
-			asegment->get_samples(i, end_sample, asamples);
-			shared_ptr<sigrok::Logic> logic =
-				analog->get_logic_via_threshold(threshold, lsamples);
-			lsegment->append_payload(logic->data_pointer(), logic->data_length());
-			samples_added(lsegment->segment_id(), i, end_sample);
-		}
+		// Convert
+		uint64_t i = start_sample;
 
-		if (conversion_type_ == A2LConversionBySchmittTrigger) {
-			const vector<double> thresholds = get_conversion_thresholds();
-			const double lo_thr = thresholds[0];
-			const double hi_thr = thresholds[1];
+		while ((i < end_sample) && !conversion_interrupt_) {
+			const uint64_t count = min(end_sample - i, ConversionBlockSize);
 
-			uint8_t state = 0;  // TODO Use value of logic sample n-1 instead of 0
+			// Blocks that don't cross the threshold(s) don't need to be
+			// converted sample by sample
+			if (!convert_block_by_envelope(asegment, i, count, thresholds,
+				state, lsamples)) {
 
-			// Convert as many sample blocks as we can
-			while ((end_sample - i) > ConversionBlockSize) {
-				asegment->get_samples(i, i + ConversionBlockSize, asamples);
+				// Re-create sigrok::Analog if the block size changed
+				if (count != packet_size) {
+					packet_size = count;
+					packet = Session::sr_context->create_analog_packet(channels,
+						asamples, packet_size, mq, unit, mq_flags);
+					analog = dynamic_pointer_cast<sigrok::Analog>(packet->payload());
+				}
 
-				shared_ptr<sigrok::Logic> logic =
-					analog->get_logic_via_schmitt_trigger(lo_thr, hi_thr,
-						&state, lsamples);
+				asegment->get_samples(i, i + count, asamples);
 
-				lsegment->append_payload(logic->data_pointer(), logic->data_length());
-				samples_added(lsegment->segment_id(), i, i + ConversionBlockSize);
+				if (conversion_type_ == A2LConversionByThreshold)
+					analog->get_logic_via_threshold(thresholds[0], lsamples);
 
-				i += ConversionBlockSize;
+				if (conversion_type_ == A2LConversionBySchmittTrigger)
+					analog->get_logic_via_schmitt_trigger(thresholds[0],
+						thresholds[1], &state, lsamples);
 			}
 
-			// Re-create sigrok::Analog and convert remaining samples
-			packet = Session::sr_context->create_analog_packet(channels,
-				asamples, end_sample - i, mq, unit, mq_flags);
-
-			analog = dynamic_pointer_cast<sigrok::Analog>(packet->payload());
-
-			asegment->get_samples(i, end_sample, asamples);
-			shared_ptr<sigrok::Logic> logic =
-				analog->get_logic_via_schmitt_trigger(lo_thr, hi_thr,
-					&state, lsamples);
-			lsegment->append_payload(logic->data_pointer(), logic->data_length());
-			samples_added(lsegment->segment_id(), i, end_sample);
+			lsegment->append_payload(lsamples, count);
+			if (is_preview)
+				conversion_preview_updated();
+			else
+				samples_added(lsegment->segment_id(), i, i + count);
+			i += count;
 		}
 
 		// If acquisition is ongoing, start-/endsample may have changed
@@ -729,7 +804,10 @@ void SignalBase::convert_single_segment_range(shared_ptr<AnalogSegment> asegment
 		delete[] asamples;
 	}
 
-	samples_added(lsegment->segment_id(), start_sample, end_sample);
+	if (is_preview)
+		conversion_preview_updated();
+	else
+		samples_added(lsegment->segment_id(), start_sample, end_sample);
 }
 
 void SignalBase::convert_single_segment(shared_ptr<AnalogSegment> asegment,
@@ -761,13 +839,76 @@ void SignalBase::convert_single_segment(shared_ptr<AnalogSegment> asegment,
 		// completed in the meanwhile, we convert the remaining samples as well.
 		// Also, if a sufficient number of samples was added in the meanwhile,
 		// we do another round of sample conversion.
-	} while ((complete_state != old_complete_state) ||
-		(end_sample - old_end_sample >= ConversionBlockSize));
+	} while (!conversion_interrupt_ && ((complete_state != old_complete_state) ||
+		(end_sample - old_end_sample >= ConversionBlockSize)));
+
+	// The converted focus range is no longer needed once we caught up with it
+	{
+		lock_guard<mutex> lock(conversion_focus_mutex_);
+		if (conversion_preview_ &&
+			(conversion_preview_->segment_id() == lsegment->segment_id()) &&
+			(lsegment->get_sample_count() >=
+				conversion_preview_offset_ + conversion_preview_->get_sample_count()))
+			conversion_preview_.reset();
+	}
 
-	if (complete_state)
+	if (complete_state && !conversion_interrupt_)
 		lsegment->set_complete();
 }
 
+void SignalBase::convert_focus_range(shared_ptr<Analog> analog_data)
+{
+	uint32_t segment_id;
+	uint64_t start_sample, end_sample;
+
+	{
+		lock_guard<mutex> lock(conversion_focus_mutex_);
+		segment_id = conversion_focus_segment_;
+		start_sample = conversion_focus_start_;
+		end_sample = conversion_focus_end_;
+	}
+
+	shared_ptr<AnalogSegment> asegment;
+	try {
+		asegment = analog_data->analog_segments().at(segment_id);
+	} catch (out_of_range&) {
+		return;
+	}
+
+	// Segments that are still being acquired are converted as the data
+	// comes in anyway
+	if (!asegment->is_complete())
+		return;
+
+	const uint64_t sample_count = asegment->get_sample_count();
+	end_sample = min(end_sample, sample_count);
+
+	// Start on a block boundary so that the envelope can be used
+	start_sample -= start_sample % ConversionBlockSize;
+
+	// Nothing to gain if the sequential conversion reaches the range right
+	// away or if most of the segment is visible
+	if ((start_sample < ConversionBlockSize) || (end_sample <= start_sample) ||
+		((end_sample - start_sample) > (sample_count / 2)))
+		return;
+
+	if (!conversion_preview_data_)
+		conversion_preview_data_ = make_shared<Logic>(1);  // Contains only one channel
+
+	shared_ptr<LogicSegment> preview = make_shared<LogicSegment>(
+		*conversion_preview_data_.get(), segment_id, 1, asegment->samplerate());
+
+	{
+		lock_guard<mutex> lock(conversion_focus_mutex_);
+		conversion_preview_ = preview;
+		conversion_preview_offset_ = start_sample;
+	}
+
+	// The preview isn't part of the converted data, so don't report its
+	// samples as new samples
+	convert_single_segment_range(asegment, preview, start_sample, end_sample, true);
+}
+
 void SignalBase::conversion_thread_proc()
 {
 	shared_ptr<Analog> analog_data;
@@ -788,6 +929,9 @@ void SignalBase::conversion_thread_proc()
 	if (conversion_interrupt_)
 		return;
 
+	// Convert the range the user is looking at first, then fill in the rest
+	convert_focus_range(analog_data);
+
 	uint32_t segment_id = 0;
 
 	shared_ptr<AnalogSegment> asegment = analog_data->analog_segments().front();
@@ -855,6 +999,11 @@ void SignalBase::start_conversion(bool delayed_start)
 
 	stop_conversion();
 
+	{
+		lock_guard<mutex> lock(conversion_focus_mutex_);
+		conversion_preview_.reset();
+	}
+
 	if (converted_data_ && (converted_data_->get_segment_count() > 0)) {
 		converted_data_->clear();
 		samples_cleared();
@@ -864,6 +1013,29 @@ void SignalBase::start_conversion(bool delayed_start)
 	conversion_thread_ = std::thread(&SignalBase::conversion_thread_proc, this);
 }
 
+void SignalBase::set_conversion_focus(uint32_t segment_id,
+	uint64_t start_sample, uint64_t end_sample)
+{
+	lock_guard<mutex> lock(conversion_focus_mutex_);
+
+	conversion_focus_segment_ = segment_id;
+	conversion_focus_start_ = start_sample;
+	conversion_focus_end_ = end_sample;
+}
+
+shared_ptr<LogicSegment> SignalBase::get_conversion_preview(uint32_t segment_id,
+	uint64_t &offset) const
+{
+	lock_guard<mutex> lock(conversion_focus_mutex_);
+
+	if (!conversion_preview_ || (conversion_preview_->segment_id() != segment_id))
+		return nullptr;
+
+	offset = conversion_preview_offset_;
+
+	return conversion_preview_;
+}
+
 void SignalBase::set_error_message(QString msg)
 {
 	error_message_ = msg;
@@ -884,6 +1056,11 @@ void SignalBase::stop_conversion()
 
 void SignalBase::on_samples_cleared()
 {
+	{
+		lock_guard<mutex> lock(conversion_focus_mutex_);
+		conversion_preview_.reset();
+	}
+
 	if (converted_data_ && (converted_data_->get_segment_count() > 0)) {
 		converted_data_->clear();
 		samples_cleared();
@@ -357,6 +357,28 @@ public:
 
 	void start_conversion(bool delayed_start=false);
 
+	/**
+	 * Sets the sample range of a segment that is currently being looked at.
+	 * When the conversion is (re-)started, this range is converted before
+	 * the rest of the segment so that the visible part updates quickly,
+	 * even for very long segments.
+	 */
+	void set_conversion_focus(uint32_t segment_id, uint64_t start_sample,
+		uint64_t end_sample);
+
+	/**
+	 * Returns the converted data of the focus range if the conversion of
+	 * the given segment hasn't caught up with it yet, nullptr otherwise.
+	 *
+	 * @param segment_id the segment to query
+	 * @param[out] offset the sample number of the first sample contained
+	 *        in the returned segment
+	 *
+	 * @return the logic segment holding the converted focus range
+	 */
+	shared_ptr<LogicSegment> get_conversion_preview(uint32_t segment_id,
+		uint64_t &offset) const;
+
 protected:
 	virtual void set_error_message(QString msg);
 
@@ -369,8 +391,16 @@ private:
 	uint8_t convert_a2l_schmitt_trigger(float lo_thr, float hi_thr,
 		float value, uint8_t &state);
 
+	bool convert_block_by_envelope(shared_ptr<AnalogSegment> asegment,
+		uint64_t start_sample, uint64_t sample_count,
+		const vector<double> &thresholds, uint8_t &state, uint8_t *lsamples) const;
+	uint8_t get_schmitt_trigger_state(shared_ptr<AnalogSegment> asegment,
+		uint64_t sample_num, float lo_thr, float hi_thr) const;
+
+	void convert_focus_range(shared_ptr<Analog> analog_data);
 	void convert_single_segment_range(shared_ptr<AnalogSegment> asegment,
-		shared_ptr<LogicSegment> lsegment, uint64_t start_sample, uint64_t end_sample);
+		shared_ptr<LogicSegment> lsegment, uint64_t start_sample, uint64_t end_sample,
+		bool is_preview = false);
 	void convert_single_segment(shared_ptr<AnalogSegment> asegment,
 		shared_ptr<LogicSegment> lsegment);
 	void conversion_thread_proc();
@@ -385,9 +415,16 @@ Q_SIGNALS:
 	void samples_cleared();
 	void samples_added(uint64_t segment_id, uint64_t start_sample,
 		uint64_t end_sample);
+	/// Emitted when the converted preview of the visible range has grown
+	void conversion_preview_updated();
 
 	void min_max_changed(float min, float max);
 
+	/// Emitted before set_data() replaces the data, consumers must stop using it
+	void data_about_to_change();
+	/// Emitted after set_data() replaced the data
+	void data_changed();
+
 private Q_SLOTS:
 	void on_samples_cleared();
 
@@ -419,6 +456,13 @@ protected:
 	condition_variable conversion_input_cond_;
 	QTimer delayed_conversion_starter_;
 
+	mutable mutex conversion_focus_mutex_;
+	uint32_t conversion_focus_segment_;
+	uint64_t conversion_focus_start_, conversion_focus_end_;
+	shared_ptr<pv::data::Logic> conversion_preview_data_;
+	shared_ptr<LogicSegment> conversion_preview_;
+	uint64_t conversion_preview_offset_;
+
 	QString internal_name_, name_;
 	QColor color_, bgcolor_;
 	unsigned int index_;
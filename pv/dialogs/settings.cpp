@@ -426,6 +426,25 @@ QWidget *Settings::get_decoder_settings_form(QWidget *parent)
 		SLOT(on_dec_alwaysshowallrows_changed(int)));
 	decoder_layout->addRow(tr("Always show all &rows, even if no annotation is visible"), cb);
 
+	QCheckBox *out_of_process_cb = create_checkbox(GlobalSettings::Key_Dec_OutOfProcess,
+		SLOT(on_dec_outOfProcess_changed(int)));
+	decoder_layout->addRow(tr("Run decoders in separate &processes"), out_of_process_cb);
+
+	// Decoders running in this process can't decode the parts in parallel
+	cb = create_checkbox(GlobalSettings::Key_Dec_SplitSegments,
+		SLOT(on_dec_splitSegments_changed(int)));
+	cb->setEnabled(out_of_process_cb->isChecked());
+	connect(out_of_process_cb, SIGNAL(toggled(bool)), cb, SLOT(setEnabled(bool)));
+	decoder_layout->addRow(tr("Decode long captures in parallel, split at idle &gaps"), cb);
+
+	cb = create_checkbox(GlobalSettings::Key_Dec_CacheResults,
+		SLOT(on_dec_cacheResults_changed(int)));
+	decoder_layout->addRow(tr("&Cache decoder results on disk"), cb);
+
+	cb = create_checkbox(GlobalSettings::Key_Dec_SpillAnnotations,
+		SLOT(on_dec_spillAnnotations_changed(int)));
+	decoder_layout->addRow(tr("Keep older annotations of long decodes on &disk"), cb);
+
 	// Annotation export settings
 	ann_export_format_ = new QLineEdit();
 	ann_export_format_->setText(
@@ -823,6 +842,30 @@ void Settings::on_dec_alwaysshowallrows_changed(int state)
 	GlobalSettings settings;
 	settings.setValue(GlobalSettings::Key_Dec_AlwaysShowAllRows, state ? true : false);
 }
+
+void Settings::on_dec_outOfProcess_changed(int state)
+{
+	GlobalSettings settings;
+	settings.setValue(GlobalSettings::Key_Dec_OutOfProcess, state ? true : false);
+}
+
+void Settings::on_dec_splitSegments_changed(int state)
+{
+	GlobalSettings settings;
+	settings.setValue(GlobalSettings::Key_Dec_SplitSegments, state ? true : false);
+}
+
+void Settings::on_dec_cacheResults_changed(int state)
+{
+	GlobalSettings settings;
+	settings.setValue(GlobalSettings::Key_Dec_CacheResults, state ? true : false);
+}
+
+void Settings::on_dec_spillAnnotations_changed(int state)
+{
+	GlobalSettings settings;
+	settings.setValue(GlobalSettings::Key_Dec_SpillAnnotations, state ? true : false);
+}
 #endif
 
 void Settings::on_log_logLevel_changed(int value)
@@ -84,6 +84,10 @@ private Q_SLOTS:
 	void on_dec_initialStateConfigurable_changed(int state);
 	void on_dec_exportFormat_changed(const QString &text);
 	void on_dec_alwaysshowallrows_changed(int state);
+	void on_dec_outOfProcess_changed(int state);
+	void on_dec_splitSegments_changed(int state);
+	void on_dec_cacheResults_changed(int state);
+	void on_dec_spillAnnotations_changed(int state);
 #endif
 	void on_log_logLevel_changed(int value);
 	void on_log_bufferSize_changed(int value);
@@ -76,6 +76,10 @@ const QString GlobalSettings::Key_View_CursorShowSamples = "View_CursorShowSampl
 const QString GlobalSettings::Key_Dec_InitialStateConfigurable = "Dec_InitialStateConfigurable";
 const QString GlobalSettings::Key_Dec_ExportFormat = "Dec_ExportFormat";
 const QString GlobalSettings::Key_Dec_AlwaysShowAllRows = "Dec_AlwaysShowAllRows";
+const QString GlobalSettings::Key_Dec_OutOfProcess = "Dec_OutOfProcess";
+const QString GlobalSettings::Key_Dec_SplitSegments = "Dec_SplitSegments";
+const QString GlobalSettings::Key_Dec_CacheResults = "Dec_CacheResults";
+const QString GlobalSettings::Key_Dec_SpillAnnotations = "Dec_SpillAnnotations";
 const QString GlobalSettings::Key_Log_BufferSize = "Log_BufferSize";
 const QString GlobalSettings::Key_Log_NotifyOfStacktrace = "Log_NotifyOfStacktrace";
 
@@ -81,6 +81,10 @@ public:
 	static const QString Key_Dec_InitialStateConfigurable;
 	static const QString Key_Dec_ExportFormat;
 	static const QString Key_Dec_AlwaysShowAllRows;
+	static const QString Key_Dec_OutOfProcess;
+	static const QString Key_Dec_SplitSegments;
+	static const QString Key_Dec_CacheResults;
+	static const QString Key_Dec_SpillAnnotations;
 	static const QString Key_Log_BufferSize;
 	static const QString Key_Log_NotifyOfStacktrace;
 
@@ -1040,6 +1040,11 @@ void Session::remove_decode_signal(shared_ptr<data::DecodeSignal> signal)
 
 	signals_changed();
 }
+
+data::decode::MuxCache& Session::mux_cache()
+{
+	return mux_cache_;
+}
 #endif
 
 bool Session::all_segments_complete(uint32_t segment_id) const
@@ -47,6 +47,10 @@
 #include <libsigrokflow/libsigrokflow.hpp>
 #endif
 
+#ifdef ENABLE_DECODE
+#include "data/decode/muxcache.hpp"
+#endif
+
 #include "metadata_obj.hpp"
 #include "util.hpp"
 #include "views/viewbase.hpp"
@@ -209,6 +213,11 @@ public:
 	shared_ptr<data::DecodeSignal> add_decode_signal();
 
 	void remove_decode_signal(shared_ptr<data::DecodeSignal> signal);
+
+	/**
+	 * Returns the muxed decoder input shared by the session's decode signals.
+	 */
+	data::decode::MuxCache& mux_cache();
 #endif
 
 	bool all_segments_complete(uint32_t segment_id) const;
@@ -319,6 +328,10 @@ private:
 
 	MetadataObjManager metadata_obj_manager_;
 
+#ifdef ENABLE_DECODE
+	data::decode::MuxCache mux_cache_;
+#endif
+
 #ifdef ENABLE_FLOW
 	RefPtr<Pipeline> pipeline_;
 	RefPtr<Element> source_;
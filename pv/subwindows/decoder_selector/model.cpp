@@ -21,14 +21,13 @@
 
 #include "subwindow.hpp"
 
-#include <libsigrokdecode/libsigrokdecode.h>
-
-#define DECODERS_HAVE_TAGS \
-	((SRD_PACKAGE_VERSION_MAJOR > 0) || \
-	 (SRD_PACKAGE_VERSION_MAJOR == 0) && (SRD_PACKAGE_VERSION_MINOR > 5))
+#include "pv/data/decode/decoderindex.hpp"
 
 using std::make_shared;
 
+using pv::data::decode::DecoderIndex;
+using pv::data::decode::DecoderInfo;
+
 namespace pv {
 namespace subwindows {
 namespace decoder_selector {
@@ -55,13 +54,10 @@ DecoderCollectionModel::DecoderCollectionModel(QObject* parent) :
 		make_shared<DecoderCollectionItem>(item_data, root_);
 	root_->appendSubItem(group_item_all);
 
-	for (GSList* li = (GSList*)srd_decoder_list(); li; li = li->next) {
-		const srd_decoder *const d = (srd_decoder*)li->data;
-		assert(d);
-
-		const QString id = QString::fromUtf8(d->id);
-		const QString name = QString::fromUtf8(d->name);
-		const QString long_name = QString::fromUtf8(d->longname);
+	for (const DecoderInfo& d : DecoderIndex::decoders()) {
+		const QString id = d.id;
+		const QString name = d.name;
+		const QString long_name = d.longname;
 
 		// Add decoder to the "all decoders" group
 		item_data.clear();
@@ -73,9 +69,8 @@ DecoderCollectionModel::DecoderCollectionModel(QObject* parent) :
 		group_item_all->appendSubItem(decoder_item_all);
 
 		// Add decoder to all relevant groups using the tag information
-#if DECODERS_HAVE_TAGS
-		for (GSList* ti = (GSList*)d->tags; ti; ti = ti->next) {
-			const QString tag = tr((char*)ti->data);
+		for (const QString& tag_id : d.tags) {
+			const QString tag = tr(tag_id.toUtf8());
 			const QVariant tag_var = QVariant(tag);
 
 			// Find tag group and create it if it doesn't exist yet
@@ -104,7 +99,6 @@ DecoderCollectionModel::DecoderCollectionModel(QObject* parent) :
 			// Add decoder to tag group
 			group_item->appendSubItem(decoder_item);
 		}
-#endif
 	}
 }
 
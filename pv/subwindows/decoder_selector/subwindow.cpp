@@ -30,6 +30,7 @@
 #include <QVBoxLayout>
 
 #include "pv/session.hpp"
+#include "pv/data/decode/decoderindex.hpp"
 #include "pv/subwindows/decoder_selector/subwindow.hpp"
 
 #include <libsigrokdecode/libsigrokdecode.h>
@@ -41,6 +42,9 @@
 
 using std::reverse;
 
+using pv::data::decode::DecoderIndex;
+using pv::data::decode::DecoderInfo;
+
 namespace pv {
 namespace subwindows {
 namespace decoder_selector {
@@ -191,35 +195,29 @@ int SubWindow::minimum_width() const
 	return label_width + min_width_margin;
 }
 
-vector<const char*> SubWindow::get_decoder_inputs(const srd_decoder* d) const
+QStringList SubWindow::get_decoder_inputs(const DecoderInfo* d) const
 {
-	vector<const char*> ret_val;
-
-	for (GSList* li = d->inputs; li; li = li->next)
-		ret_val.push_back((const char*)li->data);
-
-	return ret_val;
+	return d->inputs;
 }
 
-vector<const srd_decoder*> SubWindow::get_decoders_providing(const char* output) const
+vector<const DecoderInfo*> SubWindow::get_decoders_providing(const QString& output) const
 {
-	vector<const srd_decoder*> ret_val;
-
-	for (GSList* li = (GSList*)srd_decoder_list(); li; li = li->next) {
-		const srd_decoder* d = (srd_decoder*)li->data;
-		assert(d);
+	return DecoderIndex::decoders_providing(output);
+}
 
-		if (!d->outputs)
-			continue;
+void SubWindow::add_decoders(const vector<const DecoderInfo*>& decoders)
+{
+	vector<const srd_decoder*> srd_decoders;
 
-		const int maxlen = 1024;
+	for (const DecoderInfo* d : decoders) {
+		const srd_decoder* srd_dec = DecoderIndex::get_decoder(d->id);
+		if (!srd_dec)
+			return;
 
-		// TODO For now we ignore that d->outputs is actually a list
-		if (strncmp((char*)(d->outputs->data), output, maxlen) == 0)
-			ret_val.push_back(d);
+		srd_decoders.push_back(srd_dec);
 	}
 
-	return ret_val;
+	new_decoders_selected(srd_decoders);
 }
 
 void SubWindow::on_item_changed(const QModelIndex& index)
@@ -234,21 +232,21 @@ void SubWindow::on_item_changed(const QModelIndex& index)
 		if (decoder_name.isEmpty())
 			return;
 
-		const srd_decoder* d = srd_decoder_get_by_id(decoder_name.toUtf8());
+		const DecoderInfo* d = DecoderIndex::find(decoder_name);
+		if (!d)
+			return;
 
-		id = QString::fromUtf8(d->id);
-		longname = QString::fromUtf8(d->longname);
-		desc = QString::fromUtf8(d->desc);
-		doc = QString::fromUtf8(srd_decoder_doc_get(d)).trimmed();
+		id = d->id;
+		longname = d->longname;
+		desc = d->desc;
+		doc = d->doc;
 
-#if DECODERS_HAVE_TAGS
-		for (GSList* li = (GSList*)d->tags; li; li = li->next) {
-			QString s = (li == (GSList*)d->tags) ?
-				tr((char*)li->data) :
-				QString(tr(", %1")).arg(tr((char*)li->data));
+		for (const QString& tag : d->tags) {
+			QString s = tags.isEmpty() ?
+				tr(tag.toUtf8()) :
+				QString(tr(", %1")).arg(tr(tag.toUtf8()));
 			tags.append(s);
 		}
-#endif
 	} else
 		doc = QString(tr(initial_notice));
 
@@ -275,33 +273,33 @@ void SubWindow::on_item_activated(const QModelIndex& index)
 	QModelIndex id_index = index.model()->index(index.row(), 2, index.parent());
 	QString decoder_name = index.model()->data(id_index, Qt::DisplayRole).toString();
 
-	const srd_decoder* chosen_decoder = srd_decoder_get_by_id(decoder_name.toUtf8());
+	const DecoderInfo* chosen_decoder = DecoderIndex::find(decoder_name);
 	if (chosen_decoder == nullptr)
 		return;
 
-	vector<const srd_decoder*> decoders;
+	vector<const DecoderInfo*> decoders;
 	decoders.push_back(chosen_decoder);
 
 	// If the decoder only depends on logic inputs, we add it and are done
-	vector<const char*> inputs = get_decoder_inputs(decoders.front());
+	QStringList inputs = get_decoder_inputs(decoders.front());
 	if (inputs.size() == 0) {
 		qWarning() << "Protocol decoder" << decoder_name << "cannot have 0 inputs!";
 		return;
 	}
 
-	if (strcmp(inputs.at(0), "logic") == 0) {
-		new_decoders_selected(decoders);
+	if (inputs.at(0) == "logic") {
+		add_decoders(decoders);
 		return;
 	}
 
 	// Check if we can automatically fulfill the stacking requirements
-	while (strcmp(inputs.at(0), "logic") != 0) {
-		vector<const srd_decoder*> prov_decoders = get_decoders_providing(inputs.at(0));
+	while (inputs.at(0) != "logic") {
+		vector<const DecoderInfo*> prov_decoders = get_decoders_providing(inputs.at(0));
 
 		if (prov_decoders.size() == 0) {
 			// Emit warning and add the stack that we could gather so far
-			qWarning() << "Protocol decoder" << QString::fromUtf8(decoders.back()->id) \
-				<< "has input that no other decoder provides:" << QString::fromUtf8(inputs.at(0));
+			qWarning() << "Protocol decoder" << decoders.back()->id \
+				<< "has input that no other decoder provides:" << inputs.at(0);
 			break;
 		}
 
@@ -311,11 +309,11 @@ void SubWindow::on_item_activated(const QModelIndex& index)
 			// Let user decide which one to use
 			QString caption = QString(tr("Protocol decoder <b>%1</b> requires input type <b>%2</b> " \
 				"which several decoders provide.<br>Choose which one to use:<br>"))
-					.arg(QString::fromUtf8(decoders.back()->id), QString::fromUtf8(inputs.at(0)));
+					.arg(decoders.back()->id, inputs.at(0));
 
 			QStringList items;
-			for (const srd_decoder* d : prov_decoders)
-				items << QString::fromUtf8(d->id) + " (" + QString::fromUtf8(d->longname) + ")";
+			for (const DecoderInfo* d : prov_decoders)
+				items << d->id + " (" + d->longname + ")";
 			bool ok_clicked;
 			QString item = QInputDialog::getItem(this, tr("Choose Decoder"),
 				tr(caption.toUtf8()), items, 0, false, &ok_clicked);
@@ -324,7 +322,10 @@ void SubWindow::on_item_activated(const QModelIndex& index)
 				return;
 
 			QString d = item.section(' ', 0, 0);
-			decoders.push_back(srd_decoder_get_by_id(d.toUtf8()));
+			const DecoderInfo* chosen = DecoderIndex::find(d);
+			if (!chosen)
+				return;
+			decoders.push_back(chosen);
 		}
 
 		inputs = get_decoder_inputs(decoders.back());
@@ -332,7 +333,7 @@ void SubWindow::on_item_activated(const QModelIndex& index)
 
 	// Reverse decoder list and add the stack
 	reverse(decoders.begin(), decoders.end());
-	new_decoders_selected(decoders);
+	add_decoders(decoders);
 }
 
 void SubWindow::on_filter_changed(const QString& text)
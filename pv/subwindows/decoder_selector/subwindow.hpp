@@ -33,6 +33,13 @@
 using std::shared_ptr;
 
 namespace pv {
+
+namespace data {
+namespace decode {
+struct DecoderInfo;
+}
+}
+
 namespace subwindows {
 namespace decoder_selector {
 
@@ -118,13 +125,20 @@ public:
 	 * Returns a list of input types that a given protocol decoder requires
 	 * ("logic", "uart", etc.)
 	 */
-	vector<const char*> get_decoder_inputs(const srd_decoder* d) const;
+	QStringList get_decoder_inputs(const data::decode::DecoderInfo* d) const;
 
 	/**
 	 * Returns a list of protocol decoder IDs which provide a given output
 	 * ("uart", "spi", etc.)
 	 */
-	vector<const srd_decoder*> get_decoders_providing(const char* output) const;
+	vector<const data::decode::DecoderInfo*> get_decoders_providing(
+		const QString& output) const;
+
+private:
+	/**
+	 * Loads the modules of the given decoders and adds them as a stack
+	 */
+	void add_decoders(const vector<const data::decode::DecoderInfo*>& decoders);
 
 Q_SIGNALS:
 	void new_decoders_selected(vector<const srd_decoder*> decoders);
@@ -95,13 +95,7 @@ void QHexView::set_data(const DecodeBinaryClass* data)
 {
 	data_ = data;
 
-	size_t size = 0;
-	if (data) {
-		size_t chunks = data_->chunks.size();
-		for (size_t i = 0; i < chunks; i++)
-			size += data_->chunks[i].data.size();
-	}
-	data_size_ = size;
+	data_size_ = data ? data_->data.size() : 0;
 
 	address_digits_ = (uint8_t)QString::number(data_size_, 16).length();
 
@@ -221,31 +215,24 @@ size_t QHexView::create_hex_line(size_t start, size_t end, QString* dest,
 
 void QHexView::initialize_byte_iterator(size_t offset)
 {
-	current_chunk_id_ = 0;
-	current_chunk_offset_ = 0;
 	current_offset_ = offset;
+	set_current_chunk(data_->data.chunk_at_offset(offset));
+}
 
-	size_t chunks = data_->chunks.size();
-	for (size_t i = 0; i < chunks; i++) {
-		size_t size = data_->chunks[i].data.size();
-
-		if (offset >= size) {
-			current_chunk_id_++;
-			offset -= size;
-		} else {
-			current_chunk_offset_ = offset;
-			break;
-		}
-	}
+void QHexView::set_current_chunk(size_t chunk_id)
+{
+	const BinaryData& data = data_->data;
 
-	if (current_chunk_id_ < data_->chunks.size())
-		current_chunk_ = data_->chunks[current_chunk_id_];
+	current_chunk_id_ = chunk_id;
+	current_chunk_offset_ = current_offset_ - data.chunk_offset(chunk_id);
+	current_chunk_size_ = data.chunk_size(chunk_id);
 
-	current_chunk_sample_ = current_chunk_.sample;
+	current_chunk_sample_ = (chunk_id < data.chunk_count()) ?
+		data.chunk_sample(chunk_id) : 0;
 
 	// Obtain sample of next chunk if there is one
-	if ((current_chunk_id_ + 1) < data_->chunks.size())
-		next_chunk_sample_ = data_->chunks[current_chunk_id_ + 1].sample;
+	if ((chunk_id + 1) < data.chunk_count())
+		next_chunk_sample_ = data.chunk_sample(chunk_id + 1);
 	else
 		next_chunk_sample_ = std::numeric_limits<uint64_t>::max();
 }
@@ -256,18 +243,8 @@ uint8_t QHexView::get_next_byte(bool* is_new_chunk)
 		*is_new_chunk = (current_chunk_offset_ == 0);
 
 	uint8_t v = 0;
-	if (current_chunk_offset_ < current_chunk_.data.size())
-		v = current_chunk_.data[current_chunk_offset_];
-
-	current_chunk_sample_ = current_chunk_.sample;
-
-	if (is_new_chunk) {
-		// Obtain sample of next chunk if there is one
-		if ((current_chunk_id_ + 1) < data_->chunks.size())
-			next_chunk_sample_ = data_->chunks[current_chunk_id_ + 1].sample;
-		else
-			next_chunk_sample_ = std::numeric_limits<uint64_t>::max();
-	}
+	if (current_chunk_offset_ < current_chunk_size_)
+		v = data_->data.byte_at(current_offset_);
 
 	current_offset_++;
 	current_chunk_offset_++;
@@ -278,11 +255,9 @@ uint8_t QHexView::get_next_byte(bool* is_new_chunk)
 		return 0xEE;
 	}
 
-	if ((current_chunk_offset_ == current_chunk_.data.size()) && (current_offset_ < data_size_)) {
-		current_chunk_id_++;
-		current_chunk_offset_ = 0;
-		current_chunk_ = data_->chunks[current_chunk_id_];
-	}
+	// Empty chunks are skipped as they don't hold any bytes
+	if ((current_chunk_offset_ == current_chunk_size_) && (current_offset_ < data_size_))
+		set_current_chunk(data_->data.chunk_at_offset(current_offset_));
 
 	return v;
 }
@@ -334,7 +309,7 @@ void QHexView::paintEvent(QPaintEvent *event)
 	// Fill widget background
 	painter.fillRect(event->rect(), palette().color(QPalette::Base));
 
-	if (!data_ || (data_size_ == 0) || (data_->chunks.empty())) {
+	if (!data_ || (data_size_ == 0) || (data_->data.chunk_count() == 0)) {
 		painter.setPen(palette().color(QPalette::Text));
 		QString s = tr("No data available");
 		int x = (areaSize.width() - fontMetrics().boundingRect(s).width()) / 2;
@@ -386,7 +361,7 @@ void QHexView::paintEvent(QPaintEvent *event)
 	QBrush selected_brush = palette().highlight();
 	QBrush visible_range_brush = QBrush(visible_range_color_);
 
-	bool multiple_chunks = (data_->chunks.size() > 1);
+	bool multiple_chunks = (data_->data.chunk_count() > 1);
 	unsigned int chunk_color = 0;
 
 	initialize_byte_iterator(firstLineIdx * BYTES_PER_LINE);
@@ -37,7 +37,7 @@
 using std::pair;
 using std::size_t;
 using pv::data::DecodeBinaryClass;
-using pv::data::DecodeBinaryDataChunk;
+using pv::data::decode::BinaryData;
 
 class QHexView: public QAbstractScrollArea
 {
@@ -74,6 +74,7 @@ public:
 
 protected:
 	void initialize_byte_iterator(size_t offset);
+	void set_current_chunk(size_t chunk_id);
 	uint8_t get_next_byte(bool* is_new_chunk = nullptr);
 
 	void paintEvent(QPaintEvent *event);
@@ -100,8 +101,7 @@ private:
 	size_t selectBegin_, selectEnd_, selectInit_, cursorPos_;
 	uint8_t address_digits_;
 
-	size_t current_chunk_id_, current_chunk_offset_, current_offset_;
-	DecodeBinaryDataChunk current_chunk_; // Cache locally so that we're not messed up when the vector is re-allocating its data
+	size_t current_chunk_id_, current_chunk_offset_, current_chunk_size_, current_offset_;
 	uint64_t current_chunk_sample_, next_chunk_sample_;
 
 	pair<uint64_t, uint64_t> visible_range_;
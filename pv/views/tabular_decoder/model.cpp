@@ -185,7 +185,7 @@ QModelIndex AnnotationCollectionModel::index(int row, int column,
 	QModelIndex idx;
 
 	if ((size_t)row < dataset_->size())
-		idx = createIndex(row, column, (void*)dataset_->at(row));
+		idx = createIndex(row, column, (void*)&(dataset_->at(row)));
 
 	return idx;
 }
@@ -299,8 +299,8 @@ void AnnotationCollectionModel::update_annotations_without_hidden()
 		return;
 	}
 
-	for (const Annotation* ann : *all_annotations_) {
-		if (!ann->visible())
+	for (const Annotation& ann : *all_annotations_) {
+		if (!ann.visible())
 			continue;
 
 		if (all_annotations_without_hidden_.size() < (count + 100))
@@ -453,7 +453,7 @@ void View::on_selected_decoder_changed(int index)
 {
 	if (signal_) {
 		disconnect(signal_, SIGNAL(color_changed(QColor)));
-		disconnect(signal_, SIGNAL(new_annotations()));
+		disconnect(signal_, SIGNAL(annotations_updated(unsigned int, uint64_t, uint64_t)));
 		disconnect(signal_, SIGNAL(decode_reset()));
 	}
 
@@ -469,7 +469,8 @@ void View::on_selected_decoder_changed(int index)
 
 	if (signal_) {
 		connect(signal_, SIGNAL(color_changed(QColor)), this, SLOT(on_signal_color_changed(QColor)));
-		connect(signal_, SIGNAL(new_annotations()), this, SLOT(on_new_annotations()));
+		connect(signal_, SIGNAL(annotations_updated(unsigned int, uint64_t, uint64_t)),
+			this, SLOT(on_annotations_updated(unsigned int, uint64_t, uint64_t)));
 		connect(signal_, SIGNAL(decode_reset()), this, SLOT(on_decoder_reset()));
 	}
 
@@ -543,8 +544,16 @@ void View::on_signal_color_changed(const QColor &color)
 	table_view_->viewport()->update();
 }
 
-void View::on_new_annotations()
+void View::on_annotations_updated(unsigned int segment_id, uint64_t start_sample,
+	uint64_t end_sample)
 {
+	(void)start_sample;
+	(void)end_sample;
+
+	// Only the annotations of the segment that is shown matter
+	if (segment_id != current_segment_)
+		return;
+
 	if (view_mode_selector_->currentIndex() == ViewModeLatest) {
 		update_data();
 		table_view_->scrollTo(
@@ -93,9 +93,9 @@ private Q_SLOTS:
 
 private:
 	vector<QVariant> header_data_;
-	const deque<const Annotation*>* all_annotations_;
-	deque<const Annotation*> all_annotations_without_hidden_;
-	const deque<const Annotation*>* dataset_;
+	const deque<Annotation>* all_annotations_;
+	deque<Annotation> all_annotations_without_hidden_;
+	const deque<Annotation>* dataset_;
 	data::DecodeSignal* signal_;
 	uint8_t first_hidden_column_;
 	uint32_t prev_segment_;
@@ -178,7 +178,8 @@ private Q_SLOTS:
 
 	void on_signal_name_changed(const QString &name);
 	void on_signal_color_changed(const QColor &color);
-	void on_new_annotations();
+	void on_annotations_updated(unsigned int segment_id, uint64_t start_sample,
+		uint64_t end_sample);
 
 	void on_decoder_reset();
 	void on_decoder_stacked(void* decoder);
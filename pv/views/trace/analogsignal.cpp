@@ -284,7 +284,7 @@ void AnalogSignal::paint_mid(QPainter &p, ViewItemPaintParams &pp)
 
 	if ((display_type_ == DisplayConverted) || (display_type_ == DisplayBoth))
 		if (base_->logic_data())
-			LogicSignal::paint_mid(p, pp);
+			paint_converted(p, pp);
 
 	const QString err = base_->get_error_message();
 	if (!err.isEmpty())
@@ -532,6 +532,46 @@ void AnalogSignal::paint_envelope(QPainter &p,
 	delete[] e.samples;
 }
 
+void AnalogSignal::paint_converted(QPainter &p, ViewItemPaintParams &pp)
+{
+	shared_ptr<pv::data::AnalogSegment> asegment = get_analog_segment_to_paint();
+	if (!asegment || (asegment->get_sample_count() == 0))
+		return;
+
+	const double samplerate = max(1.0, asegment->samplerate());
+	const pv::util::Timestamp& start_time = asegment->start_time();
+	const int64_t sample_count = asegment->get_sample_count();
+	const double samples_per_pixel = samplerate * pp.scale();
+	const pv::util::Timestamp start = samplerate * (pp.offset() - start_time);
+	const pv::util::Timestamp end = start + samples_per_pixel * pp.width();
+
+	const int64_t start_sample = min(max(floor(start).convert_to<int64_t>(),
+		(int64_t)0), sample_count);
+	const int64_t end_sample = min(max(ceil(end).convert_to<int64_t>(),
+		(int64_t)0), sample_count);
+
+	// Let the conversion know which part of the signal to convert first
+	base_->set_conversion_focus(asegment->segment_id(), start_sample, end_sample);
+
+	shared_ptr<LogicSegment> segment = get_logic_segment_to_paint();
+	const int64_t converted_count = segment ? segment->get_sample_count() : 0;
+
+	// Paint the converted focus range until the conversion caught up with it
+	if (converted_count < end_sample) {
+		uint64_t offset = 0;
+		shared_ptr<LogicSegment> preview =
+			base_->get_conversion_preview(asegment->segment_id(), offset);
+
+		if (preview && (preview->get_sample_count() > 0)) {
+			paint_logic_segment(p, pp, preview, offset);
+			return;
+		}
+	}
+
+	if (converted_count > 0)
+		paint_logic_segment(p, pp, segment, 0);
+}
+
 shared_ptr<pv::data::AnalogSegment> AnalogSignal::get_analog_segment_to_paint() const
 {
 	shared_ptr<pv::data::AnalogSegment> segment;
@@ -117,6 +117,8 @@ private:
 		int y, int left, const int64_t start, const int64_t end,
 		const double pixels_offset, const double samples_per_pixel);
 
+	void paint_converted(QPainter &p, ViewItemPaintParams &pp);
+
 	shared_ptr<pv::data::AnalogSegment> get_analog_segment_to_paint() const;
 
 	/**
@@ -125,7 +127,6 @@ private:
 	float get_resolution(int scale_index);
 
 	void update_scale();
-	virtual void update_logic_level_offsets();
 
 	void update_conversion_widgets();
 
@@ -146,6 +147,8 @@ private:
 protected:
 	void populate_popup_form(QWidget *parent, QFormLayout *form);
 
+	virtual void update_logic_level_offsets();
+
 	virtual void hover_point_changed(const QPoint &hp);
 
 private Q_SLOTS:
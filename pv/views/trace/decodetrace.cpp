@@ -35,12 +35,14 @@
 #include <QDebug>
 #include <QFileDialog>
 #include <QFormLayout>
+#include <QGroupBox>
 #include <QLabel>
 #include <QMenu>
 #include <QMessageBox>
 #include <QPushButton>
 #include <QTextStream>
 #include <QToolTip>
+#include <QVBoxLayout>
 
 #include "decodetrace.hpp"
 #include "view.hpp"
@@ -94,6 +96,7 @@ const int DecodeTrace::DrawPadding = 100;
 const int DecodeTrace::MaxTraceUpdateRate = 1; // No more than 1 Hz
 const int DecodeTrace::AnimationDurationInTicks = 7;
 const int DecodeTrace::HiddenRowHideDelay = 1000; // 1 second
+const int DecodeTrace::ProfileUpdateInterval = 500;
 
 /**
  * Helper function for forceUpdate()
@@ -313,7 +316,7 @@ void DecodeTrace::paint_mid(QPainter &p, ViewItemPaintParams &pp)
 			continue;
 		}
 
-		deque<const Annotation*> annotations;
+		deque<Annotation> annotations;
 		decode_signal_->get_annotation_subset(annotations, r.decode_row,
 			current_segment_, sample_range.first, sample_range.second);
 
@@ -465,6 +468,8 @@ void DecodeTrace::populate_popup_form(QWidget *parent, QFormLayout *form)
 
 		form->addRow(new QLabel(
 			tr("<i>* Required channels</i>"), parent));
+
+		create_profile_form(parent, form);
 	}
 
 	// Add stacking button
@@ -539,6 +544,19 @@ QMenu* DecodeTrace::create_view_context_menu(QWidget *parent, QPoint &click_pos)
 		menu->addAction(pause);
 	}
 
+	QAction *const decode_cursor_range =
+		new QAction(tr("Decode only within cursor range"), this);
+	connect(decode_cursor_range, SIGNAL(triggered()), this, SLOT(on_decode_cursor_range()));
+	decode_cursor_range->setEnabled(view->cursors()->enabled());
+	menu->addAction(decode_cursor_range);
+
+	if (decode_signal_->has_decode_range()) {
+		QAction *const decode_all =
+			new QAction(tr("Decode entire capture"), this);
+		connect(decode_all, SIGNAL(triggered()), this, SLOT(on_decode_all()));
+		menu->addAction(decode_all);
+	}
+
 	QAction *const copy_annotation_to_clipboard =
 		new QAction(tr("Copy annotation text to clipboard"), this);
 	copy_annotation_to_clipboard->setIcon(QIcon::fromTheme("edit-paste",
@@ -714,7 +732,7 @@ void DecodeTrace::mouse_left_press_event(const QMouseEvent* event)
 	}
 }
 
-void DecodeTrace::draw_annotations(deque<const Annotation*>& annotations,
+void DecodeTrace::draw_annotations(deque<Annotation>& annotations,
 		QPainter &p, const ViewItemPaintParams &pp, int y, const DecodeTraceRow& row)
 {
 	uint32_t block_class = 0;
@@ -722,7 +740,7 @@ void DecodeTrace::draw_annotations(deque<const Annotation*>& annotations,
 	qreal block_start = 0;
 	int block_ann_count = 0;
 
-	const Annotation* prev_ann;
+	Annotation prev_ann;
 	qreal prev_end = INT_MIN;
 
 	qreal a_end;
@@ -732,10 +750,10 @@ void DecodeTrace::draw_annotations(deque<const Annotation*>& annotations,
 		get_pixels_offset_samples_per_pixel();
 
 	// Gather all annotations that form a visual "block" and draw them as such
-	for (const Annotation* a : annotations) {
+	for (const Annotation& a : annotations) {
 
-		const qreal abs_a_start = a->start_sample() / samples_per_pixel;
-		const qreal abs_a_end   = a->end_sample() / samples_per_pixel;
+		const qreal abs_a_start = a.start_sample() / samples_per_pixel;
+		const qreal abs_a_end   = a.end_sample() / samples_per_pixel;
 
 		const qreal a_start = abs_a_start - pixels_offset;
 		a_end = abs_a_end - pixels_offset;
@@ -747,7 +765,7 @@ void DecodeTrace::draw_annotations(deque<const Annotation*>& annotations,
 
 		// Annotation wider than the threshold for a useful label width?
 		if (a_width >= min_useful_label_width_) {
-			for (const QString &ann_text : *(a->annotations())) {
+			for (const QString &ann_text : *(a.annotations())) {
 				const qreal w = p.boundingRect(QRectF(), 0, ann_text).width();
 				// Annotation wide enough to fit a label? Don't put it in a block then
 				if (w <= a_width) {
@@ -782,10 +800,10 @@ void DecodeTrace::draw_annotations(deque<const Annotation*>& annotations,
 
 			if (block_ann_count == 0) {
 				block_start = a_start;
-				block_class = a->ann_class_id();
+				block_class = a.ann_class_id();
 				block_class_uniform = true;
 			} else
-				if (a->ann_class_id() != block_class)
+				if (a.ann_class_id() != block_class)
 					block_class_uniform = false;
 
 			block_ann_count++;
@@ -799,23 +817,23 @@ void DecodeTrace::draw_annotations(deque<const Annotation*>& annotations,
 			block_class_uniform, p, y, row);
 }
 
-void DecodeTrace::draw_annotation(const Annotation* a, QPainter &p,
+void DecodeTrace::draw_annotation(const Annotation& a, QPainter &p,
 	const ViewItemPaintParams &pp, int y, const DecodeTraceRow& row) const
 {
 	double samples_per_pixel, pixels_offset;
 	tie(pixels_offset, samples_per_pixel) =
 		get_pixels_offset_samples_per_pixel();
 
-	const double start = a->start_sample() / samples_per_pixel - pixels_offset;
-	const double end = a->end_sample() / samples_per_pixel - pixels_offset;
+	const double start = a.start_sample() / samples_per_pixel - pixels_offset;
+	const double end = a.end_sample() / samples_per_pixel - pixels_offset;
 
-	p.setPen(a->dark_color());
-	p.setBrush(a->color());
+	p.setPen(a.dark_color());
+	p.setBrush(a.color());
 
 	if ((start > (pp.right() + DrawPadding)) || (end < (pp.left() - DrawPadding)))
 		return;
 
-	if (a->start_sample() == a->end_sample())
+	if (a.start_sample() == a.end_sample())
 		draw_instant(a, p, start, y);
 	else
 		draw_range(a, p, start, end, y, pp, row.title_width);
@@ -849,10 +867,10 @@ void DecodeTrace::draw_annotation_block(qreal start, qreal end,
 	}
 }
 
-void DecodeTrace::draw_instant(const Annotation* a, QPainter &p, qreal x, int y) const
+void DecodeTrace::draw_instant(const Annotation& a, QPainter &p, qreal x, int y) const
 {
-	const QString text = a->annotations()->empty() ?
-		QString() : a->annotations()->back();
+	const QString text = a.annotations()->empty() ?
+		QString() : a.annotations()->back();
 	const qreal w = min((qreal)p.boundingRect(QRectF(), 0, text).width(),
 		0.0) + annotation_height_;
 	const QRectF rect(x - w / 2, y - annotation_height_ / 2, w, annotation_height_);
@@ -863,13 +881,13 @@ void DecodeTrace::draw_instant(const Annotation* a, QPainter &p, qreal x, int y)
 	p.drawText(rect, Qt::AlignCenter | Qt::AlignVCenter, text);
 }
 
-void DecodeTrace::draw_range(const Annotation* a, QPainter &p,
+void DecodeTrace::draw_range(const Annotation& a, QPainter &p,
 	qreal start, qreal end, int y, const ViewItemPaintParams &pp,
 	int row_title_width) const
 {
 	const qreal top = y + .5 - annotation_height_ / 2;
 	const qreal bottom = y + .5 + annotation_height_ / 2;
-	const vector<QString>* annotations = a->annotations();
+	const vector<QString>* annotations = a.annotations();
 
 	// If the two ends are within 1 pixel, draw a vertical line
 	if (start + 1.0 > end) {
@@ -926,24 +944,50 @@ void DecodeTrace::draw_range(const Annotation* a, QPainter &p,
 
 void DecodeTrace::draw_unresolved_period(QPainter &p, int left, int right) const
 {
-	double samples_per_pixel, pixels_offset;
-
 	const int64_t sample_count = decode_signal_->get_working_sample_count(current_segment_);
 	if (sample_count == 0)
 		return;
 
+	// If only a decode range was decoded, everything around the parts
+	// that have been decoded so far is unresolved
+	if (decode_signal_->is_partially_decoded(current_segment_)) {
+		int64_t pos = 0;
+		for (const pair<int64_t, int64_t>& r :
+			decode_signal_->get_decoded_ranges(current_segment_)) {
+			if (r.first > pos)
+				draw_unresolved_range(p, left, right, pos, r.first);
+			pos = r.second;
+		}
+
+		if (pos < sample_count)
+			draw_unresolved_range(p, left, right, pos, sample_count);
+		return;
+	}
+
 	const int64_t samples_decoded = decode_signal_->get_decoded_sample_count(current_segment_, true);
 	if (sample_count == samples_decoded)
 		return;
 
+	draw_unresolved_range(p, left, right, samples_decoded, sample_count);
+}
+
+void DecodeTrace::draw_unresolved_range(QPainter &p, int left, int right,
+	int64_t start_sample, int64_t end_sample) const
+{
+	double samples_per_pixel, pixels_offset;
+
 	const int y = get_visual_y();
 
 	tie(pixels_offset, samples_per_pixel) = get_pixels_offset_samples_per_pixel();
 
-	const double start = max(samples_decoded /
+	const double start = max(start_sample /
 		samples_per_pixel - pixels_offset, left - 1.0);
-	const double end = min(sample_count / samples_per_pixel -
+	const double end = min(end_sample / samples_per_pixel -
 		pixels_offset, right + 1.0);
+
+	if (end <= start)
+		return;
+
 	const QRectF no_decode_rect(start, y - (annotation_height_ / 2) - 0.5,
 		end - start, annotation_height_);
 
@@ -1044,12 +1088,12 @@ const QString DecodeTrace::get_annotation_at_point(const QPoint &point)
 	if (point.y() > (int)(get_row_y(r) + (annotation_height_ / 2)))
 		return QString();
 
-	deque<const Annotation*> annotations;
+	deque<Annotation> annotations;
 
 	decode_signal_->get_annotation_subset(annotations, r->decode_row,
 		current_segment_, sample_range.first, sample_range.second);
 
-	const Annotation* a = annotations.empty() ? nullptr : annotations[0];
+	const Annotation* a = annotations.empty() ? nullptr : &(annotations[0]);
 
 	// Create a string of the format "CLASS: VALUE"
 	QString s;
@@ -1135,6 +1179,70 @@ void DecodeTrace::create_decoder_form(int index, shared_ptr<Decoder> &dec,
 	decoder_forms_.push_back(group);
 }
 
+void DecodeTrace::create_profile_form(QWidget *parent, QFormLayout *form)
+{
+	QGroupBox *const group = new QGroupBox(tr("Decode Profile"), parent);
+	QVBoxLayout *const layout = new QVBoxLayout(group);
+
+	QLabel *const label = new QLabel(format_profile(), group);
+	layout->addWidget(label);
+
+	// Keep the numbers current while the popup is shown. The timer belongs
+	// to the label, so it's destroyed along with the popup
+	QTimer *const timer = new QTimer(label);
+	connect(timer, &QTimer::timeout, label, [this, label]() {
+		label->setText(format_profile()); });
+	timer->start(ProfileUpdateInterval);
+
+	QPushButton *const export_button = new QPushButton(tr("Export..."), group);
+	export_button->setToolTip(tr("Save the profile as JSON file"));
+	connect(export_button, SIGNAL(clicked()), this, SLOT(on_export_profile()));
+	layout->addWidget(export_button, 0, Qt::AlignRight);
+
+	form->addRow(group);
+}
+
+QString DecodeTrace::format_profile() const
+{
+	const data::decode::Profiler::Snapshot profile = decode_signal_->get_profile();
+
+	const QString stage_names[data::decode::Profiler::StageCount] = {
+		tr("Sample copying"), tr("Channel muxing"), tr("Protocol decoders"),
+		tr("Annotation storage")};
+
+	double total_time = 0;
+	for (const data::decode::Profiler::StageTotals& stage : profile.stages)
+		total_time += stage.wall_time;
+
+	QString text = QString("<table><tr><th align=\"left\">%1</th>"
+		"<th align=\"right\">&nbsp;%2</th><th align=\"right\">&nbsp;%3</th>"
+		"<th align=\"right\">&nbsp;%4</th></tr>")
+		.arg(tr("Stage"), tr("Wall time"), tr("CPU time"), tr("Share"));
+
+	for (int i = 0; i < data::decode::Profiler::StageCount; i++) {
+		const data::decode::Profiler::StageTotals& stage = profile.stages[i];
+		const double share = (total_time > 0) ? (100 * stage.wall_time / total_time) : 0;
+
+		text += QString("<tr><td>%1</td><td align=\"right\">%2</td>"
+			"<td align=\"right\">%3</td><td align=\"right\">%4 %</td></tr>")
+			.arg(stage_names[i],
+				util::format_value_si(stage.wall_time, util::SIPrefix::unspecified, 1, "s", false),
+				util::format_value_si(stage.cpu_time, util::SIPrefix::unspecified, 1, "s", false),
+				QString::number(share, 'f', 1));
+	}
+
+	text += "</table><p>";
+	text += tr("%1 samples/s, %2 annotations/s")
+		.arg(util::format_value_si(profile.samples_per_second(), util::SIPrefix::unspecified, 1, "", false),
+			util::format_value_si(profile.annotations_per_second(), util::SIPrefix::unspecified, 1, "", false));
+	text += "<br>";
+	text += tr("Muxed chunks waiting: %1 at most, %2 on average")
+		.arg(profile.max_queue_depth).arg(profile.mean_queue_depth, 0, 'f', 1);
+	text += "</p>";
+
+	return text;
+}
+
 QComboBox* DecodeTrace::create_channel_selector(QWidget *parent, const DecodeChannel *ch)
 {
 	const auto sigs(session_.signalbases());
@@ -1183,7 +1291,7 @@ QComboBox* DecodeTrace::create_channel_selector_init_state(QWidget *parent,
 	return selector;
 }
 
-void DecodeTrace::export_annotations(deque<const Annotation*>& annotations) const
+void DecodeTrace::export_annotations(deque<Annotation>& annotations) const
 {
 	GlobalSettings settings;
 	const QString dir = settings.value("MainWindow/SaveDirectory").toString();
@@ -1209,37 +1317,37 @@ void DecodeTrace::export_annotations(deque<const Annotation*>& annotations) cons
 	if (file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
 		QTextStream out_stream(&file);
 
-		for (const Annotation* ann : annotations) {
+		for (const Annotation& ann : annotations) {
 			QString out_text = format;
 
 			if (has_sample_range) {
 				const QString sample_range = QString("%1-%2") \
-					.arg(QString::number(ann->start_sample()), QString::number(ann->end_sample()));
+					.arg(QString::number(ann.start_sample()), QString::number(ann.end_sample()));
 				out_text = out_text.replace("%s", sample_range);
 			}
 
 			if (has_dec_name)
 				out_text = out_text.replace("%d",
-					quote + QString::fromUtf8(ann->row()->decoder()->name()) + quote);
+					quote + QString::fromUtf8(ann.row()->decoder()->name()) + quote);
 
 			if (has_row_name) {
-				const QString row_name = quote + ann->row()->description() + quote;
+				const QString row_name = quote + ann.row()->description() + quote;
 				out_text = out_text.replace("%r", row_name);
 			}
 
 			if (has_class_name) {
-				const QString class_name = quote + ann->ann_class_name() + quote;
+				const QString class_name = quote + ann.ann_class_name() + quote;
 				out_text = out_text.replace("%c", class_name);
 			}
 
 			if (has_first_ann_text) {
-				const QString first_ann_text = quote + ann->annotations()->front() + quote;
+				const QString first_ann_text = quote + ann.annotations()->front() + quote;
 				out_text = out_text.replace("%1", first_ann_text);
 			}
 
 			if (has_all_ann_text) {
 				QString all_ann_text;
-				for (const QString &s : *(ann->annotations()))
+				for (const QString &s : *(ann.annotations()))
 					all_ann_text = all_ann_text + quote + s + quote + ",";
 				all_ann_text.chop(1);
 
@@ -1552,6 +1660,38 @@ void DecodeTrace::on_pause_decode()
 		decode_signal_->pause_decode();
 }
 
+void DecodeTrace::on_decode_cursor_range()
+{
+	const View *view = owner_->view();
+	assert(view);
+
+	if (!view->cursors()->enabled())
+		return;
+
+	const double samplerate = session_.get_samplerate();
+
+	const pv::util::Timestamp& start_time = view->cursors()->first()->time();
+	const pv::util::Timestamp& end_time = view->cursors()->second()->time();
+
+	const int64_t start_sample = (int64_t)max(
+		0.0, start_time.convert_to<double>() * samplerate);
+	const int64_t end_sample = (int64_t)max(
+		0.0, end_time.convert_to<double>() * samplerate);
+
+	// Are both cursors negative and thus were clamped to 0?
+	if ((start_sample == 0) && (end_sample == 0))
+		return;
+
+	// The cursors may have been swapped by dragging them past each other
+	decode_signal_->set_decode_range(min(start_sample, end_sample),
+		max(start_sample, end_sample));
+}
+
+void DecodeTrace::on_decode_all()
+{
+	decode_signal_->clear_decode_range();
+}
+
 void DecodeTrace::on_delete()
 {
 	session_.remove_decode_signal(decode_signal_);
@@ -1697,7 +1837,7 @@ void DecodeTrace::on_copy_annotation_to_clipboard()
 	if (!selected_row_)
 		return;
 
-	deque<const Annotation*> annotations;
+	deque<Annotation> annotations;
 
 	decode_signal_->get_annotation_subset(annotations, selected_row_,
 		current_segment_, selected_sample_range_.first, selected_sample_range_.first);
@@ -1706,10 +1846,10 @@ void DecodeTrace::on_copy_annotation_to_clipboard()
 		return;
 
 	QClipboard *clipboard = QApplication::clipboard();
-	clipboard->setText(annotations.front()->annotations()->front(), QClipboard::Clipboard);
+	clipboard->setText(annotations.front().annotations()->front(), QClipboard::Clipboard);
 
 	if (clipboard->supportsSelection())
-		clipboard->setText(annotations.front()->annotations()->front(), QClipboard::Selection);
+		clipboard->setText(annotations.front().annotations()->front(), QClipboard::Selection);
 }
 
 void DecodeTrace::on_export_row()
@@ -1781,7 +1921,7 @@ void DecodeTrace::on_export_row_from_here()
 	if (!selected_row_)
 		return;
 
-	deque<const Annotation*> annotations;
+	deque<Annotation> annotations;
 
 	decode_signal_->get_annotation_subset(annotations, selected_row_,
 		current_segment_, selected_sample_range_.first, selected_sample_range_.second);
@@ -1794,7 +1934,7 @@ void DecodeTrace::on_export_row_from_here()
 
 void DecodeTrace::on_export_all_rows_from_here()
 {
-	deque<const Annotation*> annotations;
+	deque<Annotation> annotations;
 
 	decode_signal_->get_annotation_subset(annotations, current_segment_,
 			selected_sample_range_.first, selected_sample_range_.second);
@@ -1803,6 +1943,30 @@ void DecodeTrace::on_export_all_rows_from_here()
 		export_annotations(annotations);
 }
 
+void DecodeTrace::on_export_profile()
+{
+	GlobalSettings settings;
+	const QString dir = settings.value("MainWindow/SaveDirectory").toString();
+
+	const QString file_name = QFileDialog::getSaveFileName(
+		owner_->view(), tr("Export decode profile"), dir, tr("JSON Files (*.json);;All Files (*)"));
+
+	if (file_name.isEmpty())
+		return;
+
+	QFile file(file_name);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+		QMessageBox msg(owner_->view());
+		msg.setText(tr("Error") + "\n\n" + tr("File %1 could not be written to.").arg(file_name));
+		msg.setStandardButtons(QMessageBox::Ok);
+		msg.setIcon(QMessageBox::Warning);
+		msg.exec();
+		return;
+	}
+
+	file.write(QByteArray::fromStdString(decode_signal_->get_profile_json()));
+}
+
 void DecodeTrace::on_animation_timer()
 {
 	bool animation_finished = true;
@@ -134,6 +134,7 @@ private:
 	static const int MaxTraceUpdateRate;
 	static const int AnimationDurationInTicks;
 	static const int HiddenRowHideDelay;
+	static const int ProfileUpdateInterval;
 
 public:
 	DecodeTrace(pv::Session &session, shared_ptr<SignalBase> signalbase,
@@ -191,23 +192,25 @@ public:
 	virtual void mouse_left_press_event(const QMouseEvent* event);
 
 private:
-	void draw_annotations(deque<const Annotation*>& annotations, QPainter &p,
+	void draw_annotations(deque<Annotation>& annotations, QPainter &p,
 		const ViewItemPaintParams &pp, int y, const DecodeTraceRow& row);
 
-	void draw_annotation(const Annotation* a, QPainter &p,
+	void draw_annotation(const Annotation& a, QPainter &p,
 		const ViewItemPaintParams &pp, int y, const DecodeTraceRow& row) const;
 
 	void draw_annotation_block(qreal start, qreal end, uint32_t ann_class,
 		bool use_ann_format, QPainter &p, int y, const DecodeTraceRow& row) const;
 
-	void draw_instant(const Annotation* a, QPainter &p, qreal x, int y) const;
+	void draw_instant(const Annotation& a, QPainter &p, qreal x, int y) const;
 
-	void draw_range(const Annotation* a, QPainter &p, qreal start, qreal end,
+	void draw_range(const Annotation& a, QPainter &p, qreal start, qreal end,
 		int y, const ViewItemPaintParams &pp, int row_title_width) const;
 
 	void draw_error(QPainter &p, const QString &message, const ViewItemPaintParams &pp);
 
 	void draw_unresolved_period(QPainter &p, int left, int right) const;
+	void draw_unresolved_range(QPainter &p, int left, int right,
+		int64_t start_sample, int64_t end_sample) const;
 
 	pair<double, double> get_pixels_offset_samples_per_pixel() const;
 
@@ -231,12 +234,15 @@ private:
 	void create_decoder_form(int index, shared_ptr<Decoder> &dec,
 		QWidget *parent, QFormLayout *form);
 
+	void create_profile_form(QWidget *parent, QFormLayout *form);
+	QString format_profile() const;
+
 	QComboBox* create_channel_selector(QWidget *parent,
 		const data::decode::DecodeChannel *ch);
 	QComboBox* create_channel_selector_init_state(QWidget *parent,
 		const data::decode::DecodeChannel *ch);
 
-	void export_annotations(deque<const Annotation*>& annotations) const;
+	void export_annotations(deque<Annotation>& annotations) const;
 
 	void initialize_row_widgets(DecodeTraceRow* r, unsigned int row_id);
 	void update_rows();
@@ -263,6 +269,8 @@ private Q_SLOTS:
 	void on_decode_reset();
 	void on_decode_finished();
 	void on_pause_decode();
+	void on_decode_cursor_range();
+	void on_decode_all();
 
 	void on_delete();
 
@@ -296,6 +304,8 @@ private Q_SLOTS:
 	void on_export_row_from_here();
 	void on_export_all_rows_from_here();
 
+	void on_export_profile();
+
 	void on_animation_timer();
 	void on_hide_hidden_rows();
 
@@ -152,26 +152,32 @@ pair<int, int> LogicSignal::v_extents() const
 
 void LogicSignal::paint_mid(QPainter &p, ViewItemPaintParams &pp)
 {
-	QLineF *line;
-
-	vector< pair<int64_t, bool> > edges;
-
 	assert(base_);
 	assert(owner_);
 
-	const int y = get_visual_y();
-
 	if (!base_->enabled())
 		return;
 
-	const float low_offset = y + low_level_offset_;
-	const float high_offset = y + high_level_offset_;
-	const float fill_height = low_offset - high_offset;
-
 	shared_ptr<LogicSegment> segment = get_logic_segment_to_paint();
 	if (!segment || (segment->get_sample_count() == 0))
 		return;
 
+	paint_logic_segment(p, pp, segment, 0);
+}
+
+void LogicSignal::paint_logic_segment(QPainter &p, ViewItemPaintParams &pp,
+	shared_ptr<LogicSegment> segment, int64_t sample_offset)
+{
+	QLineF *line;
+
+	vector< pair<int64_t, bool> > edges;
+
+	const int y = get_visual_y();
+
+	const float low_offset = y + low_level_offset_;
+	const float high_offset = y + high_level_offset_;
+	const float fill_height = low_offset - high_offset;
+
 	double samplerate = segment->samplerate();
 
 	// Show sample rate as 1Hz when it is unknown
@@ -180,21 +186,27 @@ void LogicSignal::paint_mid(QPainter &p, ViewItemPaintParams &pp)
 
 	const double pixels_offset = pp.pixels_offset();
 	const pv::util::Timestamp& start_time = segment->start_time();
-	const int64_t last_sample = (int64_t)segment->get_sample_count() - 1;
+	const int64_t last_sample =
+		sample_offset + (int64_t)segment->get_sample_count() - 1;
 	const double samples_per_pixel = samplerate * pp.scale();
 	const double pixels_per_sample = 1 / samples_per_pixel;
 	const pv::util::Timestamp start = samplerate * (pp.offset() - start_time);
 	const pv::util::Timestamp end = start + samples_per_pixel * pp.width();
 
 	const int64_t start_sample = min(max(floor(start).convert_to<int64_t>(),
-		(int64_t)0), last_sample);
+		sample_offset), last_sample);
 	const uint64_t end_sample = min(max(ceil(end).convert_to<int64_t>(),
-		(int64_t)0), last_sample);
+		sample_offset), last_sample);
 
-	segment->get_subsampled_edges(edges, start_sample, end_sample,
-		samples_per_pixel / Oversampling, base_->logic_bit_index());
+	segment->get_subsampled_edges(edges, start_sample - sample_offset,
+		end_sample - sample_offset, samples_per_pixel / Oversampling,
+		base_->logic_bit_index());
 	assert(edges.size() >= 2);
 
+	if (sample_offset > 0)
+		for (pair<int64_t, bool> &edge : edges)
+			edge.first += sample_offset;
+
 	const float first_sample_x =
 		pp.left() + (edges.front().first / samples_per_pixel - pixels_offset);
 	const float last_sample_x =
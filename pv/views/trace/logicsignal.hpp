@@ -106,6 +106,17 @@ public:
 	virtual vector<data::LogicSegment::EdgePair> get_nearest_level_changes(uint64_t sample_pos);
 
 protected:
+	/**
+	 * Paints the edges of a logic segment.
+	 * @param p the QPainter to paint into.
+	 * @param pp the painting parameters object to paint with.
+	 * @param segment the segment to paint.
+	 * @param sample_offset the sample number of the first sample in the
+	 *        segment, for segments that only hold a part of the signal.
+	 */
+	void paint_logic_segment(QPainter &p, ViewItemPaintParams &pp,
+		shared_ptr<pv::data::LogicSegment> segment, int64_t sample_offset);
+
 	void paint_caps(QPainter &p, QLineF *const lines,
 		vector< pair<int64_t, bool> > &edges,
 		bool level, double samples_per_pixel, double pixels_offset,
@@ -27,6 +27,7 @@
 #include <QLabel>
 #include <QLineEdit>
 #include <QPushButton>
+#include <QSpinBox>
 #include <QString>
 #include <QTabWidget>
 #include <QVBoxLayout>
@@ -73,7 +74,9 @@ const vector< pair<string, string> > MathEditDialog::Examples = {
 	 "// formula is y[n] = ax[n] + (1 - a) * y[n - 1]\n" \
 	 "// x[n] becomes the input signal, here A4\n" \
 	 "// y[n - 1] becomes sample('Math1', s - 1)\n" \
-	 "a * A4 + (1 - a) * sample('Math1', s - 1)"}
+	 "a * A4 + (1 - a) * sample('Math1', s - 1)"},
+	{"Remove everything above 10kHz from A0 using a 101-tap FIR filter:",
+	 "fir_lowpass('A0', 10e3, 101)"}
 };
 
 
@@ -178,6 +181,21 @@ MathEditDialog::MathEditDialog(pv::Session &session,
 	trig_layout->addWidget(new QLabel(tr("rad2deg(x)\tConvert x from radians to degrees")));
 	trig_layout->addWidget(new QLabel(tr("grad2deg(x)\tConvert x from gradians to degrees")));
 
+	QWidget *filter_page = new QWidget();
+	QVBoxLayout *filter_layout = new QVBoxLayout(filter_page);
+	filter_layout->addWidget(new QLabel("<b>" + tr("Filters:") + "</b>"));
+	filter_layout->addWidget(new QLabel(tr("movavg('s', n)		Moving average over the last n samples of the signal named s")));
+	filter_layout->addWidget(new QLabel(tr("fir_lowpass('s', fc, n)	Low-pass FIR filter with cutoff frequency fc in Hz and n taps")));
+	filter_layout->addWidget(new QLabel(tr("fir_highpass('s', fc, n)	High-pass FIR filter with cutoff frequency fc in Hz and n taps")));
+	filter_layout->addWidget(new QLabel(tr("fir_bandpass('s', f1, f2, n)	Band-pass FIR filter passing f1 to f2 in Hz with n taps")));
+	filter_layout->addWidget(new QLabel(tr("iir_lowpass('s', fc, q)	Low-pass biquad IIR filter with cutoff frequency fc in Hz and quality factor q")));
+	filter_layout->addWidget(new QLabel(tr("iir_highpass('s', fc, q)	High-pass biquad IIR filter with cutoff frequency fc in Hz and quality factor q")));
+	filter_layout->addWidget(new QLabel(tr("iir_bandpass('s', f0, q)	Band-pass biquad IIR filter with center frequency f0 in Hz and quality factor q")));
+	filter_layout->addWidget(new QLabel(tr("All filters return the filtered value of the current sample.\n" \
+		"They keep their state from one sample to the next and are much faster\n" \
+		"than implementing the same filter using sample(). The parameters after\n" \
+		"the signal name must not change from one sample to the next.")));
+
 	QWidget *logic_page = new QWidget();
 	QVBoxLayout *logic_layout = new QVBoxLayout(logic_page);
 	logic_layout->addWidget(new QLabel("<b>" + tr("Logic operators:") + "</b>"));
@@ -248,6 +266,7 @@ MathEditDialog::MathEditDialog(pv::Session &session,
 	tabs->addTab(func1_page, tr("Functions 1"));
 	tabs->addTab(func2_page, tr("Functions 2"));
 	tabs->addTab(trig_page, tr("Trigonometry"));
+	tabs->addTab(filter_page, tr("Filters"));
 	tabs->addTab(logic_page, tr("Logic"));
 	tabs->addTab(control1_page, tr("Flow Control 1"));
 	tabs->addTab(control2_page, tr("Flow Control 2"));
@@ -297,11 +316,97 @@ MathSignal::MathSignal(
 	delayed_expr_updater_.setInterval(MATHSIGNAL_INPUT_TIMEOUT);
 	connect(&delayed_expr_updater_, &QTimer::timeout,
 		this, [this]() { math_signal_->set_expression(expression_edit_->text()); });
+
+	connect(math_signal_.get(), SIGNAL(output_type_changed(int)),
+		this, SLOT(on_output_type_changed()));
+
+	update_logic_level_offsets();
+}
+
+pair<int, int> MathSignal::v_extents() const
+{
+	if (has_logic_output())
+		return LogicSignal::v_extents();
+
+	return AnalogSignal::v_extents();
+}
+
+void MathSignal::paint_back(QPainter &p, ViewItemPaintParams &pp)
+{
+	if (has_logic_output())
+		Signal::paint_back(p, pp);
+	else
+		AnalogSignal::paint_back(p, pp);
+}
+
+void MathSignal::paint_mid(QPainter &p, ViewItemPaintParams &pp)
+{
+	if (!has_logic_output()) {
+		AnalogSignal::paint_mid(p, pp);
+		return;
+	}
+
+	LogicSignal::paint_mid(p, pp);
+
+	if (!base_->get_error_message().isEmpty())
+		paint_error(p, pp);
+}
+
+void MathSignal::paint_fore(QPainter &p, ViewItemPaintParams &pp)
+{
+	if (has_logic_output())
+		LogicSignal::paint_fore(p, pp);
+	else
+		AnalogSignal::paint_fore(p, pp);
+}
+
+vector<data::LogicSegment::EdgePair> MathSignal::get_nearest_level_changes(uint64_t sample_pos)
+{
+	if (has_logic_output())
+		return LogicSignal::get_nearest_level_changes(sample_pos);
+
+	return AnalogSignal::get_nearest_level_changes(sample_pos);
+}
+
+void MathSignal::update_logic_level_offsets()
+{
+	if (has_logic_output())
+		LogicSignal::update_logic_level_offsets();
+	else
+		AnalogSignal::update_logic_level_offsets();
+}
+
+bool MathSignal::has_logic_output() const
+{
+	return math_signal_ &&
+		(math_signal_->get_output_type() == pv::data::MathSignal::LogicOutput);
 }
 
 void MathSignal::populate_popup_form(QWidget *parent, QFormLayout *form)
 {
-	AnalogSignal::populate_popup_form(parent, form);
+	if (has_logic_output()) {
+		// Skip the analog and trigger settings, they don't apply here
+		Signal::populate_popup_form(parent, form);
+
+		signal_height_sb_ = new QSpinBox(parent);
+		signal_height_sb_->setRange(5, 1000);
+		signal_height_sb_->setSingleStep(5);
+		signal_height_sb_->setSuffix(tr(" pixels"));
+		signal_height_sb_->setValue(signal_height_);
+		connect(signal_height_sb_, SIGNAL(valueChanged(int)),
+			this, SLOT(on_signal_height_changed(int)));
+		form->addRow(tr("Trace height"), signal_height_sb_);
+	} else
+		AnalogSignal::populate_popup_form(parent, form);
+
+	output_type_cb_ = new QComboBox();
+	output_type_cb_->addItem(tr("analog"), pv::data::MathSignal::AnalogOutput);
+	output_type_cb_->addItem(tr("logic"), pv::data::MathSignal::LogicOutput);
+	output_type_cb_->setCurrentIndex(
+		output_type_cb_->findData(math_signal_->get_output_type()));
+	connect(output_type_cb_, SIGNAL(currentIndexChanged(int)),
+		this, SLOT(on_output_type_cb_changed(int)));
+	form->addRow(tr("Output type"), output_type_cb_);
 
 	expression_edit_ = new QLineEdit();
 	expression_edit_->setText(math_signal_->get_expression());
@@ -343,6 +448,23 @@ void MathSignal::on_expression_changed(const QString &text)
 	delayed_expr_updater_.start();
 }
 
+void MathSignal::on_output_type_cb_changed(int index)
+{
+	math_signal_->set_output_type((pv::data::MathSignal::OutputType)
+		(output_type_cb_->itemData(index).toInt()));
+}
+
+void MathSignal::on_output_type_changed()
+{
+	update_logic_level_offsets();
+
+	if (owner_) {
+		// Call order is important, otherwise the lazy event handler won't work
+		owner_->extents_changed(false, true);
+		owner_->row_item_appearance_changed(false, true);
+	}
+}
+
 void MathSignal::on_sample_count_changed(const QString &text)
 {
 	(void)text;
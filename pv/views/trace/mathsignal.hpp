@@ -74,20 +74,38 @@ class MathSignal : public AnalogSignal
 public:
 	MathSignal(pv::Session &session, shared_ptr<data::SignalBase> base);
 
+	virtual pair<int, int> v_extents() const;
+
+	virtual void paint_back(QPainter &p, ViewItemPaintParams &pp);
+	virtual void paint_mid(QPainter &p, ViewItemPaintParams &pp);
+	virtual void paint_fore(QPainter &p, ViewItemPaintParams &pp);
+
+	virtual vector<data::LogicSegment::EdgePair> get_nearest_level_changes(uint64_t sample_pos);
+
 protected:
 	void populate_popup_form(QWidget *parent, QFormLayout *form);
 
+	virtual void update_logic_level_offsets();
+
+	/**
+	 * Returns true if the math signal generates logic data, in which case
+	 * the trace is painted like a logic signal.
+	 */
+	bool has_logic_output() const;
+
 	shared_ptr<pv::data::MathSignal> math_signal_;
 
 private Q_SLOTS:
 	void on_expression_changed(const QString &text);
+	void on_output_type_cb_changed(int index);
+	void on_output_type_changed();
 	void on_sample_count_changed(const QString &text);
 
 	void on_edit_clicked();
 
 private:
 	QLineEdit *expression_edit_;
-	QComboBox *sample_count_cb_, *sample_rate_cb_;
+	QComboBox *output_type_cb_, *sample_count_cb_, *sample_rate_cb_;
 	QString sample_count_text_, sample_rate_text_;
 	QTimer delayed_expr_updater_, delayed_count_updater_, delayed_rate_updater_;
 };
@@ -96,6 +96,8 @@ void ViewBase::clear_signalbases()
 			this, SLOT(on_data_updated()));
 		disconnect(signalbase.get(), SIGNAL(samples_added(uint64_t, uint64_t, uint64_t)),
 			this, SLOT(on_samples_added(uint64_t, uint64_t, uint64_t)));
+		disconnect(signalbase.get(), SIGNAL(conversion_preview_updated()),
+			this, SLOT(on_data_updated()));
 	}
 
 	signalbases_.clear();
@@ -109,6 +111,8 @@ void ViewBase::add_signalbase(const shared_ptr<data::SignalBase> signalbase)
 		this, SLOT(on_data_updated()));
 	connect(signalbase.get(), SIGNAL(samples_added(uint64_t, uint64_t, uint64_t)),
 		this, SLOT(on_samples_added(uint64_t, uint64_t, uint64_t)));
+	connect(signalbase.get(), SIGNAL(conversion_preview_updated()),
+		this, SLOT(on_data_updated()));
 }
 
 void ViewBase::remove_signalbase(const shared_ptr<data::SignalBase> signalbase)
@@ -117,6 +121,8 @@ void ViewBase::remove_signalbase(const shared_ptr<data::SignalBase> signalbase)
 		this, SLOT(on_data_updated()));
 	disconnect(signalbase.get(), SIGNAL(samples_added(uint64_t, uint64_t, uint64_t)),
 		this, SLOT(on_samples_added(uint64_t, uint64_t, uint64_t)));
+	disconnect(signalbase.get(), SIGNAL(conversion_preview_updated()),
+		this, SLOT(on_data_updated()));
 
 	signalbases_.erase(std::remove_if(signalbases_.begin(), signalbases_.end(),
 		[&](shared_ptr<data::SignalBase> s) { return s == signalbase; }),
@@ -17,12 +17,20 @@
  * along with this program; if not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <cassert>
-
-#include <libsigrokdecode/libsigrokdecode.h>
+#include <vector>
 
 #include "decodermenu.hpp"
 
+#include <pv/data/decode/decoderindex.hpp>
+
+using std::sort;
+using std::vector;
+
+using pv::data::decode::DecoderIndex;
+using pv::data::decode::DecoderInfo;
+
 namespace pv {
 namespace widgets {
 
@@ -30,32 +38,31 @@ DecoderMenu::DecoderMenu(QWidget *parent, const char* input, bool first_level_de
 	QMenu(parent),
 	mapper_(this)
 {
-	GSList *li = g_slist_sort(g_slist_copy((GSList*)srd_decoder_list()), decoder_name_cmp);
-
-	for (GSList *l = li; l; l = l->next) {
-		const srd_decoder *const d = (srd_decoder*)l->data;
-		assert(d);
+	vector<const DecoderInfo*> decoders;
+	for (const DecoderInfo& info : DecoderIndex::decoders())
+		decoders.push_back(&info);
+	sort(decoders.begin(), decoders.end(), decoder_name_less);
 
-		const bool have_channels = (d->channels || d->opt_channels) != 0;
+	for (const DecoderInfo* d : decoders) {
+		const bool have_channels = !d->channels.isEmpty() || !d->opt_channels.isEmpty();
 		if (first_level_decoder != have_channels)
 			continue;
 
 		if (!first_level_decoder) {
 			// Dismiss all non-stacked decoders unless we're looking for first-level decoders
-			if (!d->inputs)
+			if (d->inputs.isEmpty())
 				continue;
 
 			// TODO For now we ignore that d->inputs is actually a list
-			if (strncmp((char*)(d->inputs->data), input, 1024) != 0)
+			if (d->inputs.front() != QString::fromUtf8(input))
 				continue;
 		}
 
-		QAction *const action = addAction(QString::fromUtf8(d->name));
-		action->setData(QVariant::fromValue(l->data));
+		QAction *const action = addAction(d->name);
+		action->setData(d->id);
 		mapper_.setMapping(action, action);
 		connect(action, SIGNAL(triggered()), &mapper_, SLOT(map()));
 	}
-	g_slist_free(li);
 
 #if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
 	connect(&mapper_, SIGNAL(mappedObject(QObject*)), this, SLOT(on_action(QObject*)));
@@ -64,19 +71,21 @@ DecoderMenu::DecoderMenu(QWidget *parent, const char* input, bool first_level_de
 #endif
 }
 
-int DecoderMenu::decoder_name_cmp(const void *a, const void *b)
+bool DecoderMenu::decoder_name_less(const DecoderInfo* a, const DecoderInfo* b)
 {
-	return strcmp(((const srd_decoder*)a)->name, ((const srd_decoder*)b)->name);
+	return a->name < b->name;
 }
 
 void DecoderMenu::on_action(QObject *action)
 {
 	assert(action);
 
-	srd_decoder *const dec = (srd_decoder*)((QAction*)action)->data().value<void*>();
-	assert(dec);
+	// The decoder's module is only loaded once the decoder is actually used
+	srd_decoder *const dec =
+		DecoderIndex::get_decoder(((QAction*)action)->data().toString());
 
-	decoder_selected(dec);
+	if (dec)
+		decoder_selected(dec);
 }
 
 }  // namespace widgets
@@ -26,6 +26,13 @@
 struct srd_decoder;
 
 namespace pv {
+
+namespace data {
+namespace decode {
+struct DecoderInfo;
+}
+}
+
 namespace widgets {
 
 class DecoderMenu : public QMenu
@@ -36,7 +43,8 @@ public:
 	DecoderMenu(QWidget *parent, const char* input, bool first_level_decoder = false);
 
 private:
-	static int decoder_name_cmp(const void *a, const void *b);
+	static bool decoder_name_less(const data::decode::DecoderInfo* a,
+		const data::decode::DecoderInfo* b);
 
 private Q_SLOTS:
 	void on_action(QObject *action);
@@ -0,0 +1,629 @@
+/*
+ * This file is part of the PulseView project.
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Measures the decode throughput for synthetic UART, SPI, I2C and CAN
+ * waveforms. For every protocol, the signal is generated into a
+ * LogicSegment and then passed through the stages of the decode pipeline:
+ *
+ *   generate  Creating the LogicSegment, including its mip-map
+ *   copy      Reading the samples back from the segment's chunks
+ *   mux       Muxing the decoder input channels
+ *   srd       Decoding the muxed samples in a bare libsigrokdecode session
+ *   pipeline  Decoding the segment using DecodeSignal, i.e. muxing,
+ *             decoding and storing the annotations
+ *
+ * The results are printed as one JSON object per line and stage so that they
+ * can be compared from run to run. The peak memory is the peak resident set
+ * size during the stage, as far as the OS lets us reset it in between.
+ *
+ * Usage: pulseview-bench [-n sample count] [-c channel count] [-p protocols]
+ */
+
+#include "config.h"
+
+#include <libsigrokdecode/libsigrokdecode.h> /* First, so we avoid a _POSIX_C_SOURCE warning. */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <getopt.h>
+
+#include <QApplication>
+#include <QEventLoop>
+
+#include <libsigrokcxx/libsigrokcxx.hpp>
+
+#include <pv/devicemanager.hpp>
+#include <pv/session.hpp>
+#include <pv/util.hpp>
+#include <pv/data/decodesignal.hpp>
+#include <pv/data/logic.hpp>
+#include <pv/data/logicsegment.hpp>
+#include <pv/data/signalbase.hpp>
+#include <pv/data/decode/logicmux.hpp>
+#include <pv/data/decode/row.hpp>
+
+using std::atomic;
+using std::make_shared;
+using std::mt19937;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+using pv::data::DecodeSignal;
+using pv::data::Logic;
+using pv::data::LogicSegment;
+using pv::data::SignalBase;
+using pv::data::decode::MuxChannel;
+using pv::data::decode::Row;
+using pv::data::decode::mux_logic_channels;
+
+/// Number of samples handed to srd_session_send() at a time
+static const uint64_t SrdChunkLength = 256 * 1024;
+
+/// Number of samples the waveform generator buffers before appending them
+static const uint64_t WaveformBufferLength = 1024 * 1024;
+
+/**
+ * Writes a waveform to a LogicSegment, holding the channel levels for
+ * a given number of samples at a time.
+ */
+class Waveform
+{
+public:
+	Waveform(LogicSegment& segment, unsigned int unit_size, uint64_t sample_count,
+		uint64_t levels) :
+		segment_(segment),
+		unit_size_(unit_size),
+		remaining_(sample_count),
+		levels_(levels),
+		fill_(0),
+		buffer_(WaveformBufferLength * unit_size)
+	{
+	}
+
+	void set(unsigned int bit, bool level)
+	{
+		levels_ = level ? (levels_ | (1ULL << bit)) : (levels_ & ~(1ULL << bit));
+	}
+
+	void hold(uint64_t duration)
+	{
+		uint8_t sample[8];
+		for (unsigned int i = 0; i < sizeof(sample); i++)
+			sample[i] = levels_ >> (8 * i);
+
+		for (duration = std::min(duration, remaining_); duration > 0; duration--) {
+			memcpy(buffer_.data() + fill_ * unit_size_, sample, unit_size_);
+			remaining_--;
+
+			if (++fill_ == WaveformBufferLength)
+				flush();
+		}
+	}
+
+	bool full() const
+	{
+		return remaining_ == 0;
+	}
+
+	void flush()
+	{
+		if (fill_ > 0)
+			segment_.append_payload(buffer_.data(), fill_ * unit_size_);
+		fill_ = 0;
+	}
+
+private:
+	LogicSegment& segment_;
+	const unsigned int unit_size_;
+	uint64_t remaining_;
+	uint64_t levels_;
+	uint64_t fill_;
+	vector<uint8_t> buffer_;
+};
+
+/*
+ * Frame generators. Each of them appends one frame with random payload,
+ * using the default options of the respective decoder.
+ */
+
+static void generate_uart_frame(Waveform& w, mt19937& rng)
+{
+	// 115200 baud, 8N1, LSB first at 10 samples per bit
+	const uint8_t value = rng();
+
+	w.set(0, 0);
+	w.hold(10);
+	for (unsigned int i = 0; i < 8; i++) {
+		w.set(0, (value >> i) & 1);
+		w.hold(10);
+	}
+	w.set(0, 1);
+	w.hold(10 + 20);
+}
+
+static void generate_spi_frame(Waveform& w, mt19937& rng)
+{
+	// CPOL = CPHA = 0, MSB first, CS# active low; CLK, MISO, MOSI, CS#
+	w.set(3, 0);
+	w.hold(2);
+
+	for (unsigned int byte = 0; byte < 4; byte++) {
+		const uint8_t mosi = rng(), miso = rng();
+		for (int i = 7; i >= 0; i--) {
+			w.set(0, 0);
+			w.set(1, (miso >> i) & 1);
+			w.set(2, (mosi >> i) & 1);
+			w.hold(2);
+			w.set(0, 1);
+			w.hold(2);
+		}
+	}
+
+	w.set(0, 0);
+	w.hold(2);
+	w.set(3, 1);
+	w.hold(8);
+}
+
+static void generate_i2c_frame(Waveform& w, mt19937& rng)
+{
+	// A write transfer of 4 bytes with all bytes acknowledged; SCL, SDA
+	const unsigned int half_period = 5;
+
+	vector<uint8_t> bytes = {(uint8_t)((0x08 + rng() % 0x70) << 1)};
+	for (unsigned int i = 0; i < 4; i++)
+		bytes.push_back(rng());
+
+	// Start condition
+	w.set(1, 0);
+	w.hold(half_period);
+
+	for (uint8_t byte : bytes)
+		for (int i = 8; i >= 0; i--) {
+			// The ninth bit is the ACK
+			w.set(0, 0);
+			w.set(1, (i > 0) ? ((byte >> (i - 1)) & 1) : 0);
+			w.hold(half_period);
+			w.set(0, 1);
+			w.hold(half_period);
+		}
+
+	// Stop condition
+	w.set(0, 0);
+	w.set(1, 0);
+	w.hold(half_period);
+	w.set(0, 1);
+	w.hold(half_period);
+	w.set(1, 1);
+	w.hold(4 * half_period);
+}
+
+static void generate_can_frame(Waveform& w, mt19937& rng)
+{
+	// Standard data frame at 1 Mbit/s with 10 samples per bit
+	vector<bool> bits;
+	const auto append = [&](uint32_t value, unsigned int length) {
+		for (int i = length - 1; i >= 0; i--)
+			bits.push_back((value >> i) & 1);
+	};
+
+	const unsigned int dlc = 1 + rng() % 8;
+
+	append(0, 1);                  // SOF
+	append(rng() & 0x7FF, 11);     // Identifier
+	append(0, 3);                  // RTR, IDE, r0
+	append(dlc, 4);
+	for (unsigned int i = 0; i < dlc; i++)
+		append(rng() & 0xFF, 8);
+
+	uint16_t crc = 0;
+	for (bool bit : bits) {
+		const bool crc_next = bit ^ ((crc >> 14) & 1);
+		crc = (crc << 1) & 0x7FFF;
+		if (crc_next)
+			crc ^= 0x4599;
+	}
+	append(crc, 15);
+
+	// Insert a complementary bit after every 5 equal bits
+	vector<bool> stuffed;
+	unsigned int run = 0;
+	for (bool bit : bits) {
+		run = (!stuffed.empty() && (bit == stuffed.back())) ? (run + 1) : 1;
+		stuffed.push_back(bit);
+
+		if (run == 5) {
+			stuffed.push_back(!bit);
+			run = 1;
+		}
+	}
+
+	bits = stuffed;
+	append(1, 1);                  // CRC delimiter
+	append(0, 1);                  // ACK slot
+	append(0x7FF, 11);             // ACK delimiter, EOF, interframe space
+
+	for (bool bit : bits) {
+		w.set(0, bit);
+		w.hold(10);
+	}
+}
+
+struct Protocol
+{
+	const char* decoder_id;
+	double samplerate;
+	vector<const char*> channels;  ///< Decoder channel IDs, assigned to bit 0..n
+	uint64_t idle_levels;          ///< Channel levels between frames
+	void (*generate_frame)(Waveform&, mt19937&);
+};
+
+static const vector<Protocol> Protocols = {
+	{"uart", 1152000, {"rx"}, 0x1, generate_uart_frame},
+	{"spi", 4000000, {"clk", "miso", "mosi", "cs"}, 0x8, generate_spi_frame},
+	{"i2c", 4000000, {"scl", "sda"}, 0x3, generate_i2c_frame},
+	{"can", 10000000, {"can_rx"}, 0x1, generate_can_frame},
+};
+
+/*
+ * Stage measurement
+ */
+
+struct StageResult
+{
+	double wall_time;
+	double cpu_time;
+	uint64_t annotations;
+	long peak_rss_kib;
+};
+
+static void reset_peak_rss()
+{
+#ifdef __linux__
+	// Resets VmHWM to the current RSS, see proc(5)
+	std::ofstream("/proc/self/clear_refs") << "5";
+#endif
+}
+
+static long get_peak_rss_kib()
+{
+#ifdef __linux__
+	std::ifstream status("/proc/self/status");
+	string line;
+
+	while (std::getline(status, line))
+		if (line.compare(0, 6, "VmHWM:") == 0)
+			return strtol(line.c_str() + 6, nullptr, 10);
+#endif
+
+	return -1;
+}
+
+class StageTimer
+{
+public:
+	StageTimer() :
+		cpu_start_(std::clock())
+	{
+		reset_peak_rss();
+		wall_start_ = std::chrono::steady_clock::now();
+	}
+
+	StageResult finish(uint64_t annotations = 0,
+		std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now()) const
+	{
+		const std::chrono::duration<double> wall_time = end - wall_start_;
+
+		StageResult result;
+		result.wall_time = wall_time.count();
+		result.cpu_time = (double)(std::clock() - cpu_start_) / CLOCKS_PER_SEC;
+		result.annotations = annotations;
+		result.peak_rss_kib = get_peak_rss_kib();
+
+		return result;
+	}
+
+private:
+	std::clock_t cpu_start_;
+	std::chrono::steady_clock::time_point wall_start_;
+};
+
+static void print_result(const Protocol& protocol, const char* stage,
+	uint64_t sample_count, unsigned int channel_count, const StageResult& result)
+{
+	const double wall_time = std::max(result.wall_time, 1e-9);
+
+	printf("{\"protocol\": \"%s\", \"stage\": \"%s\", \"samples\": %llu, "
+		"\"channels\": %u, \"wall_s\": %.6f, \"cpu_s\": %.6f, "
+		"\"samples_per_s\": %.0f, \"annotations\": %llu, "
+		"\"annotations_per_s\": %.0f, \"peak_rss_kib\": %ld}\n",
+		protocol.decoder_id, stage, (unsigned long long)sample_count,
+		channel_count, result.wall_time, result.cpu_time,
+		sample_count / wall_time, (unsigned long long)result.annotations,
+		result.annotations / wall_time, result.peak_rss_kib);
+	fflush(stdout);
+}
+
+/*
+ * Stages
+ */
+
+static void count_annotation(srd_proto_data *pdata, void *cb_data)
+{
+	(void)pdata;
+	(*(uint64_t*)cb_data)++;
+}
+
+static bool decode_with_srd(const Protocol& protocol, const vector<uint8_t>& samples,
+	uint64_t& annotations)
+{
+	srd_session *session;
+	if (srd_session_new(&session) != SRD_OK)
+		return false;
+
+	srd_decoder_inst *const inst = srd_inst_new(session, protocol.decoder_id, nullptr);
+	if (!inst) {
+		srd_session_destroy(session);
+		return false;
+	}
+
+	// The muxer places decoder channel n at bit n of the 1-byte samples
+	GHashTable *const channels = g_hash_table_new_full(g_str_hash,
+		g_str_equal, g_free, (GDestroyNotify)g_variant_unref);
+
+	for (unsigned int i = 0; i < protocol.channels.size(); i++)
+		g_hash_table_insert(channels, g_strdup(protocol.channels[i]),
+			g_variant_ref_sink(g_variant_new_int32(i)));
+
+	srd_inst_channel_set_all(inst, channels);
+	g_hash_table_destroy(channels);
+
+	srd_session_metadata_set(session, SRD_CONF_SAMPLERATE,
+		g_variant_new_uint64(protocol.samplerate));
+	srd_pd_output_callback_add(session, SRD_OUTPUT_ANN, count_annotation, &annotations);
+
+	bool result = (srd_session_start(session) == SRD_OK);
+
+	for (uint64_t start = 0; result && (start < samples.size()); start += SrdChunkLength) {
+		const uint64_t end = std::min(start + SrdChunkLength, (uint64_t)samples.size());
+		result = (srd_session_send(session, start, end, samples.data() + start,
+			end - start, 1) == SRD_OK);
+	}
+
+#if defined HAVE_SRD_SESSION_SEND_EOF && HAVE_SRD_SESSION_SEND_EOF
+	if (result)
+		(void)srd_session_send_eof(session);
+#endif
+
+	srd_session_destroy(session);
+
+	return result;
+}
+
+static bool decode_with_pipeline(pv::Session& session, const Protocol& protocol,
+	shared_ptr<Logic> logic, uint64_t sample_count, unsigned int channel_count)
+{
+	vector< shared_ptr<SignalBase> > signals;
+	for (unsigned int i = 0; i < protocol.channels.size(); i++) {
+		shared_ptr<SignalBase> signal =
+			make_shared<SignalBase>(nullptr, SignalBase::LogicChannel);
+		signal->set_index(i);
+		signal->set_name(protocol.channels[i]);
+		signal->set_data(logic);
+		signals.push_back(signal);
+	}
+
+	shared_ptr<DecodeSignal> decode_signal = make_shared<DecodeSignal>(session);
+	decode_signal->stack_decoder(srd_decoder_get_by_id(protocol.decoder_id), false);
+
+	for (const pv::data::decode::DecodeChannel& ch : decode_signal->get_channels())
+		for (unsigned int i = 0; i < protocol.channels.size(); i++)
+			if (strcmp(ch.pdch_->id, protocol.channels[i]) == 0)
+				decode_signal->assign_signal(ch.id, signals[i]);
+
+	QEventLoop loop;
+	atomic<bool> finished(false);
+	std::chrono::steady_clock::time_point end;
+
+	// The decode finishes in a decode thread, so only take the time there
+	QObject::connect(decode_signal.get(), &DecodeSignal::decode_finished,
+		[&]() {
+			end = std::chrono::steady_clock::now();
+			finished = true;
+			QMetaObject::invokeMethod(&loop, "quit", Qt::QueuedConnection);
+		});
+
+	const StageTimer timer;
+	decode_signal->begin_decode();
+
+	if (decode_signal->get_error_message().isEmpty())
+		loop.exec();
+
+	if (!finished) {
+		fprintf(stderr, "Decoding %s failed: %s\n", protocol.decoder_id,
+			decode_signal->get_error_message().toUtf8().constData());
+		return false;
+	}
+
+	uint64_t annotations = 0;
+	for (const Row* row : decode_signal->get_rows())
+		annotations += decode_signal->get_annotation_count(row, 0);
+
+	print_result(protocol, "pipeline", sample_count, channel_count,
+		timer.finish(annotations, end));
+
+	return true;
+}
+
+static bool run_protocol(pv::Session& session, const Protocol& protocol,
+	uint64_t sample_count, unsigned int channel_count)
+{
+	const unsigned int unit_size = (channel_count + 7) / 8;
+	mt19937 rng(42);
+
+	// generate
+	StageTimer timer;
+
+	shared_ptr<Logic> logic = make_shared<Logic>(channel_count);
+	logic->set_samplerate(protocol.samplerate);
+
+	shared_ptr<LogicSegment> segment = make_shared<LogicSegment>(
+		*logic, 0, unit_size, protocol.samplerate);
+	logic->push_segment(segment);
+
+	// Channels not used by the decoder stay low
+	Waveform waveform(*segment, unit_size, sample_count, protocol.idle_levels);
+	waveform.hold(100);
+	while (!waveform.full())
+		protocol.generate_frame(waveform, rng);
+	waveform.flush();
+	segment->set_complete();
+
+	print_result(protocol, "generate", sample_count, channel_count, timer.finish());
+
+	// copy
+	vector<uint8_t> muxed(sample_count);
+	{
+		timer = StageTimer();
+		vector<uint8_t> samples(sample_count * unit_size);
+		segment->get_samples(0, sample_count, samples.data());
+		print_result(protocol, "copy", sample_count, channel_count, timer.finish());
+
+		// mux
+		timer = StageTimer();
+		vector<MuxChannel> channels;
+		for (unsigned int i = 0; i < protocol.channels.size(); i++)
+			channels.push_back({samples.data(), unit_size, i});
+		mux_logic_channels(channels, sample_count, muxed.data(), 1);
+		print_result(protocol, "mux", sample_count, channel_count, timer.finish());
+	}
+
+	// srd
+	timer = StageTimer();
+	uint64_t annotations = 0;
+	if (!decode_with_srd(protocol, muxed, annotations)) {
+		fprintf(stderr, "Decoding %s with libsigrokdecode failed\n", protocol.decoder_id);
+		return false;
+	}
+	print_result(protocol, "srd", sample_count, channel_count, timer.finish(annotations));
+
+	muxed.clear();
+	muxed.shrink_to_fit();
+
+	// pipeline
+	return decode_with_pipeline(session, protocol, logic, sample_count, channel_count);
+}
+
+static void usage(const char* name)
+{
+	fprintf(stderr, "Usage: %s [-n sample count] [-c channel count] [-p protocols]\n"
+		"  -n  Number of samples per protocol (default 10000000)\n"
+		"  -c  Number of channels of the generated signal, 1..64 (default 8)\n"
+		"  -p  Comma-separated list of protocols (default uart,spi,i2c,can)\n", name);
+}
+
+int main(int argc, char *argv[])
+{
+	uint64_t sample_count = 10 * 1000 * 1000;
+	unsigned int channel_count = 8;
+	string protocol_list = "uart,spi,i2c,can";
+
+	int c;
+	while ((c = getopt(argc, argv, "n:c:p:h")) != -1) {
+		switch (c) {
+		case 'n':
+			sample_count = strtoull(optarg, nullptr, 10);
+			break;
+		case 'c':
+			channel_count = strtoul(optarg, nullptr, 10);
+			break;
+		case 'p':
+			protocol_list = optarg;
+			break;
+		default:
+			usage(argv[0]);
+			return (c == 'h') ? 0 : 1;
+		}
+	}
+
+	if ((sample_count == 0) || (channel_count < 1) || (channel_count > 64)) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	vector<const Protocol*> protocols;
+	for (const string& name : pv::util::split_string(protocol_list, ",")) {
+		const Protocol* protocol = nullptr;
+		for (const Protocol& p : Protocols)
+			if (name == p.decoder_id)
+				protocol = &p;
+
+		if (!protocol || (protocol->channels.size() > channel_count)) {
+			fprintf(stderr, "Protocol %s is unknown or needs more channels\n", name.c_str());
+			return 1;
+		}
+		protocols.push_back(protocol);
+	}
+
+	// The device manager shows a progress dialog, which needs a platform
+	if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+		qputenv("QT_QPA_PLATFORM", "offscreen");
+
+	QApplication app(argc, argv);
+
+	// Use separate settings so that the user's decoder settings don't apply
+	QApplication::setOrganizationName("sigrok");
+	QApplication::setApplicationName("PulseView-bench");
+
+	shared_ptr<sigrok::Context> context = sigrok::Context::create();
+	pv::Session::sr_context = context;
+
+	if (srd_init(nullptr) != SRD_OK) {
+		fprintf(stderr, "Failed to initialize libsigrokdecode\n");
+		return 1;
+	}
+	srd_decoder_load_all();
+
+	int result = 0;
+	{
+		pv::DeviceManager device_manager(context, "", false);
+		pv::Session session(device_manager, "bench");
+
+		for (const Protocol* protocol : protocols)
+			if (!run_protocol(session, *protocol, sample_count, channel_count))
+				result = 1;
+	}
+
+	srd_exit();
+
+	return result;
+}
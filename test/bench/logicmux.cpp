@@ -0,0 +1,100 @@
+/*
+ * This file is part of the PulseView project.
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Compares the bit-plane logic muxer used for decoder input with the
+ * bit-by-bit reference implementation.
+ *
+ * Usage: pulseview-bench-logicmux [sample count]
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include <pv/data/decode/logicmux.hpp>
+
+using std::vector;
+
+using pv::data::decode::MuxChannel;
+using pv::data::decode::mux_logic_channels;
+using pv::data::decode::mux_logic_channels_bitwise;
+
+typedef void (*mux_function)(const vector<MuxChannel>&, uint64_t, uint8_t*, unsigned int);
+
+static double measure(mux_function f, const vector<MuxChannel>& channels,
+	uint64_t sample_count, vector<uint8_t>& output, unsigned int out_unit_size)
+{
+	const int runs = 5;
+	double best = 0;
+
+	for (int i = 0; i < runs; i++) {
+		const auto start = std::chrono::steady_clock::now();
+		f(channels, sample_count, output.data(), out_unit_size);
+		const std::chrono::duration<double> elapsed =
+			std::chrono::steady_clock::now() - start;
+
+		if ((i == 0) || (elapsed.count() < best))
+			best = elapsed.count();
+	}
+
+	return best;
+}
+
+int main(int argc, char *argv[])
+{
+	const uint64_t sample_count = (argc > 1) ? strtoull(argv[1], nullptr, 10) : 16 * 1024 * 1024;
+
+	std::mt19937 rng(42);
+
+	printf("%llu samples per run\n", (unsigned long long)sample_count);
+	printf("channels   bitwise [ms]   bit-plane [ms]   speedup\n");
+
+	for (unsigned int channel_count : {8, 16, 32}) {
+		// One input signal providing all channels, like a logic analyzer would
+		const unsigned int unit_size = channel_count / 8;
+
+		vector<uint8_t> input(sample_count * unit_size);
+		for (uint8_t& byte : input)
+			byte = rng();
+
+		vector<MuxChannel> channels;
+		for (unsigned int i = 0; i < channel_count; i++)
+			channels.push_back({input.data(), unit_size, i});
+
+		vector<uint8_t> expected(sample_count * unit_size), output(sample_count * unit_size);
+
+		const double t_bitwise = measure(mux_logic_channels_bitwise, channels,
+			sample_count, expected, unit_size);
+		const double t_planes = measure(mux_logic_channels, channels,
+			sample_count, output, unit_size);
+
+		if (output != expected) {
+			fprintf(stderr, "Output mismatch for %u channels\n", channel_count);
+			return 1;
+		}
+
+		printf("%8u   %12.1f   %14.1f   %6.1fx\n", channel_count,
+			t_bitwise * 1000, t_planes * 1000, t_bitwise / t_planes);
+	}
+
+	return 0;
+}
@@ -0,0 +1,117 @@
+/*
+ * This file is part of the PulseView project.
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <pv/data/decode/annotationspill.hpp>
+
+using std::shared_ptr;
+using std::vector;
+using std::weak_ptr;
+
+using pv::data::decode::AnnotationSpill;
+
+BOOST_AUTO_TEST_SUITE(AnnotationSpillTest)
+
+BOOST_AUTO_TEST_CASE(Store)
+{
+	AnnotationSpill spill;
+
+	const char first[] = "first";
+	const char second[] = "second block";
+
+	const void* const first_copy = spill.store(first, sizeof(first));
+	const void* const second_copy = spill.store(second, sizeof(second));
+	BOOST_REQUIRE(first_copy);
+	BOOST_REQUIRE(second_copy);
+
+	BOOST_CHECK(first_copy != first);
+	BOOST_CHECK_EQUAL(memcmp(first_copy, first, sizeof(first)), 0);
+	BOOST_CHECK_EQUAL(memcmp(second_copy, second, sizeof(second)), 0);
+
+	// The copies are aligned to 8 bytes
+	BOOST_CHECK_EQUAL((uintptr_t)second_copy % 8, 0);
+
+	BOOST_CHECK_EQUAL(spill.size(), sizeof(first) + sizeof(second));
+}
+
+BOOST_AUTO_TEST_CASE(Extents)
+{
+	AnnotationSpill spill;
+
+	// Fill more than one extent. The earlier copies must remain valid
+	const size_t block_size = 3 * 1024 * 1024 + 8;
+	const size_t count = 2 * AnnotationSpill::ExtentSize / block_size + 1;
+
+	vector<const uint8_t*> copies;
+	for (size_t i = 0; i < count; i++) {
+		const vector<uint8_t> block(block_size, i + 1);
+		copies.push_back((const uint8_t*)spill.store(block.data(), block.size()));
+		BOOST_REQUIRE(copies.back());
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		BOOST_CHECK_EQUAL((size_t)copies[i][0], i + 1);
+		BOOST_CHECK_EQUAL((size_t)copies[i][block_size - 1], i + 1);
+	}
+
+	// Data larger than an extent can't be stored
+	const vector<uint8_t> huge(AnnotationSpill::ExtentSize + 1);
+	BOOST_CHECK(spill.store(huge.data(), huge.size()) == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(Retire)
+{
+	AnnotationSpill spill;
+
+	shared_ptr<const void> buffer(new int(42));
+	const weak_ptr<const void> observer = buffer;
+
+	// Without readers, nothing can use the buffer anymore
+	spill.retire(buffer);
+	buffer.reset();
+	BOOST_CHECK(observer.expired());
+
+	buffer.reset(new int(43));
+	const weak_ptr<const void> read_observer = buffer;
+
+	{
+		AnnotationSpill::Reader reader(&spill);
+		AnnotationSpill::Reader other_reader(&spill);
+
+		spill.retire(buffer);
+		buffer.reset();
+		BOOST_CHECK(!read_observer.expired());
+
+		spill.release_retired();
+		BOOST_CHECK(!read_observer.expired());
+		BOOST_CHECK_EQUAL(spill.retired_count(), 1);
+	}
+
+	// The last reader frees it
+	BOOST_CHECK(read_observer.expired());
+	BOOST_CHECK_EQUAL(spill.retired_count(), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
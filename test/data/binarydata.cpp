@@ -0,0 +1,146 @@
+/*
+ * This file is part of the PulseView project.
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdint>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <pv/data/decode/binarydata.hpp>
+
+using std::vector;
+
+using pv::data::decode::BinaryData;
+
+BOOST_AUTO_TEST_SUITE(BinaryDataTest)
+
+static vector<uint8_t> make_chunk(uint64_t size, uint8_t first)
+{
+	vector<uint8_t> chunk(size);
+	for (uint64_t i = 0; i < size; i++)
+		chunk[i] = first + i;
+
+	return chunk;
+}
+
+BOOST_AUTO_TEST_CASE(Chunks)
+{
+	BinaryData data;
+
+	const vector<uint8_t> a = make_chunk(3, 10), b = make_chunk(5, 20);
+	data.append(100, a.data(), a.size());
+	data.append(200, nullptr, 0);
+	data.append(300, b.data(), b.size());
+
+	BOOST_CHECK_EQUAL(data.chunk_count(), 3);
+	BOOST_CHECK_EQUAL(data.size(), 8);
+
+	BOOST_CHECK_EQUAL(data.chunk_offset(2), 3);
+	BOOST_CHECK_EQUAL(data.chunk_size(1), 0);
+	BOOST_CHECK_EQUAL(data.chunk_sample(2), 300);
+
+	// The empty chunk holds no bytes
+	BOOST_CHECK_EQUAL(data.chunk_at_offset(0), 0);
+	BOOST_CHECK_EQUAL(data.chunk_at_offset(2), 0);
+	BOOST_CHECK_EQUAL(data.chunk_at_offset(3), 2);
+	BOOST_CHECK_EQUAL(data.chunk_at_offset(8), 3);
+
+	BOOST_CHECK_EQUAL(data.byte_at(2), 12);
+	BOOST_CHECK_EQUAL(data.byte_at(3), 20);
+}
+
+BOOST_AUTO_TEST_CASE(BlockBoundaries)
+{
+	BinaryData data;
+
+	// Chunks that straddle one or more blocks
+	const vector<uint8_t> a = make_chunk(BinaryData::BlockSize - 1, 0);
+	const vector<uint8_t> b = make_chunk(2 * BinaryData::BlockSize + 5, 7);
+	data.append(0, a.data(), a.size());
+	data.append(1, b.data(), b.size());
+
+	BOOST_CHECK_EQUAL(data.size(), a.size() + b.size());
+	BOOST_CHECK_EQUAL(data.chunk_at_offset(BinaryData::BlockSize), 1);
+	BOOST_CHECK_EQUAL(data.byte_at(BinaryData::BlockSize), b[1]);
+
+	vector<uint8_t> out;
+	data.get_data_by_offset(a.size(), data.size(), &out);
+	BOOST_CHECK(out == b);
+
+	data.get_data_by_offset(a.size() - 2, a.size() + 1, &out);
+	BOOST_REQUIRE_EQUAL(out.size(), 3);
+	BOOST_CHECK_EQUAL(out[0], a[a.size() - 2]);
+	BOOST_CHECK_EQUAL(out[2], b[0]);
+
+	// Ranges reaching beyond the data are cropped
+	data.get_data_by_offset(data.size() - 1, data.size() + 10, &out);
+	BOOST_CHECK_EQUAL(out.size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(BySample)
+{
+	const vector<uint8_t> a = make_chunk(2, 10), b = make_chunk(3, 20),
+		c = make_chunk(4, 30);
+
+	vector<uint8_t> expected(b);
+	expected.insert(expected.end(), c.begin(), c.end());
+
+	vector<uint8_t> out;
+
+	BinaryData in_order;
+	in_order.append(10, a.data(), a.size());
+	in_order.append(20, b.data(), b.size());
+	in_order.append(30, c.data(), c.size());
+
+	in_order.get_data_by_sample(15, 31, &out);
+	BOOST_CHECK(out == expected);
+
+	in_order.get_data_by_sample(40, 50, &out);
+	BOOST_CHECK(out.empty());
+
+	// Chunks of parts that were decoded out of order
+	BinaryData out_of_order;
+	out_of_order.append(20, b.data(), b.size());
+	out_of_order.append(10, a.data(), a.size());
+	out_of_order.append(30, c.data(), c.size());
+
+	out_of_order.get_data_by_sample(15, 31, &out);
+	BOOST_CHECK(out == expected);
+}
+
+BOOST_AUTO_TEST_CASE(Clear)
+{
+	BinaryData data;
+
+	const vector<uint8_t> a = make_chunk(3, 10);
+	data.append(20, a.data(), a.size());
+	data.clear();
+
+	BOOST_CHECK_EQUAL(data.chunk_count(), 0);
+	BOOST_CHECK_EQUAL(data.size(), 0);
+
+	// Samples are in order again
+	data.append(10, a.data(), a.size());
+
+	vector<uint8_t> out;
+	data.get_data_by_sample(0, 11, &out);
+	BOOST_CHECK(out == a);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
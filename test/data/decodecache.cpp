@@ -0,0 +1,108 @@
+/*
+ * This file is part of the PulseView project.
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QByteArray>
+#include <QFile>
+#include <QTemporaryDir>
+
+#include <boost/test/unit_test.hpp>
+
+#include <pv/data/decode/decodecache.hpp>
+
+using pv::data::decode::DecodeCacheReader;
+using pv::data::decode::DecodeCacheWriter;
+using pv::data::decode::decodecache::AnnotationRecord;
+using pv::data::decode::decodecache::BinaryDataRecord;
+
+BOOST_AUTO_TEST_SUITE(DecodeCacheTest)
+
+static void write_file(const QString& path)
+{
+	DecodeCacheWriter writer(path);
+	BOOST_REQUIRE(writer.open());
+
+	const uint32_t start = writer.add_texts(QByteArray("Start\0S\0", 8));
+	const uint32_t data = writer.add_texts(QByteArray("Data: 0x55\0", 11));
+
+	writer.add_annotation(0, 1, 10, 20, start);
+	writer.add_annotation(1, 3, 20, 100, data);
+
+	const uint8_t bytes[] = {1, 2, 3};
+	writer.add_binary_data(1, 0, 20, bytes, sizeof(bytes));
+	writer.add_binary_data(1, 2, 30, bytes, 1);
+
+	BOOST_REQUIRE(writer.finish());
+}
+
+BOOST_AUTO_TEST_CASE(RoundTrip)
+{
+	QTemporaryDir dir;
+	const QString path = dir.path() + "/test.pvdc";
+	write_file(path);
+
+	DecodeCacheReader reader(path);
+	BOOST_REQUIRE(reader.open());
+
+	BOOST_REQUIRE_EQUAL(reader.annotation_count(), 2);
+	const AnnotationRecord* annotations = reader.annotations();
+	BOOST_CHECK_EQUAL(annotations[0].start_sample, 10);
+	BOOST_CHECK_EQUAL(annotations[0].end_sample, 20);
+	BOOST_CHECK_EQUAL(annotations[0].ann_class, 1);
+	BOOST_CHECK_EQUAL(annotations[0].decoder, 0);
+	BOOST_CHECK_EQUAL(annotations[1].decoder, 1);
+
+	const char* const* texts = reader.texts(annotations[0].text_id);
+	BOOST_CHECK_EQUAL(texts[0], "Start");
+	BOOST_CHECK_EQUAL(texts[1], "S");
+	BOOST_CHECK(texts[2] == nullptr);
+	BOOST_CHECK_EQUAL(reader.texts(annotations[1].text_id)[0], "Data: 0x55");
+
+	BOOST_REQUIRE_EQUAL(reader.binary_data_count(), 2);
+	const BinaryDataRecord* record = reader.binary_data(0);
+	BOOST_CHECK_EQUAL(record->sample, 20);
+	BOOST_CHECK_EQUAL(record->size, 3);
+	BOOST_CHECK_EQUAL(reader.binary_data_bytes(0)[2], 3);
+	BOOST_CHECK_EQUAL(reader.binary_data(1)->bin_class, 2);
+	BOOST_CHECK_EQUAL(reader.binary_data_bytes(1)[0], 1);
+}
+
+BOOST_AUTO_TEST_CASE(Truncated)
+{
+	QTemporaryDir dir;
+	const QString path = dir.path() + "/test.pvdc";
+	write_file(path);
+
+	QFile file(path);
+	BOOST_REQUIRE(file.open(QIODevice::ReadWrite));
+	file.resize(file.size() - 4);
+	file.close();
+
+	DecodeCacheReader reader(path);
+	BOOST_CHECK(!reader.open());
+}
+
+BOOST_AUTO_TEST_CASE(Missing)
+{
+	QTemporaryDir dir;
+
+	DecodeCacheReader reader(dir.path() + "/missing.pvdc");
+	BOOST_CHECK(!reader.open());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
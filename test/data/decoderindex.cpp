@@ -0,0 +1,118 @@
+/*
+ * This file is part of the PulseView project.
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <vector>
+
+#include <QDir>
+#include <QTemporaryDir>
+
+#include <boost/test/unit_test.hpp>
+
+#include <pv/data/decode/decoderindex.hpp>
+
+using std::vector;
+
+using pv::data::decode::DecoderIndex;
+using pv::data::decode::DecoderInfo;
+
+BOOST_AUTO_TEST_SUITE(DecoderIndexTest)
+
+static vector<DecoderInfo> make_decoders()
+{
+	vector<DecoderInfo> decoders(2);
+
+	decoders[0].id = "i2c";
+	decoders[0].name = "I²C";
+	decoders[0].longname = "Inter-Integrated Circuit";
+	decoders[0].doc = "Two-wire bus.";
+	decoders[0].tags << "Embedded/industrial";
+	decoders[0].inputs << "logic";
+	decoders[0].outputs << "i2c";
+	decoders[0].channels << "scl" << "sda";
+	decoders[0].options << "address_format";
+	decoders[0].classes << "start" << "repeat-start" << "stop";
+
+	decoders[1].id = "eeprom24xx";
+	decoders[1].name = "24xx EEPROM";
+	decoders[1].inputs << "i2c";
+
+	return decoders;
+}
+
+BOOST_AUTO_TEST_CASE(RoundTrip)
+{
+	QTemporaryDir dir;
+	const QString path = dir.path() + "/index.json";
+	const QStringList stamp("stamp");
+
+	BOOST_REQUIRE(DecoderIndex::write(path, stamp, make_decoders()));
+
+	vector<DecoderInfo> decoders;
+	BOOST_REQUIRE(DecoderIndex::read(path, stamp, decoders));
+	BOOST_REQUIRE_EQUAL(decoders.size(), 2);
+
+	// The decoders are sorted by their IDs
+	BOOST_CHECK(decoders[0].id == "eeprom24xx");
+	BOOST_CHECK(decoders[0].inputs == QStringList("i2c"));
+	BOOST_CHECK(decoders[0].outputs.isEmpty());
+
+	const DecoderInfo& i2c = decoders[1];
+	BOOST_CHECK(i2c.id == "i2c");
+	BOOST_CHECK(i2c.name == QString::fromUtf8("I²C"));
+	BOOST_CHECK(i2c.longname == "Inter-Integrated Circuit");
+	BOOST_CHECK(i2c.doc == "Two-wire bus.");
+	BOOST_CHECK(i2c.tags == QStringList("Embedded/industrial"));
+	BOOST_CHECK(i2c.channels == (QStringList() << "scl" << "sda"));
+	BOOST_CHECK(i2c.opt_channels.isEmpty());
+	BOOST_CHECK(i2c.options == QStringList("address_format"));
+	BOOST_CHECK_EQUAL(i2c.classes.size(), 3);
+}
+
+BOOST_AUTO_TEST_CASE(OutOfDate)
+{
+	QTemporaryDir dir;
+	const QString path = dir.path() + "/index.json";
+
+	vector<DecoderInfo> decoders;
+	BOOST_CHECK(!DecoderIndex::read(path, QStringList("a"), decoders));
+
+	BOOST_REQUIRE(DecoderIndex::write(path, QStringList("a"), make_decoders()));
+	BOOST_CHECK(!DecoderIndex::read(path, QStringList("b"), decoders));
+	BOOST_CHECK(decoders.empty());
+}
+
+BOOST_AUTO_TEST_CASE(DirectoryStamp)
+{
+	QTemporaryDir dir;
+	QDir(dir.path()).mkdir("uart");
+
+	const QStringList paths = QStringList() << dir.path() << dir.path() + "/missing";
+
+	const QStringList stamp = DecoderIndex::directory_stamp(paths);
+
+	// One entry for the search path and one for the decoder directory
+	BOOST_CHECK_EQUAL(stamp.size(), 2);
+	BOOST_CHECK(DecoderIndex::directory_stamp(paths) == stamp);
+
+	// Adding a decoder invalidates the stamp
+	QDir(dir.path()).mkdir("spi");
+	BOOST_CHECK(DecoderIndex::directory_stamp(paths) != stamp);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,88 @@
+/*
+ * This file is part of the PulseView project.
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <pv/data/decode/logicmux.hpp>
+
+using std::vector;
+
+using pv::data::decode::MuxChannel;
+using pv::data::decode::mux_logic_channels;
+using pv::data::decode::mux_logic_channels_bitwise;
+
+BOOST_AUTO_TEST_SUITE(LogicMuxTest)
+
+BOOST_AUTO_TEST_CASE(Basic)
+{
+	// Two samples, channels in reverse order
+	const uint8_t input[] = {0x81, 0x42};
+	vector<MuxChannel> channels;
+	for (unsigned int i = 0; i < 8; i++)
+		channels.push_back({input, 1, 7 - i});
+
+	uint8_t output[2];
+	mux_logic_channels(channels, 2, output, 1);
+
+	BOOST_CHECK_EQUAL(output[0], 0x81);
+	BOOST_CHECK_EQUAL(output[1], 0x42);
+}
+
+BOOST_AUTO_TEST_CASE(MatchesBitwise)
+{
+	std::mt19937 rng(1);
+
+	for (unsigned int run = 0; run < 100; run++) {
+		const uint64_t sample_count = rng() % 100 + 1;
+		const unsigned int unit_size_a = rng() % 4 + 1, unit_size_b = rng() % 2 + 1;
+
+		vector<uint8_t> a(sample_count * unit_size_a), b(sample_count * unit_size_b);
+		for (uint8_t& byte : a)
+			byte = rng();
+		for (uint8_t& byte : b)
+			byte = rng();
+
+		// Channels from two inputs in random order, sometimes used twice
+		vector<MuxChannel> channels;
+		const unsigned int channel_count = rng() % 20 + 1;
+		for (unsigned int i = 0; i < channel_count; i++) {
+			if (rng() % 2)
+				channels.push_back({a.data(), unit_size_a, (unsigned int)(rng() % (8 * unit_size_a))});
+			else
+				channels.push_back({b.data(), unit_size_b, (unsigned int)(rng() % (8 * unit_size_b))});
+		}
+
+		// Also check that spare output bytes are cleared
+		const unsigned int out_unit_size = (channel_count + 7) / 8 + rng() % 2;
+
+		vector<uint8_t> expected(sample_count * out_unit_size, 0x55);
+		vector<uint8_t> output(sample_count * out_unit_size, 0xAA);
+
+		mux_logic_channels_bitwise(channels, sample_count, expected.data(), out_unit_size);
+		mux_logic_channels(channels, sample_count, output.data(), out_unit_size);
+
+		BOOST_CHECK(output == expected);
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -20,11 +20,20 @@
 #include <extdef.h>
 
 #include <cstdint>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
 
 #include <boost/test/unit_test.hpp>
 
+#include <pv/data/logic.hpp>
 #include <pv/data/logicsegment.hpp>
 
+using std::make_shared;
+using std::shared_ptr;
+using std::vector;
+
 #if 0
 using pv::data::LogicSegment;
 using std::vector;
@@ -38,6 +47,101 @@ BOOST_AUTO_TEST_CASE(DummyTestCase)
 }
 BOOST_AUTO_TEST_SUITE_END()
 
+BOOST_AUTO_TEST_SUITE(LogicSegmentRunTest)
+
+/*
+ * Appends runs of repeated samples the way decoders output logic data and
+ * checks that the samples and all mip-map levels are the same as when the
+ * expanded runs are appended as regular payload. The runs vary in length,
+ * start and end within mip-map blocks and are mixed with regular payload,
+ * so that both paths take over each other's partial blocks.
+ */
+BOOST_AUTO_TEST_CASE(RepeatedPayload)
+{
+	using pv::data::Logic;
+	using pv::data::LogicSegment;
+
+	const unsigned int unit_sizes[] = {1, 2, 3, 4, 8};
+	const uint64_t run_lengths[] = {1, 2, 15, 16, 17, 31, 33, 255, 256, 257, 4095, 4097};
+
+	std::mt19937 rng(42);
+
+	for (const unsigned int unit_size : unit_sizes) {
+		BOOST_TEST_MESSAGE("Unit size " << unit_size);
+
+		Logic logic(unit_size * 8);
+		shared_ptr<LogicSegment> runs =
+			make_shared<LogicSegment>(logic, 0, unit_size, 1);
+		shared_ptr<LogicSegment> expanded =
+			make_shared<LogicSegment>(logic, 1, unit_size, 1);
+
+		vector<uint8_t> value(unit_size, 0);
+		vector<uint8_t> data;
+
+		for (int i = 0; i < 2000; i++) {
+			const unsigned int op = rng() % 16;
+
+			if ((op == 0) && (i != 1000)) {
+				// Regular payload, changing from sample to sample
+				data.resize((1 + rng() % 100) * unit_size);
+				for (uint8_t& byte : data)
+					byte = rng();
+				memcpy(value.data(), &data[data.size() - unit_size], unit_size);
+
+				runs->append_payload(data.data(), data.size());
+				expanded->append_payload(data.data(), data.size());
+				continue;
+			}
+
+			// Keep the value now and then so that runs continue
+			// seamlessly, otherwise let some of the channels change
+			if (op > 2)
+				for (uint8_t& byte : value)
+					byte ^= rng() & rng();
+
+			uint64_t count;
+			if (i == 1000)
+				count = 3 * 1024 * 1024 + 5;  // Spans several mip-map data units
+			else if (op < 8)
+				count = run_lengths[rng() % (sizeof(run_lengths) / sizeof(run_lengths[0]))];
+			else
+				count = 1 + rng() % 64;
+
+			runs->append_repeated_payload(value.data(), count);
+
+			data.resize(count * unit_size);
+			for (uint64_t j = 0; j < count; j++)
+				memcpy(&data[j * unit_size], value.data(), unit_size);
+			expanded->append_payload(data.data(), data.size());
+		}
+
+		const uint64_t sample_count = expanded->get_sample_count();
+		BOOST_REQUIRE_EQUAL(runs->get_sample_count(), sample_count);
+
+		vector<uint8_t> run_samples(sample_count * unit_size);
+		vector<uint8_t> expanded_samples(sample_count * unit_size);
+		runs->get_samples(0, sample_count, run_samples.data());
+		expanded->get_samples(0, sample_count, expanded_samples.data());
+		BOOST_CHECK(run_samples == expanded_samples);
+
+		for (unsigned int level = 0; level < LogicSegment::ScaleStepCount; level++) {
+			const LogicSegment::MipMapLevel& r = runs->mip_map_[level];
+			const LogicSegment::MipMapLevel& e = expanded->mip_map_[level];
+
+			BOOST_TEST_MESSAGE("Mip-map level " << level);
+			BOOST_REQUIRE_EQUAL(r.length, e.length);
+
+			if (r.length > 0)
+				BOOST_CHECK(memcmp(r.data, e.data, r.length * unit_size) == 0);
+		}
+
+		// The higher levels must have been reached, too
+		BOOST_CHECK_GT(runs->mip_map_[4].length, 0);
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
 #if 0
 BOOST_AUTO_TEST_SUITE(LogicSegmentTest)
 
@@ -0,0 +1,124 @@
+/*
+ * This file is part of the PulseView project.
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <pv/data/mathfilter.hpp>
+
+using std::min;
+using std::vector;
+
+using pv::data::MathFilter;
+
+BOOST_AUTO_TEST_SUITE(MathFilterTest)
+
+static vector<float> make_signal(size_t length)
+{
+	// 50 Hz and 3 kHz at a sample rate of 10 kHz
+	vector<float> signal(length);
+	for (size_t i = 0; i < length; i++)
+		signal[i] = sin(2 * M_PI * i * 50 / 10000.0) +
+			sin(2 * M_PI * i * 3000 / 10000.0);
+
+	return signal;
+}
+
+BOOST_AUTO_TEST_CASE(MovingAverage)
+{
+	const float input[] = {3, 6, 9, 12, 15};
+	float output[5];
+
+	MathFilter f(MathFilter::MovingAverage, 1, 3);
+	f.process(input, output, 5);
+
+	BOOST_CHECK_EQUAL(f.history_length(), 2);
+
+	// Samples before the start of the stream count as 0
+	BOOST_CHECK_CLOSE(output[0], 1.0f, 0.001);
+	BOOST_CHECK_CLOSE(output[1], 3.0f, 0.001);
+	BOOST_CHECK_CLOSE(output[2], 6.0f, 0.001);
+	BOOST_CHECK_CLOSE(output[3], 9.0f, 0.001);
+	BOOST_CHECK_CLOSE(output[4], 12.0f, 0.001);
+}
+
+BOOST_AUTO_TEST_CASE(BlockwiseProcessing)
+{
+	const size_t length = 10000;
+	const vector<float> input = make_signal(length);
+
+	const MathFilter::Type types[] = {
+		MathFilter::MovingAverage, MathFilter::FIRLowpass,
+		MathFilter::FIRBandpass, MathFilter::IIRLowpass};
+
+	for (MathFilter::Type type : types) {
+		MathFilter f1(type, 10000, 100, 1000, 63);
+		MathFilter f2(type, 10000, 100, 1000, 63);
+
+		vector<float> whole(length), blocks(length);
+		f1.process(input.data(), whole.data(), length);
+
+		for (size_t i = 0; i < length; i += 777)
+			f2.process(input.data() + i, blocks.data() + i, min((size_t)777, length - i));
+
+		BOOST_CHECK(whole == blocks);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(Lowpass)
+{
+	const size_t length = 10000;
+	const vector<float> input = make_signal(length);
+
+	const MathFilter::Type types[] = {MathFilter::FIRLowpass, MathFilter::IIRLowpass};
+
+	for (MathFilter::Type type : types) {
+		MathFilter f(type, 10000, 500, (type == MathFilter::FIRLowpass) ? 63 : 0);
+
+		vector<float> output(length);
+		f.process(input.data(), output.data(), length);
+
+		// Once settled, only the 50 Hz component may be left
+		double sum = 0;
+		for (size_t i = 1000; i < length; i++)
+			sum += output[i] * output[i];
+
+		BOOST_CHECK_CLOSE(sqrt(sum / (length - 1000)), M_SQRT1_2, 5);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(Reset)
+{
+	const size_t length = 1000;
+	const vector<float> input = make_signal(length);
+
+	MathFilter f(MathFilter::IIRHighpass, 10000, 1000);
+
+	vector<float> first(length), second(length);
+	f.process(input.data(), first.data(), length);
+	f.reset();
+	f.process(input.data(), second.data(), length);
+
+	BOOST_CHECK(first == second);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,109 @@
+/*
+ * This file is part of the PulseView project.
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <memory>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <pv/data/decode/muxcache.hpp>
+
+using std::make_shared;
+using std::shared_ptr;
+using std::vector;
+
+using pv::data::decode::MuxCache;
+using pv::data::decode::MuxInput;
+
+BOOST_AUTO_TEST_SUITE(MuxCacheTest)
+
+static MuxCache::Block make_block(uint8_t value)
+{
+	return make_shared< vector<uint8_t> >(16, value);
+}
+
+BOOST_AUTO_TEST_CASE(SharedByIdenticalInputs)
+{
+	MuxCache cache;
+	shared_ptr<int> scl = make_shared<int>(0), sda = make_shared<int>(0);
+
+	const vector<MuxInput> inputs = {{scl, 0}, {sda, 3}};
+	MuxCache::Block block = make_block(1);
+	cache.insert(inputs, 0, 16, block);
+
+	// The same inputs in the same order for the same range
+	const vector<MuxInput> same_inputs = {{scl, 0}, {sda, 3}};
+	BOOST_CHECK(cache.find(same_inputs, 0, 16) == block);
+
+	BOOST_CHECK(!cache.find(inputs, 0, 8));
+	BOOST_CHECK(!cache.find(inputs, 16, 32));
+
+	const vector<MuxInput> swapped = {{sda, 3}, {scl, 0}};
+	BOOST_CHECK(!cache.find(swapped, 0, 16));
+
+	const vector<MuxInput> other_bit = {{scl, 1}, {sda, 3}};
+	BOOST_CHECK(!cache.find(other_bit, 0, 16));
+}
+
+BOOST_AUTO_TEST_CASE(BlockLifetime)
+{
+	MuxCache cache(2);
+	shared_ptr<int> segment = make_shared<int>(0);
+	const vector<MuxInput> inputs = {{segment, 0}};
+
+	// Blocks that are neither used nor among the retained ones are dropped
+	cache.insert(inputs, 0, 16, make_block(0));
+	cache.insert(inputs, 16, 32, make_block(1));
+	BOOST_CHECK(cache.find(inputs, 0, 16));
+
+	cache.insert(inputs, 32, 48, make_block(2));
+	BOOST_CHECK(!cache.find(inputs, 0, 16));
+	BOOST_CHECK(cache.find(inputs, 16, 32));
+	BOOST_CHECK_EQUAL(cache.size(), 2);
+
+	// As long as a block is used, it can be found
+	MuxCache::Block used = make_block(3);
+	cache.insert(inputs, 48, 64, used);
+	cache.insert(inputs, 64, 80, make_block(4));
+	cache.insert(inputs, 80, 96, make_block(5));
+	BOOST_CHECK(cache.find(inputs, 48, 64) == used);
+
+	cache.clear();
+	BOOST_CHECK(!cache.find(inputs, 48, 64));
+}
+
+BOOST_AUTO_TEST_CASE(InputSegmentGone)
+{
+	MuxCache cache;
+	shared_ptr<int> segment = make_shared<int>(0);
+
+	MuxCache::Block block = make_block(0);
+	cache.insert({{segment, 0}}, 0, 16, block);
+
+	// Another segment may be created at the same address later on, so the
+	// address alone must not be enough to find the block
+	const void* const address = segment.get();
+	segment.reset();
+
+	const shared_ptr<const void> same_address(address, [](const void*) {});
+	BOOST_CHECK(!cache.find({{same_address, 0}}, 0, 16));
+	BOOST_CHECK_EQUAL(cache.size(), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,87 @@
+/*
+ * This file is part of the PulseView project.
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <thread>
+
+#include <boost/test/unit_test.hpp>
+
+#include <pv/data/decode/muxqueue.hpp>
+
+using pv::data::decode::MuxChunk;
+using pv::data::decode::MuxQueue;
+
+BOOST_AUTO_TEST_SUITE(MuxQueueTest)
+
+BOOST_AUTO_TEST_CASE(ProducerConsumer)
+{
+	const unsigned int chunk_count = 3;
+	const int64_t total = 1000;
+
+	MuxQueue queue(chunk_count);
+
+	std::thread producer([&]() {
+		for (int64_t i = 0; i < total; i++) {
+			MuxChunk* chunk = queue.get_free_chunk();
+			chunk->start_sample = i;
+			chunk->data.assign(1, (uint8_t)i);
+			queue.push(chunk);
+		}
+	});
+
+	for (int64_t i = 0; i < total; i++) {
+		MuxChunk* chunk = queue.pop();
+		BOOST_REQUIRE(chunk);
+		BOOST_CHECK_EQUAL(chunk->start_sample, i);
+		BOOST_CHECK_EQUAL(chunk->data.at(0), (uint8_t)i);
+		queue.release(chunk);
+	}
+
+	producer.join();
+}
+
+BOOST_AUTO_TEST_CASE(Bounded)
+{
+	MuxQueue queue(2);
+
+	MuxChunk* a = queue.get_free_chunk();
+	MuxChunk* b = queue.get_free_chunk();
+	BOOST_CHECK(a && b && (a != b));
+
+	queue.push(a);
+	queue.push(b);
+	BOOST_CHECK_EQUAL(queue.filled_count(), 2);
+
+	// All chunks are in use, so the producer blocks until interrupted
+	std::thread producer([&]() {
+		BOOST_CHECK(queue.get_free_chunk() == nullptr);
+	});
+
+	queue.interrupt();
+	producer.join();
+
+	BOOST_CHECK(queue.pop() == nullptr);
+
+	// After a reset, all chunks are available again and nothing is queued
+	queue.reset();
+	BOOST_CHECK_EQUAL(queue.filled_count(), 0);
+	BOOST_CHECK(queue.get_free_chunk() != nullptr);
+	BOOST_CHECK(queue.get_free_chunk() != nullptr);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,120 @@
+/*
+ * This file is part of the PulseView project.
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string>
+#include <thread>
+
+#include <boost/test/unit_test.hpp>
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <pv/data/decode/profiler.hpp>
+
+using std::string;
+
+using pv::data::decode::Profiler;
+
+BOOST_AUTO_TEST_SUITE(ProfilerTest)
+
+BOOST_AUTO_TEST_CASE(StageTimes)
+{
+	Profiler profiler;
+
+	{
+		Profiler::StageTimer decode(profiler, Profiler::DecodeStage);
+		for (int i = 0; i < 3; i++)
+			profiler.add_annotation();
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	}
+
+	{
+		Profiler::StageTimer annotation(profiler, Profiler::AnnotationStage);
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+	}
+	profiler.add_samples(1000);
+
+	const Profiler::Snapshot s = profiler.snapshot();
+
+	BOOST_CHECK_EQUAL(s.stages[Profiler::DecodeStage].calls, 1);
+	BOOST_CHECK_EQUAL(s.stages[Profiler::AnnotationStage].calls, 1);
+	BOOST_CHECK_EQUAL(s.stages[Profiler::MuxStage].calls, 0);
+
+	// Sleeping may take longer than requested, but never shorter
+	BOOST_CHECK_GE(s.stages[Profiler::DecodeStage].wall_time, 0.02);
+	BOOST_CHECK_GE(s.stages[Profiler::AnnotationStage].wall_time, 0.005);
+	BOOST_CHECK_EQUAL(s.stages[Profiler::MuxStage].wall_time, 0);
+
+	BOOST_CHECK_EQUAL(s.sample_count, 1000);
+	BOOST_CHECK_EQUAL(s.annotation_count, 3);
+	BOOST_CHECK_GE(s.elapsed_time, s.stages[Profiler::DecodeStage].wall_time +
+		s.stages[Profiler::AnnotationStage].wall_time);
+	BOOST_CHECK_CLOSE(s.annotations_per_second(), 3 / s.elapsed_time, 0.001);
+}
+
+BOOST_AUTO_TEST_CASE(QueueDepth)
+{
+	Profiler profiler;
+
+	profiler.add_queue_depth(1);
+	profiler.add_queue_depth(4);
+	profiler.add_queue_depth(1);
+
+	const Profiler::Snapshot s = profiler.snapshot();
+	BOOST_CHECK_EQUAL(s.max_queue_depth, 4);
+	BOOST_CHECK_CLOSE(s.mean_queue_depth, 2.0, 0.001);
+
+	profiler.reset();
+	BOOST_CHECK_EQUAL(profiler.snapshot().max_queue_depth, 0);
+	BOOST_CHECK_EQUAL(profiler.snapshot().sample_count, 0);
+}
+
+BOOST_AUTO_TEST_CASE(Json)
+{
+	Profiler profiler;
+
+	{
+		Profiler::StageTimer mux(profiler, Profiler::MuxStage);
+	}
+	profiler.add_samples(42);
+	profiler.add_queue_depth(3);
+
+	const string json = Profiler::to_json(profiler.snapshot(), {"i2c", "eeprom24xx"});
+
+	QJsonParseError error;
+	const QJsonDocument doc = QJsonDocument::fromJson(QByteArray::fromStdString(json), &error);
+	BOOST_REQUIRE_EQUAL(error.error, QJsonParseError::NoError);
+	const QJsonObject root = doc.object();
+
+	const QJsonArray decoders = root["decoders"].toArray();
+	BOOST_REQUIRE_EQUAL(decoders.size(), 2);
+	BOOST_CHECK(decoders[0].toString() == "i2c");
+	BOOST_CHECK(decoders[1].toString() == "eeprom24xx");
+
+	const QJsonObject stages = root["stages"].toObject();
+	BOOST_CHECK_EQUAL(stages["mux"].toObject()["calls"].toInt(), 1);
+	BOOST_CHECK_EQUAL(stages["annotations"].toObject()["calls"].toInt(), 0);
+	BOOST_CHECK(stages["copy"].toObject().contains("cpu_s"));
+
+	BOOST_CHECK_EQUAL(root["samples"].toInt(), 42);
+	BOOST_CHECK_EQUAL(root["queue"].toObject()["max_depth"].toInt(), 3);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,348 @@
+/*
+ * This file is part of the PulseView project.
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <libsigrokdecode/libsigrokdecode.h> /* First, so we avoid a _POSIX_C_SOURCE warning. */
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <pv/data/decode/annotation.hpp>
+#include <pv/data/decode/annotationspill.hpp>
+#include <pv/data/decode/decoder.hpp>
+#include <pv/data/decode/row.hpp>
+#include <pv/data/decode/rowdata.hpp>
+#include <pv/data/decode/textpool.hpp>
+
+using std::atomic;
+using std::deque;
+using std::lock_guard;
+using std::min;
+using std::max;
+using std::mutex;
+using std::stable_sort;
+using std::unique_ptr;
+using std::vector;
+
+using pv::data::decode::Annotation;
+using pv::data::decode::AnnotationSpill;
+using pv::data::decode::Decoder;
+using pv::data::decode::Row;
+using pv::data::decode::RowData;
+using pv::data::decode::TextPool;
+
+namespace {
+
+const char* const ClassNames[] = {"data", "address", "warning", "start", "stop"};
+const unsigned int ClassCount = sizeof(ClassNames) / sizeof(ClassNames[0]);
+
+/**
+ * A decoder with ClassCount annotation classes and no row declarations,
+ * so that all classes end up in the same row.
+ */
+struct TestDecoder
+{
+	TestDecoder()
+	{
+		memset(&srd_dec, 0, sizeof(srd_dec));
+		srd_dec.id = (char*)"test";
+		srd_dec.name = (char*)"Test";
+
+		for (const char* name : ClassNames) {
+			class_names.push_back({(char*)name, (char*)name});
+			srd_dec.annotations = g_slist_append(srd_dec.annotations,
+				class_names.back().data());
+		}
+
+		decoder.reset(new Decoder(&srd_dec, 0));
+		row = decoder->get_rows().front();
+	}
+
+	~TestDecoder()
+	{
+		decoder.reset();
+		g_slist_free(srd_dec.annotations);
+	}
+
+	srd_decoder srd_dec;
+	deque< vector<char*> > class_names;
+	unique_ptr<Decoder> decoder;
+	Row* row;
+};
+
+void add_annotation(RowData& row_data, uint64_t start_sample, uint64_t end_sample,
+	uint32_t ann_class)
+{
+	const char* texts[] = {ClassNames[ann_class], nullptr};
+
+	srd_proto_data_annotation pda;
+	memset(&pda, 0, sizeof(pda));
+	pda.ann_class = ann_class;
+	pda.ann_text = (decltype(pda.ann_text))texts;
+
+	srd_proto_data pdata;
+	memset(&pdata, 0, sizeof(pdata));
+	pdata.start_sample = start_sample;
+	pdata.end_sample = end_sample;
+	pdata.data = &pda;
+
+	row_data.emplace_annotation(&pdata);
+}
+
+struct ModelAnnotation
+{
+	uint64_t start_sample, end_sample;
+	uint32_t ann_class;
+};
+
+/**
+ * Compares the result of a query with what filtering all annotations one
+ * by one yields. @c sorted holds the indices of the annotations ordered by
+ * start sample, keeping the order of arrival for equal start samples.
+ */
+void check_subset(const RowData& row_data, const vector<ModelAnnotation>& model,
+	const vector<uint32_t>& sorted, const vector<bool>& class_visible,
+	uint64_t start_sample, uint64_t end_sample)
+{
+	vector<uint32_t> expected;
+	for (uint32_t index : sorted) {
+		const ModelAnnotation& a = model[index];
+		if ((a.end_sample > start_sample) && (a.start_sample <= end_sample) &&
+			class_visible[a.ann_class])
+			expected.push_back(index);
+	}
+
+	deque<Annotation> result;
+	row_data.get_annotation_subset(result, start_sample, end_sample);
+
+	vector<uint32_t> actual;
+	for (const Annotation& a : result)
+		actual.push_back(a.index());
+
+	BOOST_REQUIRE_MESSAGE(actual == expected, "Query " << start_sample << ".." <<
+		end_sample << " returned " << actual.size() << " annotations instead of " <<
+		expected.size());
+
+	for (const Annotation& a : result) {
+		const ModelAnnotation& m = model[a.index()];
+		BOOST_REQUIRE_EQUAL(a.start_sample(), m.start_sample);
+		BOOST_REQUIRE_EQUAL(a.end_sample(), m.end_sample);
+		BOOST_REQUIRE_EQUAL(a.ann_class_id(), m.ann_class);
+	}
+}
+
+/**
+ * Adds batches of random annotations and runs random queries in between,
+ * so that the index is updated incrementally.
+ *
+ * @param out_of_order_permille How many of the annotations start before
+ * the one added before them.
+ * @param clustered_classes If set, the class changes only every few blocks
+ * so that whole blocks can be skipped when classes are hidden.
+ */
+void fuzz(unsigned int seed, unsigned int out_of_order_permille,
+	bool clustered_classes, AnnotationSpill* spill)
+{
+	std::mt19937 rng(seed);
+
+	TestDecoder dec;
+	TextPool text_pool;
+	RowData row_data(dec.row, &text_pool, spill);
+
+	vector<ModelAnnotation> model;
+	vector<uint32_t> sorted;
+	vector<bool> class_visible(ClassCount, true);
+	uint64_t start_sample = 0, max_sample = 0;
+
+	for (int round = 0; round < 40; round++) {
+		const uint32_t batch_size = 1 + rng() % 1500;
+
+		for (uint32_t i = 0; i < batch_size; i++) {
+			const uint32_t n = model.size();
+			start_sample += rng() % 20;
+
+			ModelAnnotation a;
+			a.start_sample = start_sample;
+			if (rng() % 1000 < out_of_order_permille)
+				a.start_sample -= min<uint64_t>(start_sample, rng() % 5000);
+
+			// Most annotations are short, a few span many others
+			a.end_sample = a.start_sample + ((rng() % 100 == 0) ?
+				(rng() % 20000) : (rng() % 40));
+
+			a.ann_class = clustered_classes ?
+				((n / (3 * RowData::BlockSize)) % ClassCount) : (rng() % ClassCount);
+
+			add_annotation(row_data, a.start_sample, a.end_sample, a.ann_class);
+			model.push_back(a);
+			max_sample = max(max_sample, a.end_sample);
+		}
+
+		sorted.resize(model.size());
+		for (uint32_t i = 0; i < model.size(); i++)
+			sorted[i] = i;
+		stable_sort(sorted.begin(), sorted.end(), [&](uint32_t a, uint32_t b) {
+			return model[a].start_sample < model[b].start_sample; });
+
+		// Show all classes now and then, otherwise hide some or all of them
+		const bool all_visible = (rng() % 3 == 0);
+		for (uint32_t id = 0; id < ClassCount; id++) {
+			class_visible[id] = all_visible || (rng() % 3 != 0);
+			dec.decoder->get_ann_class_by_id(id)->set_visible(class_visible[id]);
+		}
+
+		for (int query = 0; query < 8; query++) {
+			const uint64_t first = rng() % (max_sample + 100);
+
+			uint64_t last;
+			switch (rng() % 4) {
+			case 0: last = first; break;
+			case 1: last = first + rng() % 50; break;
+			case 2: last = first + rng() % 50000; break;
+			default: last = UINT64_MAX; break;
+			}
+
+			check_subset(row_data, model, sorted, class_visible, first, last);
+		}
+
+		// Annotations touching the boundaries of the range
+		const ModelAnnotation& a = model[rng() % model.size()];
+		check_subset(row_data, model, sorted, class_visible, a.start_sample, a.start_sample);
+		check_subset(row_data, model, sorted, class_visible, a.end_sample, a.end_sample + 10);
+		if (a.end_sample > 0)
+			check_subset(row_data, model, sorted, class_visible, a.end_sample - 1, a.end_sample);
+	}
+
+	BOOST_CHECK_EQUAL(row_data.get_annotation_count(), model.size());
+	BOOST_CHECK_EQUAL(row_data.get_max_sample(), max_sample);
+}
+
+// The n-th annotation of the stress test, which lets readers check what
+// they see without having to synchronize with the writer
+uint64_t stress_start(uint32_t n) { return 10 * (uint64_t)n; }
+uint64_t stress_length(uint32_t n) { return 5 + n % 7; }
+uint32_t stress_class(uint32_t n) { return n % ClassCount; }
+
+/**
+ * Adds annotations in one thread while another one queries them, holding
+ * the lock only while querying like the decode signal does, and then reads
+ * the annotations through the handles it got.
+ */
+void stress(AnnotationSpill* spill)
+{
+	const uint32_t AnnotationCount = 64 * RowData::BlockSize + 17;
+
+	TestDecoder dec;
+	TextPool text_pool;
+	RowData row_data(dec.row, &text_pool, spill);
+
+	mutex output_mutex;
+	atomic<bool> done(false);
+
+	std::thread writer([&]() {
+		for (uint32_t n = 0; n < AnnotationCount; n++) {
+			lock_guard<mutex> lock(output_mutex);
+			add_annotation(row_data, stress_start(n),
+				stress_start(n) + stress_length(n), stress_class(n));
+		}
+		done = true;
+	});
+
+	uint64_t checked_count = 0;
+	bool all_valid = true;
+
+	while (!done || (checked_count == 0)) {
+		deque<Annotation> annotations;
+		{
+			lock_guard<mutex> lock(output_mutex);
+
+			// Look at the most recent annotations, which are in the block
+			// being filled, and at some older ones that may be spilled
+			const uint64_t count = row_data.get_annotation_count();
+			const uint64_t recent = stress_start(count - min<uint64_t>(count, 100));
+			row_data.get_annotation_subset(annotations, recent, UINT64_MAX);
+			row_data.get_annotation_subset(annotations, 0, 500);
+		}
+
+		for (const Annotation& a : annotations) {
+			const uint32_t n = a.start_sample() / 10;
+			const vector<QString>* texts = a.annotations();
+
+			all_valid = all_valid && (a.start_sample() == stress_start(n)) &&
+				(a.length() == stress_length(n)) &&
+				(a.ann_class_id() == stress_class(n)) &&
+				texts && (texts->front() == ClassNames[stress_class(n)]);
+			checked_count++;
+		}
+	}
+
+	writer.join();
+
+	BOOST_CHECK(all_valid);
+	BOOST_CHECK_GT(checked_count, 0);
+	BOOST_CHECK_EQUAL(row_data.get_annotation_count(), AnnotationCount);
+
+	// The spilled buffers were freed without the reader asking for it
+	if (spill)
+		BOOST_CHECK_EQUAL(spill->retired_count(), 0);
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(RowDataTest)
+
+BOOST_AUTO_TEST_CASE(InOrder)
+{
+	fuzz(1, 0, false, nullptr);
+	fuzz(2, 0, true, nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(OutOfOrder)
+{
+	fuzz(3, 10, false, nullptr);
+	fuzz(4, 300, true, nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(Spilled)
+{
+	AnnotationSpill spill;
+
+	fuzz(5, 0, true, &spill);
+	fuzz(6, 10, false, &spill);
+}
+
+// Meant to be run with ThreadSanitizer, too
+BOOST_AUTO_TEST_CASE(ConcurrentAccess)
+{
+	stress(nullptr);
+
+	AnnotationSpill spill;
+	stress(&spill);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
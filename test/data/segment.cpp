@@ -20,10 +20,13 @@
 
 #include <extdef.h>
 
+#include <algorithm>
 #include <cstdint>
 
 #include <boost/test/unit_test.hpp>
 
+#include <QCryptographicHash>
+
 #include <pv/data/segment.hpp>
 
 using pv::data::Segment;
@@ -296,4 +299,37 @@ BOOST_AUTO_TEST_CASE(MaxSize32MultiIterated)
 	s.end_sample_iteration(it);
 }
 
+BOOST_AUTO_TEST_CASE(ContentHash)
+{
+	// Spans several chunks, the last one only partially used
+	const uint32_t num_samples = 2 * (pv::data::Segment::MaxChunkSize / sizeof(uint32_t)) + 123;
+
+	uint32_t* const data = new uint32_t[num_samples];
+	for (uint32_t i = 0; i < num_samples; i++)
+		data[i] = i * 2654435761U;
+
+	const QByteArray expected = QCryptographicHash::hash(QByteArray((const char*)data,
+		num_samples * sizeof(uint32_t)), QCryptographicHash::Sha1);
+
+	Segment s1(0, 1, sizeof(uint32_t));
+	s1.append_samples(data, num_samples);
+
+	// The hash doesn't depend on how the samples were added
+	Segment s2(0, 1, sizeof(uint32_t));
+	for (uint32_t i = 0; i < num_samples; i += 1000)
+		s2.append_samples(data + i, std::min(1000U, num_samples - i));
+
+	delete[] data;
+
+	BOOST_CHECK(s1.content_hash().isEmpty());
+
+	s1.set_complete();
+	s2.set_complete();
+	s2.free_unused_memory();
+
+	BOOST_CHECK(s1.content_hash() == expected);
+	BOOST_CHECK(s2.content_hash() == expected);
+	BOOST_CHECK(s1.content_hash() == expected);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,83 @@
+/*
+ * This file is part of the PulseView project.
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <pv/data/decode/textpool.hpp>
+
+using pv::data::decode::TextPool;
+
+BOOST_AUTO_TEST_SUITE(TextPoolTest)
+
+BOOST_AUTO_TEST_CASE(Interning)
+{
+	TextPool pool;
+
+	const char* read[] = {"Read", "Rd", "R", nullptr};
+	const char* read_again[] = {"Read", "Rd", "R", nullptr};
+	const char* write[] = {"Write", "Wr", "W", nullptr};
+	const char* split[] = {"Read", "RdR", nullptr};
+
+	const uint32_t read_id = pool.intern(read);
+	BOOST_CHECK_EQUAL(pool.intern(read_again), read_id);
+	BOOST_CHECK(pool.intern(write) != read_id);
+
+	// Same bytes, but split into different texts
+	BOOST_CHECK(pool.intern(split) != read_id);
+
+	BOOST_CHECK_EQUAL(pool.count(), 3);
+	BOOST_CHECK_EQUAL(pool.size(), 10 + 11 + 9);
+}
+
+BOOST_AUTO_TEST_CASE(Texts)
+{
+	TextPool pool;
+
+	const char* texts[] = {"Delay: 10 \xC2\xB5s", "10 \xC2\xB5s", nullptr};
+	const uint32_t id = pool.intern(texts);
+
+	const vector<QString>* strings = pool.texts(id);
+	BOOST_REQUIRE(strings);
+	BOOST_REQUIRE_EQUAL(strings->size(), 2);
+	BOOST_CHECK(strings->at(0) == QString::fromUtf8(texts[0]));
+	BOOST_CHECK(strings->at(1) == QString::fromUtf8(texts[1]));
+
+	const QByteArray raw = pool.raw_texts(id);
+	BOOST_CHECK(raw == QByteArray("Delay: 10 \xC2\xB5s\0" "10 \xC2\xB5s\0", 21));
+
+	// Texts are only created once and stay where they are
+	const char* other[] = {"Other", nullptr};
+	pool.texts(pool.intern(other));
+	BOOST_CHECK_EQUAL(pool.texts(id), strings);
+}
+
+BOOST_AUTO_TEST_CASE(Clear)
+{
+	TextPool pool;
+
+	const char* texts[] = {"Start", nullptr};
+	pool.intern(texts);
+	pool.clear();
+
+	BOOST_CHECK_EQUAL(pool.count(), 0);
+	BOOST_CHECK_EQUAL(pool.intern(texts), 0);
+	BOOST_CHECK(pool.texts(0)->front() == "Start");
+}
+
+BOOST_AUTO_TEST_SUITE_END()